@@ -0,0 +1,161 @@
+/*
+ * adventure_ai.cpp - Computer player turn budget benchmark
+ * Realms of Eldoria
+ *
+ * Hosts several games with 8 computer players each (two heroes apiece, mines and monster groups
+ * scattered over the map) and lets AdventureAI play every turn from the GameHost turn handler.
+ * Reports AI turn times against the budget, how often searches ran out of time, host tick
+ * times, and how far the AI got (mines taken, monster groups beaten).
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "../lib/ai/AdventureAI.h"
+
+namespace {
+
+const int DEFAULT_GAMES = 8;
+const int MAP_SIZE = 128;
+const int PLAYERS = 8;
+const int HEROES_PER_PLAYER = 2;
+const int MINES = 64;
+const int MONSTERS = 400;
+const int DAYS = 20;
+const int TURN_BUDGET_MS = 10;
+const uint32_t FIRST_MINE = 1000;
+const uint32_t FIRST_MONSTER = 2000;
+
+std::unique_ptr<GameState> createGame(uint64_t seed) {
+    auto gameState = std::make_unique<GameState>();
+    auto map = std::make_unique<GameMap>(MAP_SIZE, MAP_SIZE, 1);
+    RandomStream placement(seed);
+
+    HeroID heroId = 1;
+    for (PlayerID id = 1; id <= PLAYERS; id++) {
+        auto player = std::make_unique<Player>(id, "AI " + std::to_string(id), Faction::Castle, false);
+        for (int i = 0; i < HEROES_PER_PLAYER; i++, heroId++) {
+            auto hero = std::make_unique<Hero>(heroId, "Hero " + std::to_string(heroId), HeroClass::Knight);
+            Position position(placement.nextInt(2, MAP_SIZE - 3), placement.nextInt(2, MAP_SIZE - 3), 0);
+            hero->setPosition(position);
+            hero->getArmy().addCreatures(1, 60);
+            hero->getArmy().addCreatures(2, 25);
+            hero->resetMovementPoints();
+            map->moveHero(heroId, position, position);
+            player->addHero(heroId);
+            gameState->addHero(std::move(hero));
+        }
+        gameState->addPlayer(std::move(player));
+    }
+
+    auto freeTile = [&]() {
+        while (true) {
+            Position position(placement.nextInt(1, MAP_SIZE - 2), placement.nextInt(1, MAP_SIZE - 2), 0);
+            if (map->getTile(position).object == ObjectType::None) {
+                return position;
+            }
+        }
+    };
+    for (int i = 0; i < MINES; i++) {
+        ResourceType resource = i % 2 ? ResourceType::Gold : ResourceType::Wood;
+        map->addObject(std::make_unique<ResourceMine>(FIRST_MINE + i, freeTile(), resource,
+                                                      resource == ResourceType::Gold ? 1000 : 2));
+    }
+    for (int i = 0; i < MONSTERS; i++) {
+        map->addObject(std::make_unique<MonsterGroup>(FIRST_MONSTER + i, freeTile(), 1 + i % 2,
+                                                      placement.nextInt(3, 30)));
+    }
+    gameState->setMap(std::move(map));
+    gameState->startGame();
+    return gameState;
+}
+
+double percentile(std::vector<double> values, size_t percent) {
+    if (values.empty()) {
+        return 0;
+    }
+    size_t rank = std::min(values.size() - 1, values.size() * percent / 100);
+    std::nth_element(values.begin(), values.begin() + rank, values.end());
+    return values[rank];
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int gameCount = argc > 1 ? std::max(1, std::atoi(argv[1])) : DEFAULT_GAMES;
+    GameState::loadCreatureDatabase();
+
+    GameHost host;
+    ThreadPool aiPool;
+    AdventureAI ai(aiPool, TURN_BUDGET_MS);
+    std::cout << "Adventure AI: " << gameCount << " games of " << PLAYERS << " computer players x "
+              << HEROES_PER_PLAYER << " heroes, " << MAP_SIZE << "x" << MAP_SIZE << " map, " << MINES << " mines, "
+              << MONSTERS << " monster groups, " << DAYS << " days, " << TURN_BUDGET_MS << " ms budget, "
+              << host.getThreadCount() << " host + " << aiPool.getThreadCount() << " AI threads\n";
+
+    std::vector<GameID> ids;
+    for (int i = 0; i < gameCount; i++) {
+        ids.push_back(host.addGame(createGame(i + 1), static_cast<uint32_t>(i + 1)));
+    }
+
+    // Each game's reports are only touched by the worker running that game
+    std::vector<std::vector<AITurnReport>> reports(gameCount + 1);
+    host.setTurnHandler([&](HostedGame& game) {
+        AITurnReport report = ai.playTurn(game);
+        if (report.player != 0) {
+            reports[game.getId()].push_back(report);
+        }
+    });
+
+    for (int tick = 0; tick < DAYS * PLAYERS; tick++) {
+        host.tick();
+    }
+
+    std::vector<double> turnMs;
+    size_t outOfTime = 0;
+    size_t commands = 0;
+    size_t tiles = 0;
+    for (const auto& gameReports : reports) {
+        for (const AITurnReport& report : gameReports) {
+            turnMs.push_back(report.ms);
+            outOfTime += report.outOfTime ? 1 : 0;
+            commands += report.commands;
+            tiles += report.tilesSearched;
+        }
+    }
+
+    int minesTaken = 0;
+    int monstersLeft = 0;
+    int lastDay = 0;
+    for (GameID id : ids) {
+        const GameState& state = host.getGame(id)->getState();
+        lastDay = state.getTurnManager().getDayNumber();
+        for (const auto& object : state.getMap()->getAllObjects()) {
+            if (const auto* mine = dynamic_cast<const ResourceMine*>(object.get())) {
+                minesTaken += mine->getOwner() != 0 ? 1 : 0;
+            } else if (object->getType() == ObjectType::Monster) {
+                monstersLeft++;
+            }
+        }
+    }
+
+    double turns = static_cast<double>(turnMs.size());
+    const HostTickStats& stats = host.getStats();
+    std::cout << "  AI turns: " << turnMs.size() << ", p50 " << percentile(turnMs, 50) << " ms, p99 "
+              << percentile(turnMs, 99) << " ms, max " << *std::max_element(turnMs.begin(), turnMs.end())
+              << " ms; out of time in " << 100.0 * outOfTime / turns << "%\n";
+    std::cout << "  per turn: " << commands / turns << " commands, " << tiles / turns << " tiles searched\n";
+    std::cout << "  host ticks: mean " << stats.meanTickMs() << " ms, max " << stats.maxTickMs << " ms\n";
+    std::cout << "  after " << lastDay - 1 << " days: " << minesTaken << " of " << MINES * gameCount
+              << " mines taken, " << MONSTERS * gameCount - monstersLeft << " monster groups beaten\n";
+
+    if (turnMs.size() != static_cast<size_t>(DAYS * PLAYERS * gameCount) || minesTaken == 0 ||
+        monstersLeft == MONSTERS * gameCount) {
+        std::cerr << "FAILED: the computer players did not play\n";
+        return 1;
+    }
+    std::cout << "OK\n";
+    return 0;
+}
@@ -0,0 +1,136 @@
+/*
+ * battle_ai.cpp - Monte Carlo tree search battle AI benchmark
+ * Realms of Eldoria
+ *
+ * Measures BattleAI playouts per second on one thread and on the whole pool, then fights the
+ * same seeded battles with the weakest-stack heuristic and with the search choosing the player
+ * side's targets, and compares the outcomes. The same battle must come out identically whether
+ * the search runs on one thread or on many.
+ */
+#include <chrono>
+#include <iostream>
+#include <vector>
+#include "../lib/battle/BattleAI.h"
+#include "../lib/gamestate/GameState.h"
+
+namespace {
+
+const int DECISIONS = 40;
+const int SEARCH_ROLLOUTS = 4096;
+const int BATTLES = 200;
+const int BATTLE_ROLLOUTS = 512;
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// Mixed stacks on both sides, close enough that targeting decides many battles
+void addArmies(BattleEngine& engine) {
+    engine.addPlayerUnit(1, 70);
+    engine.addPlayerUnit(2, 9);
+    engine.addPlayerUnit(1, 25);
+    engine.addPlayerUnit(2, 4);
+    engine.addEnemyUnit(2, 9);
+    engine.addEnemyUnit(1, 75);
+    engine.addEnemyUnit(2, 6);
+    engine.addEnemyUnit(1, 40);
+}
+
+struct BattleOutcome {
+    BattleResult result = BattleResult::Defeat;
+    int playerLeft = 0;
+    int enemyLeft = 0;
+
+    bool operator==(const BattleOutcome& other) const {
+        return result == other.result && playerLeft == other.playerLeft && enemyLeft == other.enemyLeft;
+    }
+};
+
+BattleOutcome fight(uint64_t seed, BattleAI* playerAI) {
+    BattleEngine engine(nullptr, seed);
+    addArmies(engine);
+    engine.setTacticalAI(playerAI, true, false);
+
+    BattleOutcome outcome;
+    outcome.result = engine.executeAutoBattle();
+    for (const BattleUnit& unit : engine.getPlayerUnits()) {
+        outcome.playerLeft += unit.count;
+    }
+    for (const BattleUnit& unit : engine.getEnemyUnits()) {
+        outcome.enemyLeft += unit.count;
+    }
+    return outcome;
+}
+
+double playoutsPerSecond(ThreadPool& pool, int trees) {
+    BattleEngine engine(nullptr, 1);
+    addArmies(engine);
+    BattleState state;
+    BattleState::capture(engine.getPlayerUnits(), engine.getEnemyUnits(), nullptr, true, 0, 1, state);
+
+    BattleAIConfig config;
+    config.rollouts = SEARCH_ROLLOUTS;
+    config.trees = trees;
+    BattleAI ai(pool, config);
+
+    RandomStream streams(5);
+    auto start = Clock::now();
+    for (int decision = 0; decision < DECISIONS; decision++) {
+        ai.chooseTarget(state, streams.split(decision));
+    }
+    return ai.getPlayoutCount() / (elapsedMs(start) / 1000.0);
+}
+
+} // namespace
+
+int main() {
+    GameState::loadCreatureDatabase();
+
+    ThreadPool singlePool(1);
+    ThreadPool pool;
+    std::cout << "Battle AI: 4 vs 4 stacks, " << SEARCH_ROLLOUTS << " rollouts per decision, "
+              << pool.getThreadCount() << " threads\n";
+
+    double singleRate = playoutsPerSecond(singlePool, 1);
+    double poolRate = playoutsPerSecond(pool, static_cast<int>(pool.getThreadCount()) * 2);
+    std::cout << "  playouts/s: " << singleRate << " on one thread, " << poolRate << " on the pool ("
+              << poolRate / singleRate << "x)\n";
+
+    BattleAIConfig config;
+    config.rollouts = BATTLE_ROLLOUTS;
+    BattleAI searching(pool, config);
+    BattleAI searchingAlone(singlePool, config);
+
+    int heuristicWins = 0;
+    int searchWins = 0;
+    long heuristicLeft = 0;
+    long searchLeft = 0;
+    double searchMs = 0;
+    for (int battle = 0; battle < BATTLES; battle++) {
+        BattleOutcome heuristic = fight(battle + 1, nullptr);
+        auto start = Clock::now();
+        BattleOutcome searched = fight(battle + 1, &searching);
+        searchMs += elapsedMs(start);
+        heuristicWins += heuristic.result == BattleResult::Victory ? 1 : 0;
+        searchWins += searched.result == BattleResult::Victory ? 1 : 0;
+        heuristicLeft += heuristic.playerLeft;
+        searchLeft += searched.playerLeft;
+    }
+    std::cout << "  " << BATTLES << " battles (" << BATTLE_ROLLOUTS << " rollouts per decision, "
+              << searchMs / BATTLES << " ms per searched battle): heuristic won " << heuristicWins << ", search won "
+              << searchWins << "; creatures left " << heuristicLeft / static_cast<double>(BATTLES) << " vs "
+              << searchLeft / static_cast<double>(BATTLES) << " per battle\n";
+
+    bool sameOnOneThread = fight(7, &searching) == fight(7, &searchingAlone);
+    std::cout << "  same battle on one thread and on the pool: " << (sameOnOneThread ? "identical" : "different")
+              << "\n";
+
+    if (singleRate <= 0 || searching.getDecisionCount() == 0 || !sameOnOneThread) {
+        std::cerr << "FAILED\n";
+        return 1;
+    }
+    std::cout << "OK\n";
+    return 0;
+}
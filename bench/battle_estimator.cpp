@@ -0,0 +1,151 @@
+/*
+ * battle_estimator.cpp - Analytical battle estimator accuracy and speed benchmark
+ * Realms of Eldoria
+ *
+ * Builds a corpus of random, roughly even battles (one to four stacks a side, with and without
+ * a commanding hero), runs each through BattleSimulator and through BattleEstimator, and reports
+ * how far the estimated win probability and survivors are from the simulated ones. Also times
+ * uncached and cached estimates against simulated battles.
+ */
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <vector>
+#include "../lib/battle/BattleEstimator.h"
+#include "../lib/gamestate/GameState.h"
+
+namespace {
+
+const int CASES = 240;
+const int BATTLES_PER_CASE = 2000;
+const int ESTIMATE_REPEATS = 200;
+const double MAX_MEAN_WIN_ERROR = 0.1;
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+int armyValue(const std::vector<ArmySlot>& army) {
+    int value = 0;
+    for (const ArmySlot& slot : army) {
+        value += slot.count * GameState::getCreatureData(slot.creatureId)->getAiValue();
+    }
+    return value;
+}
+
+std::vector<ArmySlot> randomArmy(RandomStream& rng) {
+    std::vector<ArmySlot> army;
+    int stacks = rng.nextInt(1, 4);
+    for (int i = 0; i < stacks; i++) {
+        CreatureID creature = static_cast<CreatureID>(rng.nextInt(1, 2));
+        army.emplace_back(creature, creature == 1 ? rng.nextInt(10, 120) : rng.nextInt(2, 20));
+    }
+    return army;
+}
+
+// Scale the enemy so the two sides are within a factor of two of each other by creature value
+void balance(BattleSetup& setup, RandomStream& rng) {
+    double target = armyValue(setup.playerArmy) * rng.nextFloat(0.5f, 2.0f);
+    double scale = target / std::max(1, armyValue(setup.enemyArmy));
+    for (ArmySlot& slot : setup.enemyArmy) {
+        slot.count = std::max(1, static_cast<int>(std::lround(slot.count * scale)));
+    }
+}
+
+double survivorError(const std::vector<ArmySlot>& army, const std::vector<double>& estimated,
+                     const std::vector<double>& casualties) {
+    double error = 0;
+    double total = 0;
+    for (size_t i = 0; i < army.size(); i++) {
+        error += std::fabs(estimated[i] - (army[i].count - casualties[i]));
+        total += army[i].count;
+    }
+    return error / total;
+}
+
+} // namespace
+
+int main() {
+    GameState::loadCreatureDatabase();
+
+    Hero commander(1, "Commander", HeroClass::Knight);
+    RandomStream rng(11);
+    std::vector<BattleSetup> corpus(CASES);
+    for (int i = 0; i < CASES; i++) {
+        BattleSetup& setup = corpus[i];
+        setup.hero = i % 2 ? &commander : nullptr;
+        setup.playerArmy = randomArmy(rng);
+        setup.enemyArmy = randomArmy(rng);
+        balance(setup, rng);
+    }
+
+    BattleSimulator simulator;
+    std::cout << "Battle estimator: " << CASES << " battles, " << BATTLES_PER_CASE << " simulated each, "
+              << simulator.getThreadCount() << " threads\n";
+
+    double winError = 0;
+    double maxWinError = 0;
+    double squaredError = 0;
+    double playerSurvivorError = 0;
+    double enemySurvivorError = 0;
+    int outcomeAgreed = 0;
+    auto simulationStart = Clock::now();
+    std::vector<BattleStatistics> simulated;
+    for (int i = 0; i < CASES; i++) {
+        simulated.push_back(simulator.run(corpus[i], BATTLES_PER_CASE, i + 1));
+    }
+    double simulationMs = elapsedMs(simulationStart);
+
+    for (int i = 0; i < CASES; i++) {
+        const BattleStatistics& stats = simulated[i];
+        BattleEstimate estimate = BattleEstimator::compute(corpus[i]);
+        double error = std::fabs(estimate.winProbability - stats.winProbability);
+        winError += error;
+        maxWinError = std::max(maxWinError, error);
+        squaredError += (estimate.winProbability - stats.winProbability) * (estimate.winProbability - stats.winProbability);
+        outcomeAgreed += (estimate.winProbability >= 0.5) == (stats.winProbability >= 0.5) ? 1 : 0;
+        playerSurvivorError += survivorError(corpus[i].playerArmy, estimate.expectedPlayerSurvivors,
+                                             stats.expectedPlayerCasualties);
+        enemySurvivorError += survivorError(corpus[i].enemyArmy, estimate.expectedEnemySurvivors,
+                                            stats.expectedEnemyCasualties);
+    }
+    winError /= CASES;
+    std::cout << "  win probability: mean error " << winError << ", max " << maxWinError << ", rms "
+              << std::sqrt(squaredError / CASES) << "; favourite agrees in " << outcomeAgreed << " of " << CASES
+              << "\n";
+    std::cout << "  survivors: mean error " << 100.0 * playerSurvivorError / CASES << "% of the player's army, "
+              << 100.0 * enemySurvivorError / CASES << "% of the enemy's\n";
+
+    auto computeStart = Clock::now();
+    double checksum = 0;
+    for (int repeat = 0; repeat < ESTIMATE_REPEATS; repeat++) {
+        for (const BattleSetup& setup : corpus) {
+            checksum += BattleEstimator::compute(setup).winProbability;
+        }
+    }
+    double computeUs = elapsedMs(computeStart) * 1000.0 / (ESTIMATE_REPEATS * CASES);
+
+    BattleEstimator estimator;
+    auto cachedStart = Clock::now();
+    for (int repeat = 0; repeat < ESTIMATE_REPEATS; repeat++) {
+        for (const BattleSetup& setup : corpus) {
+            checksum += estimator.estimate(setup).winProbability;
+        }
+    }
+    double cachedUs = elapsedMs(cachedStart) * 1000.0 / (ESTIMATE_REPEATS * CASES);
+    double simulatedUs = simulationMs * 1000.0 / CASES;
+
+    std::cout << "  per estimate: " << computeUs << " us computed, " << cachedUs << " us through the cache ("
+              << estimator.getCacheHits() << " hits, " << estimator.getCacheMisses() << " misses); simulating "
+              << BATTLES_PER_CASE << " battles " << simulatedUs << " us (checksum " << checksum << ")\n";
+
+    if (winError > MAX_MEAN_WIN_ERROR || estimator.getCacheMisses() != static_cast<uint64_t>(CASES)) {
+        std::cerr << "FAILED: estimates too far from simulation or cache not hit\n";
+        return 1;
+    }
+    std::cout << "OK\n";
+    return 0;
+}
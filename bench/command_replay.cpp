@@ -0,0 +1,191 @@
+/*
+ * command_replay.cpp - Command log recording and replay benchmark
+ * Realms of Eldoria
+ *
+ * Plays a skirmish through a GameHost (heroes walk around and fight the monsters they reach)
+ * once without and once with a command log, then fast-forwards the log headlessly. Reports the
+ * recording overhead, log size, replay speed and per-command timing, and checks the replay ends
+ * in the recorded state. A log whose start save was tampered with must be reported as a desync.
+ */
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <vector>
+#include "../lib/gamestate/GameHost.h"
+#include "../lib/gamestate/SaveGame.h"
+#include "../lib/data/MappedFile.h"
+
+namespace {
+
+const int MAP_SIZE = 96;
+const int PLAYERS = 4;
+const int HEROES_PER_PLAYER = 3;
+const int MONSTERS = 400;
+const int TURNS = 3000;
+const uint32_t FIRST_MONSTER = 1000;
+const char* LOG_PATH = "command_replay_bench.log";
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+std::unique_ptr<GameState> createGame() {
+    auto gameState = std::make_unique<GameState>();
+    auto map = std::make_unique<GameMap>(MAP_SIZE, MAP_SIZE, 1);
+
+    HeroID heroId = 1;
+    for (PlayerID id = 1; id <= PLAYERS; id++) {
+        auto player = std::make_unique<Player>(id, "Player " + std::to_string(id), Faction::Castle, false);
+        for (int i = 0; i < HEROES_PER_PLAYER; i++, heroId++) {
+            auto hero = std::make_unique<Hero>(heroId, "Hero " + std::to_string(heroId), HeroClass::Knight);
+            Position position(4 + heroId * 7 % (MAP_SIZE - 8), 4 + heroId * 13 % (MAP_SIZE - 8), 0);
+            hero->setPosition(position);
+            hero->getArmy().addCreatures(1, 40);
+            hero->getArmy().addCreatures(2, 15);
+            hero->resetMovementPoints();
+            map->moveHero(heroId, position, position);
+            player->addHero(heroId);
+            gameState->addHero(std::move(hero));
+        }
+        gameState->addPlayer(std::move(player));
+    }
+
+    RandomStream placement(7);
+    for (int i = 0; i < MONSTERS; i++) {
+        Position position(placement.nextInt(1, MAP_SIZE - 2), placement.nextInt(1, MAP_SIZE - 2), 0);
+        if (map->getObjectsAt(position).empty()) {
+            map->addObject(std::make_unique<MonsterGroup>(FIRST_MONSTER + i, position, 1 + i % 2,
+                                                          placement.nextInt(2, 12)));
+        }
+    }
+    gameState->setMap(std::move(map));
+    gameState->startGame();
+    return gameState;
+}
+
+// The current player's heroes attack a neighbouring monster group if there is one, else walk
+uint32_t adjacentMonster(const GameMap& map, const Position& position) {
+    for (int dy = -1; dy <= 1; dy++) {
+        for (int dx = -1; dx <= 1; dx++) {
+            Position next(position.x + dx, position.y + dy, position.z);
+            if ((dx || dy) && map.isValidPosition(next)) {
+                for (const MapObject* object : map.getObjectsAt(next)) {
+                    if (object->getType() == ObjectType::Monster) {
+                        return object->getId();
+                    }
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+void submitTurn(GameHost& host, GameID id, RandomStream& orders) {
+    GameState& state = host.getGame(id)->getState();
+    PlayerID player = state.getCurrentPlayer();
+    for (HeroID heroId : state.getPlayer(player)->getHeroes()) {
+        const Hero* hero = state.getHero(heroId);
+        uint32_t monster = adjacentMonster(*state.getMap(), hero->getPosition());
+        if (monster) {
+            host.submit(id, GameCommand::fight(player, heroId, monster));
+        } else {
+            Position target(orders.nextInt(1, MAP_SIZE - 2), orders.nextInt(1, MAP_SIZE - 2), 0);
+            host.submit(id, GameCommand::moveHero(player, heroId, target));
+        }
+    }
+    host.submit(id, GameCommand::endTurn(player));
+}
+
+// Plays the whole game; returns the final state hash
+uint64_t play(bool record, double& ms, uint64_t& commands) {
+    GameHost host(1);
+    GameID id = host.addGame(createGame(), 99);
+    if (record) {
+        host.getGame(id)->startRecording(LOG_PATH);
+    }
+
+    RandomStream orders(3);
+    auto start = Clock::now();
+    for (int turn = 0; turn < TURNS && host.getGame(id)->getState().isGameRunning(); turn++) {
+        submitTurn(host, id, orders);
+        host.tick();
+    }
+    if (record) {
+        commands = host.getGame(id)->getRecorder()->getCommandCount();
+        host.getGame(id)->stopRecording();
+    }
+    ms = elapsedMs(start);
+    return hashGameState(host.getGame(id)->getState());
+}
+
+} // namespace
+
+int main() {
+    GameState::loadCreatureDatabase();
+    std::cout << "Command log: " << MAP_SIZE << "x" << MAP_SIZE << " map, " << PLAYERS * HEROES_PER_PLAYER
+              << " heroes, " << MONSTERS << " monster groups, " << TURNS << " turns\n";
+
+    double plainMs = 0;
+    double recordedMs = 0;
+    uint64_t commands = 0;
+    uint64_t plainHash = play(false, plainMs, commands);
+    uint64_t recordedHash = play(true, recordedMs, commands);
+
+    MappedFile log;
+    log.open(LOG_PATH);
+    std::cout << "  play: " << plainMs << " ms, with recording " << recordedMs << " ms; " << commands
+              << " commands, log " << log.getSize() << " bytes (" << log.getSize() / static_cast<double>(commands)
+              << " bytes/command)\n";
+    log.close();
+
+    ReplayReport report = CommandReplayer::replay(LOG_PATH);
+    std::cout << "  replay: " << report.commands << " commands in " << report.totalMs << " ms, "
+              << report.commandsPerSecond() << " commands/s, " << report.checkpoints << " checkpoints matched\n";
+    const char* typeNames[] = { "move", "end turn", "fight" };
+    for (int type = 0; type < 3; type++) {
+        const ReplayReport::TypeTiming& timing = report.byType[type];
+        if (timing.count > 0) {
+            std::cout << "    " << typeNames[type] << ": " << timing.count << " commands, mean "
+                      << timing.totalMicroseconds / timing.count << " us, max " << timing.maxMicroseconds << " us\n";
+        }
+    }
+    if (!report.slowest.empty()) {
+        std::cout << "    slowest: #" << report.slowest.front().index << " "
+                  << typeNames[static_cast<int>(report.slowest.front().command.type)] << " "
+                  << report.slowest.front().microseconds << " us\n";
+    }
+
+    bool ok = true;
+    if (plainHash != recordedHash) {
+        std::cerr << "FAILED: recording changed the game\n";
+        ok = false;
+    }
+    if (report.diverged || report.commands != commands) {
+        std::cerr << "FAILED: replay diverged after command " << report.divergedAt << ": " << report.divergence << "\n";
+        ok = false;
+    }
+
+    // Tamper with the start save: the replay must notice before applying anything
+    std::string startPath = std::string(LOG_PATH) + ".start";
+    std::unique_ptr<GameState> tampered = SaveGame::load(startPath);
+    tampered->getHero(1)->setMovementPoints(tampered->getHero(1)->getMovementPoints() - 1);
+    SaveGame::save(*tampered, startPath);
+    tampered.reset();
+    ReplayReport tamperedReport = CommandReplayer::replay(LOG_PATH);
+    std::cout << "  tampered start save: " << (tamperedReport.diverged ? tamperedReport.divergence : "not detected")
+              << "\n";
+    if (!tamperedReport.diverged || tamperedReport.commands != 0) {
+        std::cerr << "FAILED: tampered log replayed without a desync\n";
+        ok = false;
+    }
+
+    std::remove(LOG_PATH);
+    std::remove(startPath.c_str());
+    if (!ok) {
+        return 1;
+    }
+    std::cout << "OK\n";
+    return 0;
+}
@@ -0,0 +1,127 @@
+/*
+ * end_of_day.cpp - End-of-day processing scaling benchmark
+ * Realms of Eldoria
+ *
+ * A large game (8 players, 5,000 heroes, mines owned by every player) plays out a run of days:
+ * heroes spend some of their movement, then the day ends. The end-of-day work runs on the calling
+ * thread and on thread pools of increasing size, and every run must leave the game in the same
+ * state: each player's resources and each hero's movement points, checked after every day.
+ */
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "../lib/gamestate/GameState.h"
+#include "../lib/core/Random.h"
+
+namespace {
+
+const int MAP_SIZE = 256;
+const int PLAYERS = 8;
+const int HEROES = 5000;
+const int MINES = 512;
+const int DAYS = 400;
+const unsigned THREAD_COUNTS[] = { 1, 2, 4, 8 };
+const uint32_t FIRST_MINE = 1000;
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+std::unique_ptr<GameState> createGame() {
+    auto gameState = std::make_unique<GameState>();
+    auto map = std::make_unique<GameMap>(MAP_SIZE, MAP_SIZE, 1);
+    RandomStream placement(31);
+
+    for (PlayerID id = 1; id <= PLAYERS; id++) {
+        gameState->addPlayer(std::make_unique<Player>(id, "Player " + std::to_string(id), Faction::Castle));
+    }
+    for (HeroID id = 1; id <= HEROES; id++) {
+        auto hero = std::make_unique<Hero>(id, "Hero " + std::to_string(id), HeroClass::Knight);
+        if (id % 3 == 0) {
+            hero->setSkill(SkillType::Logistics, 1 + id % 3);
+        }
+        gameState->getPlayer(1 + id % PLAYERS)->addHero(id);
+        gameState->addHero(std::move(hero));
+    }
+
+    for (int i = 0; i < MINES; i++) {
+        ResourceType resource = static_cast<ResourceType>(i % 7);
+        Position position(2 + (i * 7) % (MAP_SIZE - 4), 2 + (i * 7) / (MAP_SIZE - 4) * 3, 0);
+        auto mine = std::make_unique<ResourceMine>(FIRST_MINE + i, position, resource,
+                                                   resource == ResourceType::Gold ? 1000 : placement.nextInt(1, 2));
+        mine->setOwner(1 + i % PLAYERS);
+        map->addObject(std::move(mine));
+    }
+    gameState->setMap(std::move(map));
+    gameState->startGame();
+    return gameState;
+}
+
+uint64_t mix(uint64_t hash, int64_t value) {
+    return (hash ^ static_cast<uint64_t>(value)) * 0x100000001B3ull;
+}
+
+struct RunResult {
+    double endOfDayMs = 0;
+    uint64_t stateHash = 0;
+};
+
+// Every run spends the same movement from the same seed, so only end of day can make them differ
+RunResult run(ThreadPool* pool) {
+    std::unique_ptr<GameState> state = createGame();
+    state->setThreadPool(pool);
+    RandomStream spending(47);
+
+    RunResult result;
+    for (int day = 0; day < DAYS; day++) {
+        for (const auto& [id, hero] : state->getAllHeroes()) {
+            hero->setMovementPoints(spending.nextInt(0, hero->getMovementPoints()));
+        }
+
+        auto start = Clock::now();
+        state->nextTurn();
+        state->processDailyEvents();
+        result.endOfDayMs += elapsedMs(start);
+
+        for (const auto& [id, player] : state->getAllPlayers()) {
+            for (int type = 0; type < Resources::TYPE_COUNT; type++) {
+                result.stateHash = mix(result.stateHash, player->getResources()[static_cast<ResourceType>(type)]);
+            }
+        }
+        for (const auto& [id, hero] : state->getAllHeroes()) {
+            result.stateHash = mix(result.stateHash, hero->getMovementPoints());
+        }
+    }
+    return result;
+}
+
+} // namespace
+
+int main() {
+    std::cout << "End of day: " << PLAYERS << " players, " << HEROES << " heroes, " << MINES << " mines, " << DAYS
+              << " days, " << std::thread::hardware_concurrency() << " hardware threads\n";
+
+    RunResult sequential = run(nullptr);
+    std::cout << "  calling thread: " << sequential.endOfDayMs / DAYS * 1000.0 << " us per day\n";
+
+    bool identical = true;
+    for (unsigned threads : THREAD_COUNTS) {
+        ThreadPool pool(threads);
+        RunResult pooled = run(&pool);
+        identical = identical && pooled.stateHash == sequential.stateHash;
+        std::cout << "  " << threads << " pool thread(s): " << pooled.endOfDayMs / DAYS * 1000.0 << " us per day ("
+                  << sequential.endOfDayMs / pooled.endOfDayMs << "x), state "
+                  << (pooled.stateHash == sequential.stateHash ? "identical" : "DIFFERENT") << "\n";
+    }
+
+    if (!identical) {
+        std::cerr << "FAILED: end of day on the pool changed the game\n";
+        return 1;
+    }
+    std::cout << "OK\n";
+    return 0;
+}
@@ -0,0 +1,149 @@
+/*
+ * game_host.cpp - Multi-game GameHost benchmark
+ * Realms of Eldoria
+ *
+ * Hosts thousands of small skirmishes (plus a few much larger ones, so tasks are uneven) in
+ * one GameHost. Every tick each game gets a move per hero of the current player and an end
+ * of turn. Reports aggregate tick time and per-game tick latency for several worker counts,
+ * and checks every run ends in the same state.
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "../lib/gamestate/GameHost.h"
+
+namespace {
+
+const int DEFAULT_GAMES = 2000;
+const int TICKS = 50;
+const int SMALL_MAP = 48;
+const int LARGE_MAP = 192;
+const int LARGE_EVERY = 16;       // Every 16th game plays on a large map
+const int HEROES_PER_PLAYER = 2;
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+std::unique_ptr<GameState> createGame(int index) {
+    int size = index % LARGE_EVERY == 0 ? LARGE_MAP : SMALL_MAP;
+    auto gameState = std::make_unique<GameState>();
+    auto map = std::make_unique<GameMap>(size, size, 1);
+
+    HeroID heroId = 1;
+    for (PlayerID id = 1; id <= 2; id++) {
+        auto player = std::make_unique<Player>(id, "Player " + std::to_string(id), Faction::Castle, false);
+        for (int i = 0; i < HEROES_PER_PLAYER; i++, heroId++) {
+            auto hero = std::make_unique<Hero>(heroId, "Hero " + std::to_string(heroId), HeroClass::Knight);
+            Position position(2 + heroId * 5, id == 1 ? 2 : size - 3, 0);
+            hero->setPosition(position);
+            hero->getArmy().addCreatures(1, 10);
+            hero->resetMovementPoints();
+            map->moveHero(heroId, position, position);
+            player->addHero(heroId);
+            gameState->addHero(std::move(hero));
+        }
+        gameState->addPlayer(std::move(player));
+    }
+    gameState->setMap(std::move(map));
+    gameState->startGame();
+    return gameState;
+}
+
+void submitTurn(GameHost& host, GameID id, int tick) {
+    GameState& state = host.getGame(id)->getState();
+    PlayerID player = state.getCurrentPlayer();
+    int size = state.getMap()->getWidth();
+    for (HeroID hero : state.getPlayer(player)->getHeroes()) {
+        int seed = tick * 31 + static_cast<int>(id) * 17 + hero * 7;
+        Position target(1 + seed % (size - 2), 1 + (seed / 3) % (size - 2), 0);
+        host.submit(id, GameCommand::moveHero(player, hero, target));
+    }
+    host.submit(id, GameCommand::endTurn(player));
+}
+
+uint64_t stateHash(GameHost& host, const std::vector<GameID>& ids) {
+    uint64_t hash = 1469598103934665603ull;
+    auto mix = [&hash](int64_t value) { hash = (hash ^ static_cast<uint64_t>(value)) * 1099511628211ull; };
+    for (GameID id : ids) {
+        const GameState& state = host.getGame(id)->getState();
+        for (const auto& [heroId, hero] : state.getAllHeroes()) {
+            mix(hero->getPosition().x);
+            mix(hero->getPosition().y);
+            mix(hero->getMovementPoints());
+        }
+        mix(state.getTurnManager().getDayNumber());
+    }
+    return hash;
+}
+
+uint64_t run(unsigned threads, int gameCount) {
+    GameHost host(threads);
+    std::vector<GameID> ids;
+    for (int i = 0; i < gameCount; i++) {
+        ids.push_back(host.addGame(createGame(i), static_cast<uint32_t>(i + 1)));
+    }
+
+    auto start = Clock::now();
+    double submitMs = 0;
+    for (int tick = 0; tick < TICKS; tick++) {
+        auto submitStart = Clock::now();
+        for (GameID id : ids) {
+            submitTurn(host, id, tick);
+        }
+        submitMs += elapsedMs(submitStart);
+        host.tick();
+    }
+    double totalMs = elapsedMs(start);
+
+    // Per-game latency across the whole run, slowest games first
+    std::vector<double> meanLatencies;
+    double maxLatency = 0;
+    for (GameID id : ids) {
+        const GameTickStats* stats = host.getGameStats(id);
+        meanLatencies.push_back(stats->meanLatencyMs());
+        maxLatency = std::max(maxLatency, stats->maxLatencyMs);
+    }
+    std::sort(meanLatencies.begin(), meanLatencies.end());
+
+    const HostTickStats& stats = host.getStats();
+    std::cout << "  " << host.getThreadCount() << " threads: tick mean " << stats.meanTickMs() << " ms, max "
+              << stats.maxTickMs << " ms; " << gameCount * TICKS / ((totalMs - submitMs) / 1000.0)
+              << " game ticks/s\n";
+    std::cout << "      per-game mean latency p50 " << meanLatencies[meanLatencies.size() / 2] << " ms, p99 "
+              << meanLatencies[meanLatencies.size() * 99 / 100] << " ms, worst tick " << maxLatency << " ms\n";
+    return stateHash(host, ids);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int gameCount = argc > 1 ? std::max(1, std::atoi(argv[1])) : DEFAULT_GAMES;
+    unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+
+    std::cout << "GameHost: " << gameCount << " games (every " << LARGE_EVERY << "th on a " << LARGE_MAP << "x"
+              << LARGE_MAP << " map), " << TICKS << " ticks, " << cores << " hardware threads\n";
+
+    std::vector<unsigned> threadCounts = { 1, 2, 4 };
+    if (cores > 4) {
+        threadCounts.push_back(cores);
+    }
+
+    uint64_t expected = 0;
+    for (unsigned threads : threadCounts) {
+        uint64_t hash = run(threads, gameCount);
+        if (expected == 0) {
+            expected = hash;
+        } else if (hash != expected) {
+            std::cerr << "FAILED: final state differs with " << threads << " threads\n";
+            return 1;
+        }
+    }
+    std::cout << "OK\n";
+    return 0;
+}
@@ -0,0 +1,211 @@
+/*
+ * hero_store.cpp - Hero storage benchmark
+ * Realms of Eldoria
+ *
+ * 40,000 heroes spread over 16 players on a 1024x1024 map, stored in HeroStore and in the old
+ * layout (a std::map of individually allocated heroes, with owners looked up by walking the
+ * players' hero lists). Both answer the same queries: lookups by id, a sweep over each player's
+ * heroes, a movement sweep over every hero and screen-sized area queries as heroes move about.
+ * The answers must match.
+ */
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <vector>
+#include "../lib/core/Random.h"
+#include "../lib/entities/hero/HeroStore.h"
+
+namespace {
+
+const int MAP_SIZE = 1024;
+const int PLAYERS = 16;
+const int HEROES = 40000;
+const int LOOKUPS = 1000000;
+const int SWEEPS = 50;
+const int QUERIES = 20000;
+const int SCREEN_WIDTH = 40;
+const int SCREEN_HEIGHT = 30;
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+uint64_t mix(uint64_t hash, int64_t value) {
+    return (hash ^ static_cast<uint64_t>(value)) * 0x100000001B3ull;
+}
+
+// Ids are sparse and added out of order, as they are when heroes are hired and lost during a game
+std::vector<HeroID> makeIds() {
+    std::vector<HeroID> ids;
+    for (int i = 0; i < HEROES; i++) {
+        ids.push_back(static_cast<HeroID>(1 + (static_cast<uint64_t>(i) * 7919) % (HEROES * 3)));
+    }
+    return ids;
+}
+
+Hero makeHero(HeroID id, RandomStream& rng) {
+    Hero hero(id, "Hero " + std::to_string(id), HeroClass::Knight);
+    hero.setPosition(Position(rng.nextInt(0, MAP_SIZE - 1), rng.nextInt(0, MAP_SIZE - 1), rng.nextInt(0, 1)));
+    hero.setMovementPoints(rng.nextInt(0, 2000));
+    return hero;
+}
+
+PlayerID ownerOf(HeroID id) {
+    return 1 + id % PLAYERS;
+}
+
+struct Timings {
+    double lookupMs = 0;
+    double playerSweepMs = 0;
+    double movementSweepMs = 0;
+    double queryMs = 0;
+    uint64_t hash = 0;
+};
+
+Timings runMap(const std::vector<HeroID>& ids) {
+    std::map<HeroID, std::unique_ptr<Hero>> heroes;
+    std::map<PlayerID, std::vector<HeroID>> playerHeroes;
+    RandomStream rng(61);
+    for (HeroID id : ids) {
+        heroes[id] = std::make_unique<Hero>(makeHero(id, rng));
+        playerHeroes[ownerOf(id)].push_back(id);
+    }
+
+    Timings timings;
+    RandomStream lookups(67);
+    auto start = Clock::now();
+    for (int i = 0; i < LOOKUPS; i++) {
+        auto hero = heroes.find(ids[lookups.nextInt(0, HEROES - 1)]);
+        timings.hash = mix(timings.hash, hero->second->getMovementPoints());
+    }
+    timings.lookupMs = elapsedMs(start);
+
+    start = Clock::now();
+    for (int sweep = 0; sweep < SWEEPS; sweep++) {
+        for (const auto& [owner, owned] : playerHeroes) {
+            int64_t total = 0;
+            for (HeroID id : owned) {
+                total += heroes.find(id)->second->getMovementPoints();
+            }
+            timings.hash = mix(timings.hash, total);
+        }
+    }
+    timings.playerSweepMs = elapsedMs(start);
+
+    start = Clock::now();
+    for (int sweep = 0; sweep < SWEEPS; sweep++) {
+        int64_t total = 0;
+        for (const auto& [id, hero] : heroes) {
+            total += hero->getPosition().z == 0 ? hero->getMovementPoints() : 0;
+        }
+        timings.hash = mix(timings.hash, total);
+    }
+    timings.movementSweepMs = elapsedMs(start);
+
+    RandomStream moves(71);
+    start = Clock::now();
+    for (int i = 0; i < QUERIES; i++) {
+        Hero& moved = *heroes.find(ids[moves.nextInt(0, HEROES - 1)])->second;
+        moved.setPosition(Position(moves.nextInt(0, MAP_SIZE - 1), moves.nextInt(0, MAP_SIZE - 1), 0));
+        Rect screen(moves.nextInt(0, MAP_SIZE - SCREEN_WIDTH), moves.nextInt(0, MAP_SIZE - SCREEN_HEIGHT),
+                    SCREEN_WIDTH, SCREEN_HEIGHT);
+        for (const auto& [id, hero] : heroes) {
+            const Position& position = hero->getPosition();
+            if (position.z == 0 && position.x >= screen.x && position.x < screen.x + screen.w &&
+                position.y >= screen.y && position.y < screen.y + screen.h) {
+                timings.hash = mix(timings.hash, id);
+            }
+        }
+    }
+    timings.queryMs = elapsedMs(start);
+    return timings;
+}
+
+Timings runStore(const std::vector<HeroID>& ids) {
+    HeroStore heroes;
+    RandomStream rng(61);
+    for (HeroID id : ids) {
+        heroes.add(makeHero(id, rng));
+        heroes.setOwner(id, ownerOf(id));
+    }
+
+    Timings timings;
+    RandomStream lookups(67);
+    auto start = Clock::now();
+    for (int i = 0; i < LOOKUPS; i++) {
+        timings.hash = mix(timings.hash, heroes.find(ids[lookups.nextInt(0, HEROES - 1)])->getMovementPoints());
+    }
+    timings.lookupMs = elapsedMs(start);
+
+    // The old layout walks each player's list in the order the heroes were hired; sums don't care
+    start = Clock::now();
+    for (int sweep = 0; sweep < SWEEPS; sweep++) {
+        for (PlayerID owner = 1; owner <= PLAYERS; owner++) {
+            int64_t total = 0;
+            for (const auto& [id, hero] : heroes.ownedBy(owner)) {
+                total += hero->getMovementPoints();
+            }
+            timings.hash = mix(timings.hash, total);
+        }
+    }
+    timings.playerSweepMs = elapsedMs(start);
+
+    start = Clock::now();
+    const std::vector<Position>& positions = heroes.getPositions();
+    const std::vector<int>& movementPoints = heroes.getMovementPoints();
+    for (int sweep = 0; sweep < SWEEPS; sweep++) {
+        int64_t total = 0;
+        for (size_t slot = 0; slot < heroes.getSlotCount(); slot++) {
+            total += positions[slot].z == 0 ? movementPoints[slot] : 0;
+        }
+        timings.hash = mix(timings.hash, total);
+    }
+    timings.movementSweepMs = elapsedMs(start);
+
+    RandomStream moves(71);
+    std::vector<HeroHandle> found;
+    start = Clock::now();
+    for (int i = 0; i < QUERIES; i++) {
+        Hero& moved = *heroes.find(ids[moves.nextInt(0, HEROES - 1)]);
+        moved.setPosition(Position(moves.nextInt(0, MAP_SIZE - 1), moves.nextInt(0, MAP_SIZE - 1), 0));
+        Rect screen(moves.nextInt(0, MAP_SIZE - SCREEN_WIDTH), moves.nextInt(0, MAP_SIZE - SCREEN_HEIGHT),
+                    SCREEN_WIDTH, SCREEN_HEIGHT);
+        heroes.findInRegion(screen, 0, found);
+        for (HeroHandle handle : found) {
+            timings.hash = mix(timings.hash, heroes.get(handle)->getId());
+        }
+    }
+    timings.queryMs = elapsedMs(start);
+    return timings;
+}
+
+void report(const char* name, double mapMs, double storeMs, double perOp) {
+    std::cout << "  " << name << ": map " << mapMs * perOp << " us, store " << storeMs * perOp << " us ("
+              << mapMs / storeMs << "x)\n";
+}
+
+} // namespace
+
+int main() {
+    std::vector<HeroID> ids = makeIds();
+    std::cout << "Hero store: " << HEROES << " heroes, " << PLAYERS << " players, " << MAP_SIZE << "x" << MAP_SIZE
+              << " map\n";
+
+    Timings map = runMap(ids);
+    Timings store = runStore(ids);
+
+    report("lookup by id", map.lookupMs, store.lookupMs, 1000.0 / LOOKUPS);
+    report("per-player sweep (all players)", map.playerSweepMs, store.playerSweepMs, 1000.0 / SWEEPS);
+    report("movement sweep", map.movementSweepMs, store.movementSweepMs, 1000.0 / SWEEPS);
+    report("move + screen query", map.queryMs, store.queryMs, 1000.0 / QUERIES);
+
+    if (map.hash != store.hash) {
+        std::cerr << "FAILED: the store answered differently from the map\n";
+        return 1;
+    }
+    std::cout << "OK\n";
+    return 0;
+}
@@ -0,0 +1,146 @@
+/*
+ * map_scan.cpp - Full-map scan benchmark for GameMap tile storage
+ * Realms of Eldoria
+ *
+ * Compares the old nested vector<vector<vector<MapTile>>> layout against the
+ * flat row-major storage used by GameMap, bounds-checked against bounds-checked
+ * and unchecked against unchecked.
+ */
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+#include "../lib/map/GameMap.h"
+
+namespace {
+
+const int MAP_SIZE = 256;
+const int MAP_LEVELS = 2;
+const int ITERATIONS = 200;
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// Reproduction of the previous storage layout
+using NestedTiles = std::vector<std::vector<std::vector<MapTile>>>;
+
+NestedTiles makeNestedTiles() {
+    NestedTiles tiles(MAP_LEVELS);
+    for (int z = 0; z < MAP_LEVELS; z++) {
+        tiles[z].resize(MAP_SIZE);
+        for (int y = 0; y < MAP_SIZE; y++) {
+            tiles[z][y].resize(MAP_SIZE);
+            for (int x = 0; x < MAP_SIZE; x++) {
+                tiles[z][y][x].terrain = static_cast<TerrainType>((x ^ y) % 8);
+                tiles[z][y][x].movementCost = 1 + (x + y) % 3;
+            }
+        }
+    }
+    return tiles;
+}
+
+void fillMap(GameMap& map) {
+    for (int z = 0; z < MAP_LEVELS; z++) {
+        for (int y = 0; y < MAP_SIZE; y++) {
+            for (int x = 0; x < MAP_SIZE; x++) {
+                MapTile& tile = map.getTile(x, y, z);
+                tile.terrain = static_cast<TerrainType>((x ^ y) % 8);
+                tile.movementCost = 1 + (x + y) % 3;
+            }
+        }
+    }
+}
+
+// The old layout with its dimensions held at runtime, bounds-checked as GameMap::getTile did it
+struct NestedMap {
+    int width, height, levels;
+    NestedTiles tiles;
+
+    const MapTile& getTile(int x, int y, int z) const {
+        static const MapTile invalidTile;
+        if (x < 0 || x >= width || y < 0 || y >= height || z < 0 || z >= levels) {
+            return invalidTile;
+        }
+        return tiles[z][y][x];
+    }
+};
+
+// Times ITERATIONS full scans in z, y, x order through tileAt
+template<typename TileAt>
+double scan(TileAt tileAt, uint64_t& checksum) {
+    uint64_t sum = 0;
+    auto start = Clock::now();
+    for (int i = 0; i < ITERATIONS; i++) {
+        for (int z = 0; z < MAP_LEVELS; z++) {
+            for (int y = 0; y < MAP_SIZE; y++) {
+                for (int x = 0; x < MAP_SIZE; x++) {
+                    const MapTile& tile = tileAt(x, y, z);
+                    sum += tile.movementCost + static_cast<int>(tile.terrain);
+                }
+            }
+        }
+    }
+    double ms = elapsedMs(start);
+    checksum = sum;
+    return ms;
+}
+
+void report(const char* name, double ms, uint64_t checksum) {
+    double tilesPerIteration = static_cast<double>(MAP_SIZE) * MAP_SIZE * MAP_LEVELS;
+    double nsPerTile = ms * 1e6 / (tilesPerIteration * ITERATIONS);
+    std::cout << "  " << name << ": " << ms << " ms total, "
+              << nsPerTile << " ns/tile (checksum " << checksum << ")\n";
+}
+
+} // namespace
+
+int main() {
+    std::cout << "Full-map scan: " << MAP_SIZE << "x" << MAP_SIZE << "x" << MAP_LEVELS
+              << ", " << ITERATIONS << " iterations\n";
+
+    NestedMap nestedMap{MAP_SIZE, MAP_SIZE, MAP_LEVELS, makeNestedTiles()};
+    const NestedMap& checkedNested = nestedMap;
+    const NestedTiles& nested = nestedMap.tiles;
+    GameMap map(MAP_SIZE, MAP_SIZE, MAP_LEVELS);
+    fillMap(map);
+
+    // Each layout with and without bounds checks, so the pairs compare like with like
+    uint64_t checksum = 0;
+    double ms = scan([&checkedNested](int x, int y, int z) -> const MapTile& {
+        return checkedNested.getTile(x, y, z);
+    }, checksum);
+    report("nested checked     ", ms, checksum);
+
+    const GameMap& flat = map;
+    ms = scan([&flat](int x, int y, int z) -> const MapTile& {
+        return flat.getTile(x, y, z);
+    }, checksum);
+    report("flat getTile       ", ms, checksum);
+
+    ms = scan([&nested](int x, int y, int z) -> const MapTile& {
+        return nested[z][y][x];
+    }, checksum);
+    report("nested unchecked   ", ms, checksum);
+
+    ms = scan([&flat](int x, int y, int z) -> const MapTile& {
+        return flat.getTileUnchecked(x, y, z);
+    }, checksum);
+    report("flat unchecked     ", ms, checksum);
+
+    // Flat storage as one linear sweep
+    checksum = 0;
+    auto start = Clock::now();
+    for (int i = 0; i < ITERATIONS; i++) {
+        const MapTile* tiles = map.getTileData();
+        size_t count = map.getTileCount();
+        for (size_t t = 0; t < count; t++) {
+            checksum += tiles[t].movementCost + static_cast<int>(tiles[t].terrain);
+        }
+    }
+    report("flat linear sweep  ", elapsedMs(start), checksum);
+
+    return 0;
+}
@@ -0,0 +1,153 @@
+/*
+ * mpsc_queue.cpp - Command queue contention benchmark
+ * Realms of Eldoria
+ *
+ * 1 to 16 producer threads push GameCommands at one consumer that drains in batches, the way
+ * network threads feed a game's tick. Compares MpscQueue with the mutex-protected vector it
+ * replaced as GameHost's inbox, counts how often producers hit a full queue, and checks that
+ * every command arrives exactly once and in order per producer.
+ */
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "../lib/core/MpscQueue.h"
+#include "../lib/gamestate/GameCommands.h"
+
+namespace {
+
+const size_t COMMANDS = 4000000;     // Total per run, split between the producers
+const size_t CAPACITY = 4096;
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// Previous inbox: producers append under a mutex, the consumer swaps the vector out
+class MutexInbox {
+private:
+    std::mutex mutex;
+    std::vector<GameCommand> pending;
+    std::vector<GameCommand> batch;
+    size_t limit;
+
+public:
+    explicit MutexInbox(size_t capacity) : limit(capacity) {}
+
+    bool tryPush(const GameCommand& command) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (pending.size() >= limit) {
+            return false;
+        }
+        pending.push_back(command);
+        return true;
+    }
+
+    template <typename Consume>
+    size_t drain(Consume consume) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            batch.swap(pending);
+        }
+        for (const GameCommand& command : batch) {
+            consume(command);
+        }
+        size_t count = batch.size();
+        batch.clear();
+        return count;
+    }
+};
+
+struct RunResult {
+    double ms;
+    uint64_t fullRetries;
+    bool ordered;
+};
+
+template <typename Queue>
+RunResult run(Queue& queue, int producers) {
+    const size_t perProducer = COMMANDS / producers;
+    std::atomic<uint64_t> fullRetries(0);
+    std::atomic<bool> go(false);
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; p++) {
+        threads.emplace_back([&, p]() {
+            while (!go.load(std::memory_order_acquire)) {
+            }
+            uint64_t retries = 0;
+            GameCommand command = GameCommand::moveHero(static_cast<PlayerID>(p), 1, Position(1, 1, 0));
+            for (size_t i = 0; i < perProducer; i++) {
+                command.objectId = static_cast<uint32_t>(i);
+                while (!queue.tryPush(command)) {
+                    retries++;                // Backpressure: a network thread would stop reading
+                    std::this_thread::yield();
+                }
+            }
+            fullRetries += retries;
+        });
+    }
+
+    std::vector<uint32_t> nextExpected(producers, 0);
+    bool ordered = true;
+    size_t received = 0;
+    const size_t total = perProducer * producers;
+
+    auto start = Clock::now();
+    go.store(true, std::memory_order_release);
+    while (received < total) {
+        size_t count = queue.drain([&](const GameCommand& command) {
+            uint32_t& expected = nextExpected[command.player];
+            ordered &= command.objectId == expected;
+            expected = command.objectId + 1;
+        });
+        received += count;
+        if (count == 0) {
+            std::this_thread::yield();
+        }
+    }
+    double ms = elapsedMs(start);
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    return { ms, fullRetries.load(), ordered };
+}
+
+void report(const char* name, int producers, const RunResult& result) {
+    double commands = static_cast<double>(COMMANDS / producers * producers);
+    std::cout << "  " << name << " " << producers << " producers: " << commands / result.ms / 1000.0
+              << " M commands/s, " << result.ms * 1e6 / commands << " ns/command, " << result.fullRetries
+              << " full retries" << (result.ordered ? "" : " OUT OF ORDER") << "\n";
+}
+
+} // namespace
+
+int main() {
+    std::cout << "Command queue: " << COMMANDS << " commands of " << sizeof(GameCommand) << " bytes, capacity "
+              << CAPACITY << ", " << std::thread::hardware_concurrency() << " hardware threads\n";
+
+    bool ok = true;
+    for (int producers : { 1, 2, 4, 8, 16 }) {
+        MpscQueue<GameCommand> queue(CAPACITY);
+        RunResult lockFree = run(queue, producers);
+        report("MpscQueue ", producers, lockFree);
+
+        MutexInbox inbox(CAPACITY);
+        RunResult locked = run(inbox, producers);
+        report("mutex     ", producers, locked);
+
+        ok &= lockFree.ordered && locked.ordered;
+    }
+
+    if (!ok) {
+        std::cerr << "FAILED: commands arrived out of order\n";
+        return 1;
+    }
+    std::cout << "OK\n";
+    return 0;
+}
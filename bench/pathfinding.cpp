@@ -0,0 +1,137 @@
+/*
+ * pathfinding.cpp - A* path query benchmark
+ * Realms of Eldoria
+ *
+ * Times Pathfinder::findPath between random tiles of a map broken up by rock walls and mines,
+ * and checks every path found: each step is a legal move, and only the goal may be a blocking
+ * object (a mine is taken by ending a move on it, never walked through).
+ */
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "../lib/map/GameMap.h"
+#include "../lib/map/Pathfinder.h"
+#include "../lib/core/Random.h"
+
+namespace {
+
+const int MAP_SIZE = 256;
+const int WALLS = 400;
+const int WALL_LENGTH = 24;
+const int MINES = 600;
+const int QUERIES = 1000;
+const HeroID HERO = 1;
+const uint32_t FIRST_MINE = 1000;
+
+using Clock = std::chrono::steady_clock;
+
+void addWall(GameMap& map, RandomStream& placement) {
+    Position pos(placement.nextInt(0, MAP_SIZE - 1), placement.nextInt(0, MAP_SIZE - 1), 0);
+    bool horizontal = placement.nextInt(0, 1) == 0;
+    for (int i = 0; i < WALL_LENGTH && map.isValidPosition(pos); i++) {
+        map.getTile(pos).passable = false;
+        (horizontal ? pos.x : pos.y)++;
+    }
+}
+
+Position randomTile(RandomStream& placement) {
+    return Position(placement.nextInt(0, MAP_SIZE - 1), placement.nextInt(0, MAP_SIZE - 1), 0);
+}
+
+// Empty if the path is legal, otherwise what is wrong with it
+std::string checkPath(const GameMap& map, const Position& to, const Path& path) {
+    if (path.steps.empty() || !(path.steps.back() == to)) {
+        return "does not end at the goal";
+    }
+    if (!map.canHeroEnter(HERO, to)) {
+        return "ends on a tile the hero cannot enter";
+    }
+    for (size_t i = 0; i + 1 < path.steps.size(); i++) {
+        const Position& step = path.steps[i];
+        if (!map.canHeroMoveTo(HERO, step) || map.getTile(step).object == ObjectType::Mine) {
+            return "passes through a blocked tile or a mine";
+        }
+    }
+    return "";
+}
+
+// A wall across a 5x3 map with a mine as its only gap: the mine may be the goal, not a way through
+bool mineIsNotAGap() {
+    GameMap map(5, 3, 1);
+    for (int y = 0; y < 3; y++) {
+        map.getTile(2, y).passable = false;
+    }
+    map.addObject(std::make_unique<ResourceMine>(FIRST_MINE, Position(2, 1, 0), ResourceType::Gold, 1000));
+
+    Pathfinder pathfinder(map);
+    Path path;
+    bool acrossFound = pathfinder.findPath(HERO, Position(0, 1, 0), Position(4, 1, 0), path);
+    bool ontoMineFound = pathfinder.findPath(HERO, Position(0, 1, 0), Position(2, 1, 0), path);
+    return !acrossFound && ontoMineFound && checkPath(map, Position(2, 1, 0), path).empty();
+}
+
+} // namespace
+
+int main() {
+    std::cout << "Pathfinding: " << MAP_SIZE << "x" << MAP_SIZE << " map, " << WALLS << " walls, "
+              << MINES << " mines, " << QUERIES << " queries\n";
+
+    GameMap map(MAP_SIZE, MAP_SIZE, 1);
+    RandomStream placement(1);
+    for (int i = 0; i < WALLS; i++) {
+        addWall(map, placement);
+    }
+    std::vector<Position> mines;
+    for (int i = 0; i < MINES; i++) {
+        Position pos = randomTile(placement);
+        if (map.getTile(pos).passable && map.getTile(pos).object == ObjectType::None) {
+            map.addObject(std::make_unique<ResourceMine>(FIRST_MINE + i, pos, ResourceType::Wood, 2));
+            mines.push_back(pos);
+        }
+    }
+
+    // Half the queries go to a mine, so goals on blocking objects are covered too
+    std::vector<std::pair<Position, Position>> queries;
+    for (int i = 0; i < QUERIES; i++) {
+        Position to = i % 2 ? mines[placement.nextInt(0, static_cast<int>(mines.size()) - 1)] : randomTile(placement);
+        queries.emplace_back(randomTile(placement), to);
+    }
+
+    Pathfinder pathfinder(map);
+    Path path;
+    int found = 0;
+    long long totalCost = 0;
+    std::string failure;
+    double ms = 0;
+    for (const auto& [from, to] : queries) {
+        if (!map.canHeroMoveTo(HERO, from) || from == to) {
+            continue;
+        }
+        auto start = Clock::now();
+        bool ok = pathfinder.findPath(HERO, from, to, path);
+        ms += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        if (ok) {
+            found++;
+            totalCost += path.getTotalCost();
+            if (failure.empty()) {
+                failure = checkPath(map, to, path);
+            }
+        }
+    }
+
+    std::cout << "  " << found << " paths found, " << ms << " ms total, " << ms * 1000.0 / queries.size()
+              << " us per query (cost checksum " << totalCost << ")\n";
+
+    if (!failure.empty()) {
+        std::cerr << "FAILED: a path " << failure << "\n";
+        return 1;
+    }
+    if (!mineIsNotAGap()) {
+        std::cerr << "FAILED: a path crosses a wall through a mine\n";
+        return 1;
+    }
+    std::cout << "OK\n";
+    return 0;
+}
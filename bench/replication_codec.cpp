@@ -0,0 +1,378 @@
+/*
+ * replication_codec.cpp - State replication encode/decode benchmark
+ * Realms of Eldoria
+ *
+ * Builds a large game, then for a number of ticks applies a batch of changes (tile edits,
+ * hero moves, resource income, monster losses, object and hero removals), captures and encodes the
+ * delta against the previous tick and applies it to a client replica. Reports bytes and
+ * nanoseconds per replicated change next to the cost of a full snapshot, and checks the
+ * replica ends up identical to the server state. A second replica gets the same updates
+ * filtered by one player's fog of war; it must hold exactly what that player can see, and its
+ * tiles must not show the heroes and objects out of sight.
+ */
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <vector>
+#include "../lib/net/Replication.h"
+
+namespace {
+
+const int MAP_SIZE = 256;
+const int MAP_LEVELS = 2;
+const int PLAYERS = 8;
+const int HEROES_PER_PLAYER = 8;
+const int MONSTERS = 2000;
+const int TICKS = 500;
+const int CHANGES_PER_TICK = 32;
+const uint32_t FIRST_MONSTER = 1000;
+const int REMOVE_HERO_EVERY = 100;    // Ticks between heroes leaving the game
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedNs(Clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+}
+
+void createGame(GameState& gameState) {
+    auto map = std::make_unique<GameMap>(MAP_SIZE, MAP_SIZE, MAP_LEVELS);
+    for (size_t i = 0; i < map->getTileCount(); i++) {
+        map->getTileData()[i].terrain = static_cast<TerrainType>(i % 8);
+    }
+
+    HeroID heroId = 1;
+    for (PlayerID id = 1; id <= PLAYERS; id++) {
+        auto player = std::make_unique<Player>(id, "Player " + std::to_string(id), Faction::Castle, false);
+        for (int i = 0; i < HEROES_PER_PLAYER; i++, heroId++) {
+            auto hero = std::make_unique<Hero>(heroId, "Hero " + std::to_string(heroId), HeroClass::Knight);
+            hero->setPosition(Position(heroId * 3 % MAP_SIZE, heroId * 7 % MAP_SIZE, 0));
+            hero->getArmy().addCreatures(1, 10);
+            map->moveHero(heroId, Position(-1, -1, -1), hero->getPosition());
+            player->addHero(heroId);
+            gameState.addHero(std::move(hero));
+        }
+        gameState.addPlayer(std::move(player));
+    }
+
+    for (int i = 0; i < MONSTERS; i++) {
+        Position position((i * 37) % MAP_SIZE, (i * 91) % MAP_SIZE, i % MAP_LEVELS);
+        map->addObject(std::make_unique<MonsterGroup>(FIRST_MONSTER + i, position, 1 + i % 2, 10 + i % 20));
+    }
+    gameState.setMap(std::move(map));
+}
+
+// Change number n of a tick; a rough mix of what a busy turn produces
+void applyChange(GameState& gameState, int tick, int n) {
+    GameMap& map = *gameState.getMap();
+    int seed = tick * CHANGES_PER_TICK + n;
+    switch (n % 8) {
+        case 0:
+        case 1:
+        case 2: {
+            Position position(seed * 13 % MAP_SIZE, seed * 29 % MAP_SIZE, seed % MAP_LEVELS);
+            map.getTile(position).terrain = static_cast<TerrainType>(seed % 8);
+            map.notifyTileChanged(position);
+            break;
+        }
+        case 3:
+        case 4: {
+            Hero* hero = gameState.getHero(1 + seed % (PLAYERS * HEROES_PER_PLAYER));
+            if (!hero) {
+                break;
+            }
+            Position position = hero->getPosition();
+            Position destination((position.x + 1) % MAP_SIZE, position.y, position.z);
+            hero->setPosition(destination);
+            map.moveHero(hero->getId(), position, destination);
+            hero->setMovementPoints(hero->getMovementPoints() - 100);
+            break;
+        }
+        case 5: {
+            Player* player = gameState.getPlayer(1 + seed % PLAYERS);
+            player->getResources()[ResourceType::Gold] += 1000;
+            break;
+        }
+        case 6: {
+            auto* monsters = static_cast<MonsterGroup*>(map.getObject(FIRST_MONSTER + seed % MONSTERS));
+            if (monsters && monsters->getCount() > 1) {
+                monsters->setCount(monsters->getCount() - 1);
+            }
+            break;
+        }
+        case 7: {
+            uint32_t id = FIRST_MONSTER + (seed * 7) % MONSTERS;
+            if (map.getObject(id)) {
+                map.removeObject(id);
+            }
+            break;
+        }
+    }
+}
+
+// Number of records of one type in data
+size_t countRecords(const std::vector<uint8_t>& data, RecordType type) {
+    size_t count = 0;
+    size_t offset = 0;
+    FrameHeader header;
+    while (peekFrame(data.data() + offset, data.size() - offset, header)) {
+        StateBlockHeader block;
+        if (header.type == MessageType::StateBlock) {
+            std::memcpy(&block, data.data() + offset + sizeof(header), sizeof(block));
+            count += block.recordType == type ? block.count : 0;
+        }
+        offset += sizeof(header) + header.payloadSize;
+    }
+    return count;
+}
+
+// Feed every frame in data to the replica; returns the number of completed ticks
+int applyAll(StateReplica& replica, const std::vector<uint8_t>& data) {
+    int completed = 0;
+    size_t offset = 0;
+    FrameHeader header;
+    while (peekFrame(data.data() + offset, data.size() - offset, header)) {
+        completed += replica.applyFrame(header, data.data() + offset + sizeof(header)) ? 1 : 0;
+        offset += sizeof(header) + header.payloadSize;
+    }
+    return completed;
+}
+
+bool replicaMatches(const StateReplica& replica, const GameState& gameState, const StateReplicator& replicator) {
+    const GameMap& map = *gameState.getMap();
+    if (replica.getHeroes().size() != gameState.getHeroStore().size()) {
+        std::cerr << "hero count differs\n";
+        return false;
+    }
+    if (replica.getTiles().size() != map.getTileCount() ||
+        std::memcmp(replica.getTiles().data(), map.getTileData(), map.getTileCount() * sizeof(MapTile)) != 0) {
+        std::cerr << "tiles differ\n";
+        return false;
+    }
+    for (const auto& [id, hero] : gameState.getAllHeroes()) {
+        auto it = replica.getHeroes().find(id);
+        PlayerID owner = 1 + (id - 1) / HEROES_PER_PLAYER;
+        if (it == replica.getHeroes().end() || !(it->second == StateReplicator::describeHero(*hero, owner))) {
+            std::cerr << "hero " << id << " differs\n";
+            return false;
+        }
+    }
+    for (const auto& [id, player] : gameState.getAllPlayers()) {
+        auto it = replica.getResources().find(id);
+        if (it == replica.getResources().end() || !(it->second == StateReplicator::describeResources(*player))) {
+            std::cerr << "resources of player " << static_cast<int>(id) << " differ\n";
+            return false;
+        }
+    }
+    if (replica.getObjects().size() != map.getAllObjects().size()) {
+        std::cerr << "object count differs\n";
+        return false;
+    }
+    for (const auto& object : map.getAllObjects()) {
+        auto it = replica.getObjects().find(object->getId());
+        if (it == replica.getObjects().end() || !(it->second == StateReplicator::describeObject(*object))) {
+            std::cerr << "object " << object->getId() << " differs\n";
+            return false;
+        }
+    }
+    return replica.getTick() == replicator.getTick();
+}
+
+bool fogReplicaMatches(const StateReplica& replica, const GameState& gameState, const VisibilityMap& visibility,
+                       PlayerID viewer) {
+    size_t visibleHeroes = 0;
+    for (const auto& [id, hero] : gameState.getAllHeroes()) {
+        PlayerID owner = 1 + (id - 1) / HEROES_PER_PLAYER;
+        if (owner != viewer && !visibility.isVisible(viewer, hero->getPosition())) {
+            continue;
+        }
+        visibleHeroes++;
+        auto it = replica.getHeroes().find(id);
+        if (it == replica.getHeroes().end() || !(it->second == StateReplicator::describeHero(*hero, owner))) {
+            std::cerr << "visible hero " << id << " differs\n";
+            return false;
+        }
+    }
+    size_t visibleObjects = 0;
+    for (const auto& object : gameState.getMap()->getAllObjects()) {
+        if (!visibility.isVisible(viewer, object->getPosition())) {
+            continue;
+        }
+        visibleObjects++;
+        auto it = replica.getObjects().find(object->getId());
+        if (it == replica.getObjects().end() || !(it->second == StateReplicator::describeObject(*object))) {
+            std::cerr << "visible object " << object->getId() << " differs\n";
+            return false;
+        }
+    }
+    if (replica.getHeroes().size() != visibleHeroes || replica.getObjects().size() != visibleObjects) {
+        std::cerr << "fog replica holds things out of sight\n";
+        return false;
+    }
+
+    // Tiles in sight as they are, the others showing terrain only
+    const GameMap& map = *gameState.getMap();
+    if (replica.getTiles().size() != map.getTileCount()) {
+        std::cerr << "fog replica tile count differs\n";
+        return false;
+    }
+    for (int z = 0; z < map.getLevels(); z++) {
+        for (int y = 0; y < map.getHeight(); y++) {
+            for (int x = 0; x < map.getWidth(); x++) {
+                size_t index = map.getTileIndex(x, y, z);
+                MapTile expected = visibility.isVisible(viewer, Position(x, y, z))
+                                       ? map.getTileData()[index]
+                                       : StateReplicator::describeHiddenTile(map.getTileData()[index]);
+                if (std::memcmp(&replica.getTiles()[index], &expected, sizeof(MapTile)) != 0) {
+                    std::cerr << "fog replica tile (" << x << ", " << y << ", " << z << ") differs\n";
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// An enemy hero stepping between two tiles out of sight must not show up in the fog delta at all
+bool hiddenMoveStaysHidden(GameState& gameState, StateReplicator& replicator, StateReplica& replica,
+                           VisibilityMap& visibility, ReplicationView& view) {
+    for (const auto& [id, hero] : gameState.getAllHeroes()) {
+        Position from = hero->getPosition();
+        Position to((from.x + 1) % MAP_SIZE, from.y, from.z);
+        if (gameState.getHeroOwner(id) == view.viewer || visibility.isVisible(view.viewer, from) ||
+            visibility.isVisible(view.viewer, to) || gameState.getMap()->getTile(to).object != ObjectType::None) {
+            continue;
+        }
+        hero->setPosition(to);
+        gameState.getMap()->moveHero(id, from, to);
+        replicator.capture();
+        visibility.update(gameState);
+
+        std::vector<uint8_t> frames;
+        replicator.encode(replica.getTick(), frames, visibility, view);
+        applyAll(replica, frames);
+        if (countRecords(frames, RecordType::Tile) != 0 || countRecords(frames, RecordType::Hero) != 0) {
+            std::cerr << "hidden hero " << id << " moving was sent\n";
+            return false;
+        }
+        return fogReplicaMatches(replica, gameState, visibility, view.viewer);
+    }
+    std::cerr << "no hero out of sight to move\n";
+    return false;
+}
+
+} // namespace
+
+int main() {
+    GameState gameState;
+    createGame(gameState);
+    gameState.startGame();
+
+    std::cout << "State replication: " << MAP_SIZE << "x" << MAP_SIZE << "x" << MAP_LEVELS << " map, "
+              << PLAYERS * HEROES_PER_PLAYER << " heroes, " << MONSTERS << " monster groups, "
+              << TICKS << " ticks of " << CHANGES_PER_TICK << " changes\n";
+
+    StateReplicator replicator(gameState);
+    StateReplica replica;
+
+    // Join: full snapshot
+    std::vector<uint8_t> snapshot;
+    auto start = Clock::now();
+    replicator.encode(0, snapshot);
+    double snapshotEncodeMs = elapsedNs(start) / 1e6;
+    start = Clock::now();
+    applyAll(replica, snapshot);
+    double snapshotDecodeMs = elapsedNs(start) / 1e6;
+    std::cout << "  full snapshot: " << snapshot.size() << " bytes, encode " << snapshotEncodeMs
+              << " ms, decode " << snapshotDecodeMs << " ms\n";
+
+    // Player 1's client under fog of war
+    const PlayerID viewer = 1;
+    const GameMap& map = *gameState.getMap();
+    VisibilityMap visibility(map.getWidth(), map.getHeight(), map.getLevels());
+    visibility.update(gameState);
+    ReplicationView view;
+    view.viewer = viewer;
+    StateReplica fogReplica;
+    std::vector<uint8_t> fogFrames;
+    replicator.encode(0, fogFrames, visibility, view);
+    applyAll(fogReplica, fogFrames);
+    double visibilityNs = 0;
+    double fogEncodeNs = 0;
+    size_t fogBytes = 0;
+
+    double captureNs = 0;
+    double encodeNs = 0;
+    double decodeNs = 0;
+    size_t deltaBytes = 0;
+    std::vector<uint8_t> frames;
+    for (int tick = 0; tick < TICKS; tick++) {
+        for (int n = 0; n < CHANGES_PER_TICK; n++) {
+            applyChange(gameState, tick, n);
+        }
+        if (tick % REMOVE_HERO_EVERY == REMOVE_HERO_EVERY / 2) {
+            gameState.removeHero(1 + tick / REMOVE_HERO_EVERY * 13 % (PLAYERS * HEROES_PER_PLAYER));
+        }
+
+        uint32_t acked = replica.getTick();
+        start = Clock::now();
+        replicator.capture();
+        captureNs += elapsedNs(start);
+
+        frames.clear();
+        start = Clock::now();
+        replicator.encode(acked, frames);
+        encodeNs += elapsedNs(start);
+        deltaBytes += frames.size();
+
+        start = Clock::now();
+        if (applyAll(replica, frames) != 1) {
+            std::cerr << "FAILED: delta for tick " << tick << " did not complete\n";
+            return 1;
+        }
+        decodeNs += elapsedNs(start);
+
+        uint32_t fogAcked = fogReplica.getTick();
+        start = Clock::now();
+        visibility.update(gameState);
+        visibilityNs += elapsedNs(start);
+        fogFrames.clear();
+        start = Clock::now();
+        replicator.encode(fogAcked, fogFrames, visibility, view);
+        fogEncodeNs += elapsedNs(start);
+        fogBytes += fogFrames.size();
+        applyAll(fogReplica, fogFrames);
+    }
+
+    double changes = static_cast<double>(TICKS) * CHANGES_PER_TICK;
+    std::cout << "  deltas: " << deltaBytes << " bytes total, " << deltaBytes / changes << " bytes/change, "
+              << deltaBytes / static_cast<double>(TICKS) << " bytes/tick\n";
+    std::cout << "  per change: capture " << captureNs / changes << " ns, encode " << encodeNs / changes
+              << " ns, decode " << decodeNs / changes << " ns\n";
+    std::cout << "  full snapshot every tick instead: " << snapshot.size() / static_cast<double>(CHANGES_PER_TICK)
+              << " bytes/change\n";
+
+    std::cout << "  fog of war (player " << static_cast<int>(viewer) << "): " << fogBytes / static_cast<double>(TICKS)
+              << " bytes/tick, visibility update " << visibilityNs / TICKS / 1000.0 << " us/tick, encode "
+              << fogEncodeNs / TICKS / 1000.0 << " us/tick\n";
+
+    // A client that stopped acking falls back to a snapshot once its base leaves the history
+    frames.clear();
+    replicator.encode(replicator.getTick() - StateReplicator::HISTORY_TICKS, frames);
+    std::cout << "  stale ack (" << StateReplicator::HISTORY_TICKS << " ticks behind): " << frames.size()
+              << " bytes\n";
+
+    if (!replicaMatches(replica, gameState, replicator)) {
+        std::cerr << "FAILED: replica does not match the server state\n";
+        return 1;
+    }
+    if (!fogReplicaMatches(fogReplica, gameState, visibility, viewer)) {
+        std::cerr << "FAILED: fog of war replica does not match what the player sees\n";
+        return 1;
+    }
+    if (!hiddenMoveStaysHidden(gameState, replicator, fogReplica, visibility, view)) {
+        std::cerr << "FAILED: fog of war replica learned of a move out of sight\n";
+        return 1;
+    }
+    std::cout << "OK\n";
+    return 0;
+}
@@ -0,0 +1,195 @@
+/*
+ * resources_simd.cpp - Resources arithmetic benchmark
+ * Realms of Eldoria
+ *
+ * Compares the previous seven-field Resources (switch indexing, field-by-field arithmetic)
+ * against the 8-lane vector layout on the loops the economy runs: adding income to many
+ * stockpiles, checking costs against them, scaling costs by counts and summing many vectors.
+ * Both must produce the same totals.
+ */
+#include <chrono>
+#include <iostream>
+#include <vector>
+#include "../include/GameTypes.h"
+#include "../lib/core/Random.h"
+
+namespace {
+
+const size_t STOCKPILES = 4096;
+const int ITERATIONS = 2000;
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// Reproduction of the previous layout and operators
+struct FieldResources {
+    int wood = 0;
+    int mercury = 0;
+    int ore = 0;
+    int sulfur = 0;
+    int crystal = 0;
+    int gems = 0;
+    int gold = 0;
+
+    int& operator[](ResourceType type) {
+        switch (type) {
+            case ResourceType::Wood: return wood;
+            case ResourceType::Mercury: return mercury;
+            case ResourceType::Ore: return ore;
+            case ResourceType::Sulfur: return sulfur;
+            case ResourceType::Crystal: return crystal;
+            case ResourceType::Gems: return gems;
+            case ResourceType::Gold: return gold;
+        }
+        return gold;
+    }
+
+    FieldResources operator+(const FieldResources& other) const {
+        FieldResources result = *this;
+        result.wood += other.wood;
+        result.mercury += other.mercury;
+        result.ore += other.ore;
+        result.sulfur += other.sulfur;
+        result.crystal += other.crystal;
+        result.gems += other.gems;
+        result.gold += other.gold;
+        return result;
+    }
+
+    FieldResources operator*(int factor) const {
+        FieldResources result = *this;
+        result.wood *= factor;
+        result.mercury *= factor;
+        result.ore *= factor;
+        result.sulfur *= factor;
+        result.crystal *= factor;
+        result.gems *= factor;
+        result.gold *= factor;
+        return result;
+    }
+
+    bool canAfford(const FieldResources& cost) const {
+        return wood >= cost.wood && mercury >= cost.mercury && ore >= cost.ore && sulfur >= cost.sulfur &&
+               crystal >= cost.crystal && gems >= cost.gems && gold >= cost.gold;
+    }
+};
+
+struct Timings {
+    double addMs = 0;
+    double affordMs = 0;
+    double scaleMs = 0;
+    double sumMs = 0;
+    long long checksum = 0;
+};
+
+// The same economy loops for either layout; sumAll is the bulk total over the stockpiles
+template <typename R, typename SumAll>
+Timings run(std::vector<R>& stockpiles, const std::vector<R>& income, const R& cost, SumAll sumAll) {
+    Timings timings;
+    long long affordable = 0;
+
+    auto start = Clock::now();
+    for (int iteration = 0; iteration < ITERATIONS; iteration++) {
+        for (size_t i = 0; i < stockpiles.size(); i++) {
+            stockpiles[i] = stockpiles[i] + income[i];
+        }
+    }
+    timings.addMs = elapsedMs(start);
+
+    start = Clock::now();
+    for (int iteration = 0; iteration < ITERATIONS; iteration++) {
+        for (size_t i = 0; i < stockpiles.size(); i++) {
+            affordable += stockpiles[i].canAfford(cost) ? 1 : 0;
+        }
+    }
+    timings.affordMs = elapsedMs(start);
+
+    start = Clock::now();
+    R scaled;
+    for (int iteration = 0; iteration < ITERATIONS; iteration++) {
+        for (size_t i = 0; i < income.size(); i++) {
+            scaled = scaled + income[i] * (1 + static_cast<int>(i % 7));
+        }
+    }
+    timings.scaleMs = elapsedMs(start);
+
+    start = Clock::now();
+    R total;
+    for (int iteration = 0; iteration < ITERATIONS; iteration++) {
+        total = total + sumAll(stockpiles);
+    }
+    timings.sumMs = elapsedMs(start);
+
+    timings.checksum = affordable;
+    for (int type = 0; type < 7; type++) {
+        timings.checksum += static_cast<long long>(total[static_cast<ResourceType>(type)]) * (type + 1) +
+                            scaled[static_cast<ResourceType>(type)];
+    }
+    return timings;
+}
+
+const char* vectorPath() {
+#if defined(__AVX2__)
+    return "AVX2";
+#elif defined(__SSE2__) || defined(_M_X64)
+    return "SSE2";
+#else
+    return "scalar";
+#endif
+}
+
+} // namespace
+
+int main() {
+    std::vector<FieldResources> oldStockpiles(STOCKPILES);
+    std::vector<FieldResources> oldIncome(STOCKPILES);
+    std::vector<Resources> stockpiles(STOCKPILES);
+    std::vector<Resources> income(STOCKPILES);
+    RandomStream rng(17);
+    for (size_t i = 0; i < STOCKPILES; i++) {
+        for (int type = 0; type < 7; type++) {
+            ResourceType resource = static_cast<ResourceType>(type);
+            int amount = rng.nextInt(0, resource == ResourceType::Gold ? 2000 : 4);
+            oldIncome[i][resource] = amount;
+            income[i][resource] = amount;
+        }
+    }
+    FieldResources oldCost;
+    oldCost.gold = 2500000;
+    oldCost.wood = 2000;
+    Resources cost;
+    cost.gold = 2500000;
+    cost.wood = 2000;
+
+    Timings before = run(oldStockpiles, oldIncome, oldCost, [](const std::vector<FieldResources>& values) {
+        FieldResources total;
+        for (const FieldResources& value : values) {
+            total = total + value;
+        }
+        return total;
+    });
+    Timings after = run(stockpiles, income, cost, [](const std::vector<Resources>& values) {
+        return Resources::sum(values.data(), values.size());
+    });
+
+    std::cout << "Resources: " << STOCKPILES << " stockpiles x " << ITERATIONS << " iterations, " << vectorPath()
+              << " path\n";
+    auto row = [](const char* name, double oldMs, double newMs) {
+        std::cout << "  " << name << ": fields " << oldMs << " ms, lanes " << newMs << " ms (" << oldMs / newMs
+                  << "x)\n";
+    };
+    row("add income", before.addMs, after.addMs);
+    row("can afford", before.affordMs, after.affordMs);
+    row("scale and add", before.scaleMs, after.scaleMs);
+    row("bulk sum", before.sumMs, after.sumMs);
+
+    if (before.checksum != after.checksum) {
+        std::cerr << "FAILED: layouts disagree (" << before.checksum << " vs " << after.checksum << ")\n";
+        return 1;
+    }
+    std::cout << "OK\n";
+    return 0;
+}
@@ -0,0 +1,150 @@
+/*
+ * server_loopback.cpp - End-to-end GameServer benchmark over loopback TCP
+ * Realms of Eldoria
+ *
+ * Runs a GameServer on its own thread and drives it with many blocking clients from this
+ * thread: every client joins, then each round every client sends one command and waits for
+ * its result. Verifies sequence numbers and broadcasts along the way, and reports command
+ * throughput and round-trip latency.
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "../lib/net/GameServer.h"
+#include "../lib/net/NetClient.h"
+
+namespace {
+
+const int DEFAULT_CLIENTS = 256;
+const int ROUNDS = 20;
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+void createGame(GameState& gameState) {
+    auto map = std::make_unique<GameMap>(64, 64, 1);
+    for (PlayerID id = 1; id <= 2; id++) {
+        auto player = std::make_unique<Player>(id, "Player " + std::to_string(id), Faction::Castle, false);
+        auto hero = std::make_unique<Hero>(id, "Hero " + std::to_string(id), HeroClass::Knight);
+        hero->setPosition(Position(id * 20, id * 20, 0));
+        hero->getArmy().addCreatures(1, 10);
+        hero->resetMovementPoints();
+        player->addHero(id);
+        gameState.addHero(std::move(hero));
+        gameState.addPlayer(std::move(player));
+    }
+    gameState.setMap(std::move(map));
+    gameState.startGame();
+}
+
+int fail(const char* what, const NetClient& client) {
+    std::cerr << "FAILED: " << what << " (" << client.getLastError() << ")\n";
+    return 1;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int clientCount = argc > 1 ? std::max(1, std::atoi(argv[1])) : DEFAULT_CLIENTS;
+
+    GameState gameState;
+    createGame(gameState);
+
+    GameServer server(gameState);
+    if (!server.listen(0, true)) {
+        std::cerr << "FAILED: " << server.getLastError() << "\n";
+        return 1;
+    }
+    std::thread serverThread([&server]() { server.run(); });
+
+    std::cout << "Loopback server on port " << server.getPort() << ", " << clientCount
+              << " clients, " << ROUNDS << " rounds\n";
+
+    // Connect and join, alternating between the two players
+    auto start = Clock::now();
+    std::vector<std::unique_ptr<NetClient>> clients;
+    for (int i = 0; i < clientCount; i++) {
+        auto client = std::make_unique<NetClient>();
+        if (!client->connect("127.0.0.1", server.getPort())) {
+            return fail("connect", *client);
+        }
+        client->queue(MessageType::Join, JoinMessage{ PROTOCOL_VERSION, static_cast<PlayerID>(1 + i % 2), 0, 0 });
+        client->flush();
+        clients.push_back(std::move(client));
+    }
+    for (auto& client : clients) {
+        WelcomeMessage welcome;
+        if (!client->receiveMessage(MessageType::Welcome, welcome, 5000)) {
+            return fail("welcome", *client);
+        }
+    }
+    std::cout << "  connect + join: " << elapsedMs(start) << " ms\n";
+
+    // Every client sends a move each round; only the current player's succeed. The first
+    // client of the current player then ends the turn.
+    std::vector<double> latencies;
+    latencies.reserve(static_cast<size_t>(clientCount) * ROUNDS);
+    int accepted = 0;
+    int rejected = 0;
+    uint32_t sequence = 0;
+    PlayerID currentPlayer = 1;
+
+    start = Clock::now();
+    for (int round = 0; round < ROUNDS; round++) {
+        auto roundStart = Clock::now();
+        for (int i = 0; i < clientCount; i++) {
+            PlayerID player = static_cast<PlayerID>(1 + i % 2);
+            Position target(5 + (round * 7 + i) % 50, 5 + (round * 3 + i) % 50, 0);
+            clients[i]->queue(MessageType::Command, CommandMessage{ ++sequence, GameCommand::moveHero(player, player, target) });
+            clients[i]->flush();
+        }
+
+        uint32_t expected = sequence - static_cast<uint32_t>(clientCount);
+        for (int i = 0; i < clientCount; i++) {
+            CommandResultMessage result;
+            if (!clients[i]->receiveMessage(MessageType::CommandResult, result, 5000)) {
+                return fail("command result", *clients[i]);
+            }
+            if (result.sequence != ++expected) {
+                std::cerr << "FAILED: sequence " << result.sequence << " != " << expected << "\n";
+                return 1;
+            }
+            result.status == CommandStatus::Ok || result.status == CommandStatus::NoMovementLeft ? accepted++ : rejected++;
+            latencies.push_back(elapsedMs(roundStart));
+        }
+
+        // End the turn and check every client hears about it
+        NetClient& owner = *clients[currentPlayer - 1];
+        owner.queue(MessageType::Command, CommandMessage{ ++sequence, GameCommand::endTurn(currentPlayer) });
+        owner.flush();
+        for (auto& client : clients) {
+            TurnChangedMessage turn;
+            if (!client->receiveMessage(MessageType::TurnChanged, turn, 5000)) {
+                return fail("turn broadcast", *client);
+            }
+            currentPlayer = turn.currentPlayer;
+        }
+    }
+    double totalMs = elapsedMs(start);
+
+    std::sort(latencies.begin(), latencies.end());
+    int commands = clientCount * ROUNDS;
+    std::cout << "  " << commands << " commands (" << accepted << " applied, " << rejected
+              << " rejected as out of turn) in " << totalMs << " ms\n";
+    std::cout << "  throughput: " << commands / (totalMs / 1000.0) << " commands/s\n";
+    std::cout << "  result latency within a round: p50 " << latencies[latencies.size() / 2]
+              << " ms, p99 " << latencies[latencies.size() * 99 / 100] << " ms\n";
+
+    clients.clear();
+    server.stop();
+    serverThread.join();
+    std::cout << "OK\n";
+    return 0;
+}
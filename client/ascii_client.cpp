@@ -6,6 +6,7 @@
 #include <termios.h>
 #include <unistd.h>
 #include <algorithm>
+#include <chrono>
 #include "../lib/gamestate/GameState.h"
 #include "../lib/entities/hero/Hero.h"
 #include "../lib/map/GameMap.h"
@@ -24,11 +25,14 @@ private:
     
     GameScreen currentScreen;
     int selectedHero;
+    RandomStream battleStreams;   // Seeded once per session, split per battle
+    uint64_t battlesFought;
     const int MAP_WIDTH = 20;
     const int MAP_HEIGHT = 15;
     
 public:
-    AsciiGameClient() : running(false), currentScreen(GameScreen::MainMenu), selectedHero(1) {}
+    AsciiGameClient() : running(false), currentScreen(GameScreen::MainMenu), selectedHero(1),
+                        battleStreams(static_cast<uint64_t>(std::chrono::system_clock::now().time_since_epoch().count())), battlesFought(0) {}
     
     void run() {
         initialize();
@@ -411,7 +415,7 @@ private:
         Position currentPos = hero->getPosition();
         Position newPos(currentPos.x + dx, currentPos.y + dy, currentPos.z);
         
-        if (map->isValidPosition(newPos) && map->canHeroMoveTo(hero->getId(), newPos)) {
+        if (map->isValidPosition(newPos) && map->canHeroEnter(hero->getId(), newPos)) {
             map->moveHero(hero->getId(), currentPos, newPos);
             hero->setPosition(newPos);
             hero->setMovementPoints(hero->getMovementPoints() - 100);
@@ -529,7 +533,7 @@ private:
     
     BattleResult conductBattle(Hero* hero, MonsterGroup* monsters) {
         // Create battle engine
-        BattleEngine battle(hero);
+        BattleEngine battle(hero, battleStreams.split(battlesFought++));
         
         // Add hero's army to battle
         const Army& army = hero->getArmy();
@@ -549,7 +553,10 @@ private:
         std::cout << "Press any key to begin battle...\n";
         getChar();
         
-        // Execute battle
+        // Execute battle, streaming rounds and attacks to the console
+        BattleEventLog battleLog;
+        battle.setEventLog(&battleLog);
+        AsciiBattleDisplay::attach(battleLog, battle);
         BattleResult result = battle.executeAutoBattle();
         
         // Show result
@@ -3,10 +3,12 @@
  * Realms of Eldoria
  */
 #include <SDL2/SDL.h>
+#include <chrono>
 #include <iostream>
 #include <memory>
 #include "../include/GameTypes.h"
 #include "../lib/gamestate/GameState.h"
+#include "../lib/gamestate/AutoSaver.h"
 #include "../lib/map/GameMap.h"
 #include "../lib/entities/hero/Hero.h"
 #include "../lib/battle/Battle.h"
@@ -27,6 +29,7 @@ private:
     SDL_Window* window;
     SDL_Surface* screenSurface;
     std::unique_ptr<GameState> gameState;
+    std::unique_ptr<AutoSaver> autoSaver;
     std::unique_ptr<MapView> mapView;
     std::unique_ptr<ResourceBar> resourceBar;
     std::unique_ptr<HeroPanel> heroPanel;
@@ -35,6 +38,8 @@ private:
     bool running;
     Hero* selectedHero;
     bool inBattle;
+    RandomStream battleStreams;   // Seeded once per session, split per battle
+    uint64_t battlesFought;
 
     void initializeGameState() {
         // Create player
@@ -120,7 +125,7 @@ private:
 
     BattleResult conductBattle(Hero* hero, MonsterGroup* monsters) {
         // Create battle engine
-        BattleEngine battle(hero);
+        BattleEngine battle(hero, battleStreams.split(battlesFought++));
 
         // Add hero's army to battle
         const Army& army = hero->getArmy();
@@ -221,6 +226,7 @@ private:
             case SDLK_n:
                 // Next turn
                 gameState->nextTurn();
+                autoSaver->autosave(*gameState);  // Written on the autosave thread
                 refreshUI();
                 break;
 
@@ -301,7 +307,7 @@ private:
                             MonsterGroup* monsters = static_cast<MonsterGroup*>(monsterObj);
 
                             // Create battle engine
-                            BattleEngine* battle = new BattleEngine(selectedHero);
+                            BattleEngine* battle = new BattleEngine(selectedHero, battleStreams.split(battlesFought++));
 
                             // Add hero's army to battle
                             Army& army = selectedHero->getArmy();
@@ -453,6 +459,8 @@ public:
         , running(false)
         , selectedHero(nullptr)
         , inBattle(false)
+        , battleStreams(static_cast<uint64_t>(std::chrono::system_clock::now().time_since_epoch().count()))
+        , battlesFought(0)
     {
     }
 
@@ -491,6 +499,7 @@ public:
 
         // Initialize game with test data (similar to ASCII client)
         initializeGameState();
+        autoSaver = std::make_unique<AutoSaver>("autosave");
 
         // Create map view with viewport size
         mapView = std::make_unique<MapView>(Point(SCREEN_WIDTH, SCREEN_HEIGHT));
@@ -544,6 +553,7 @@ public:
         heroPanel.reset();
         resourceBar.reset();
         mapView.reset();
+        autoSaver.reset();  // Waits for the last autosave to reach disk
         gameState.reset();
 
         if (window) {
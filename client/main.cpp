@@ -103,6 +103,7 @@ public:
                 break;
             case SDLK_SPACE:
                 gameState.nextTurn();
+                gameState.processDailyEvents();
                 std::cout << "Turn " << gameState.getTurnManager().getTurnNumber() 
                          << ", Day " << gameState.getTurnManager().getDayNumber() << std::endl;
                 break;
@@ -110,10 +111,7 @@ public:
     }
     
     void update() {
-        // Game logic updates would go here
-        if (gameState.getTurnManager().isNewWeek()) {
-            gameState.processWeeklyEvents();
-        }
+        // Game logic updates would go here; day events run from the scheduler when the turn ends
     }
     
     void render() {
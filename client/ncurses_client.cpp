@@ -2,6 +2,7 @@
 #include <string>
 #include <vector>
 #include <algorithm>
+#include <chrono>
 #include "../lib/gamestate/GameState.h"
 #include "../lib/entities/hero/Hero.h"
 #include "../lib/map/GameMap.h"
@@ -12,6 +13,8 @@ private:
     GameState gameState;
     bool running;
     int selectedHero;
+    RandomStream battleStreams;   // Seeded once per session, split per battle
+    uint64_t battlesFought;
     
     // Window management
     WINDOW* mapWin;
@@ -47,6 +50,7 @@ private:
     
 public:
     NcursesGameClient() : running(false), selectedHero(1), 
+                         battleStreams(static_cast<uint64_t>(std::chrono::system_clock::now().time_since_epoch().count())), battlesFought(0),
                          mapWin(nullptr), statusWin(nullptr), infoWin(nullptr), logWin(nullptr) {}
     
     ~NcursesGameClient() {
@@ -220,10 +224,7 @@ private:
     }
     
     void update() {
-        // Game logic updates
-        if (gameState.getTurnManager().isNewWeek()) {
-            gameState.processWeeklyEvents();
-        }
+        // Game logic updates; day events run from the scheduler when the turn ends
     }
     
     void render() {
@@ -479,7 +480,7 @@ private:
         Position currentPos = hero->getPosition();
         Position newPos(currentPos.x + dx, currentPos.y + dy, currentPos.z);
         
-        if (map->isValidPosition(newPos) && map->canHeroMoveTo(hero->getId(), newPos)) {
+        if (map->isValidPosition(newPos) && map->canHeroEnter(hero->getId(), newPos)) {
             map->moveHero(hero->getId(), currentPos, newPos);
             hero->setPosition(newPos);
             hero->setMovementPoints(hero->getMovementPoints() - 100);
@@ -576,7 +577,7 @@ private:
     }
     
     BattleResult conductBattle(Hero* hero, MonsterGroup* monsters) {
-        BattleEngine battle(hero);
+        BattleEngine battle(hero, battleStreams.split(battlesFought++));
         
         // Show battle setup
         showMessage("=== BATTLE BEGINS ===");
@@ -138,14 +138,13 @@ void MapView::zoomOut()
 
 void MapView::renderTerrain(Canvas & canvas, const GameMap & map, const Rect & visibleTiles)
 {
+	// visibleTiles is already clamped to the map, so walk each row directly
 	for (int y = visibleTiles.y; y < visibleTiles.y + visibleTiles.h; y++)
 	{
+		const MapTile * row = &map.getTileUnchecked(0, y, 0);
 		for (int x = visibleTiles.x; x < visibleTiles.x + visibleTiles.w; x++)
 		{
-			if (!map.isValidPosition(x, y, 0))
-				continue;
-
-			const MapTile & tile = map.getTile(x, y, 0);
+			const MapTile & tile = row[x];
 			const Image * tileImg = getTerrainTile(tile.terrain);
 
 			if (tileImg)
@@ -203,21 +202,14 @@ void MapView::renderObjects(Canvas & canvas, const GameMap & map, const GameStat
 
 void MapView::renderHeroes(Canvas & canvas, const GameState & state, const Rect & visibleTiles)
 {
-	// Get all heroes from all players
-	// Since we don't have getPlayers(), we'll iterate through known heroes
-	for (HeroID heroId = 1; heroId < 100; heroId++)  // Arbitrary upper limit
+	// Only the heroes standing in view, found through the hero store's region index
+	std::vector<HeroHandle> visibleHeroes;
+	state.findHeroesInRegion(visibleTiles, 0, visibleHeroes);
+	for (HeroHandle handle : visibleHeroes)
 	{
-		const Hero * hero = state.getHero(heroId);
-		if (!hero)
-			continue;
-
+		const Hero * hero = state.getHero(handle);
 		const Position & pos = hero->getPosition();
 
-		// Check if hero is in visible range
-		if (pos.x < visibleTiles.x || pos.x >= visibleTiles.x + visibleTiles.w ||
-		    pos.y < visibleTiles.y || pos.y >= visibleTiles.y + visibleTiles.h)
-			continue;
-
 		Point screenPos = tileToScreen(Point(pos.x, pos.y));
 
 		// Draw hero as bright colored circle (scaled with zoom)
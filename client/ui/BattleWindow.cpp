@@ -243,6 +243,12 @@ void BattleWindow::startBattle(BattleEngine* engine, GameState* state) {
     battleLog->clear();
     battleLog->addMessage("Battle started!");
 
+    // Record what happens so the log can be replayed into the UI
+    eventLog.clear();
+    if (battleEngine) {
+        battleEngine->setEventLog(&eventLog);
+    }
+
     // Update battlefield with initial units
     if (battleEngine) {
         battlefield->setUnits(battleEngine->getPlayerUnits(),
@@ -293,6 +299,7 @@ void BattleWindow::onAutoBattle() {
 
     // Execute full auto-battle
     BattleResult result = battleEngine->executeAutoBattle();
+    showBattleEvents();
 
     // Update display
     battlefield->setUnits(battleEngine->getPlayerUnits(),
@@ -323,6 +330,33 @@ void BattleWindow::onClose() {
     }
 }
 
+void BattleWindow::showBattleEvents() {
+    for (const BattleEvent& event : eventLog.getEvents()) {
+        const Creature* attacker = GameState::getCreatureData(event.attackerCreature);
+        const Creature* defender = GameState::getCreatureData(event.defenderCreature);
+
+        switch (event.type) {
+            case BattleEventType::Attack:
+                if (attacker && defender) {
+                    std::string message = attacker->getName() + " hits " + defender->getName() +
+                                          " for " + std::to_string(event.damage);
+                    if (event.killed > 0) {
+                        message += " (" + std::to_string(event.killed) + " killed)";
+                    }
+                    battleLog->addMessage(message);
+                }
+                break;
+            case BattleEventType::UnitDeath:
+                if (defender) {
+                    battleLog->addMessage(defender->getName() + " stack destroyed");
+                }
+                break;
+            default:
+                break;
+        }
+    }
+}
+
 void BattleWindow::executeBattleRound() {
     // This would execute a single round (for manual battle mode)
     // Currently we only support auto-battle
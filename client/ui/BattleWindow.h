@@ -58,6 +58,7 @@ class BattleWindow : public Widget {
 private:
     BattleEngine* battleEngine;
     GameState* gameState;
+    BattleEventLog eventLog;
 
     std::unique_ptr<BattleField> battlefield;
     std::unique_ptr<BattleLog> battleLog;
@@ -72,6 +73,7 @@ private:
     void onAutoBattle();
     void onClose();
     void executeBattleRound();
+    void showBattleEvents();
     void updateUI();
 
 public:
@@ -1,61 +1,35 @@
 #include "../include/GameTypes.h"
 
-int& Resources::operator[](ResourceType type) {
-    switch (type) {
-        case ResourceType::Wood: return wood;
-        case ResourceType::Mercury: return mercury;
-        case ResourceType::Ore: return ore;
-        case ResourceType::Sulfur: return sulfur;
-        case ResourceType::Crystal: return crystal;
-        case ResourceType::Gems: return gems;
-        case ResourceType::Gold: return gold;
+Resources Resources::sum(const Resources* values, size_t count) {
+    Resources total;
+#if defined(__AVX2__)
+    // Two accumulators so consecutive adds don't wait on each other
+    __m256i first = _mm256_setzero_si256();
+    __m256i second = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 1 < count; i += 2) {
+        first = _mm256_add_epi32(first, _mm256_load_si256(reinterpret_cast<const __m256i*>(values[i].lanes)));
+        second = _mm256_add_epi32(second, _mm256_load_si256(reinterpret_cast<const __m256i*>(values[i + 1].lanes)));
     }
-    return gold; // fallback
-}
-
-const int& Resources::operator[](ResourceType type) const {
-    switch (type) {
-        case ResourceType::Wood: return wood;
-        case ResourceType::Mercury: return mercury;
-        case ResourceType::Ore: return ore;
-        case ResourceType::Sulfur: return sulfur;
-        case ResourceType::Crystal: return crystal;
-        case ResourceType::Gems: return gems;
-        case ResourceType::Gold: return gold;
+    if (i < count) {
+        first = _mm256_add_epi32(first, _mm256_load_si256(reinterpret_cast<const __m256i*>(values[i].lanes)));
     }
-    return gold; // fallback
-}
-
-Resources Resources::operator+(const Resources& other) const {
-    Resources result = *this;
-    result.wood += other.wood;
-    result.mercury += other.mercury;
-    result.ore += other.ore;
-    result.sulfur += other.sulfur;
-    result.crystal += other.crystal;
-    result.gems += other.gems;
-    result.gold += other.gold;
-    return result;
-}
-
-Resources Resources::operator-(const Resources& other) const {
-    Resources result = *this;
-    result.wood -= other.wood;
-    result.mercury -= other.mercury;
-    result.ore -= other.ore;
-    result.sulfur -= other.sulfur;
-    result.crystal -= other.crystal;
-    result.gems -= other.gems;
-    result.gold -= other.gold;
-    return result;
+    _mm256_store_si256(reinterpret_cast<__m256i*>(total.lanes), _mm256_add_epi32(first, second));
+#elif defined(__SSE2__) || defined(_M_X64)
+    __m128i low = _mm_setzero_si128();
+    __m128i high = _mm_setzero_si128();
+    for (size_t i = 0; i < count; i++) {
+        low = _mm_add_epi32(low, _mm_load_si128(reinterpret_cast<const __m128i*>(values[i].lanes)));
+        high = _mm_add_epi32(high, _mm_load_si128(reinterpret_cast<const __m128i*>(values[i].lanes + 4)));
+    }
+    _mm_store_si128(reinterpret_cast<__m128i*>(total.lanes), low);
+    _mm_store_si128(reinterpret_cast<__m128i*>(total.lanes + 4), high);
+#else
+    for (size_t i = 0; i < count; i++) {
+        for (int lane = 0; lane < LANES; lane++) {
+            total.lanes[lane] += values[i].lanes[lane];
+        }
+    }
+#endif
+    return total;
 }
-
-bool Resources::canAfford(const Resources& cost) const {
-    return wood >= cost.wood &&
-           mercury >= cost.mercury &&
-           ore >= cost.ore &&
-           sulfur >= cost.sulfur &&
-           crystal >= cost.crystal &&
-           gems >= cost.gems &&
-           gold >= cost.gold;
-}
\ No newline at end of file
@@ -0,0 +1,244 @@
+#include "AdventureAI.h"
+#include "../map/Pathfinder.h"
+#include <algorithm>
+#include <numeric>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const size_t CANDIDATES_KEPT = 4;        // Per hero, so heroes can fall back when targets collide
+const size_t DEADLINE_CHECK_EVERY = 64;  // Flood expansions between clock reads
+const double MIN_WIN_PROBABILITY = 0.8;  // Fights riskier than this are not worth the hero
+const double RARE_RESOURCE_VALUE = 250;  // Gold worth of one unit of the other resources
+const double ENEMY_MINE_BONUS = 1.5;     // Taking a mine from someone else is worth more
+
+const int NEIGHBOUR_DX[8] = { -1, 0, 1, -1, 1, -1, 0, 1 };
+const int NEIGHBOUR_DY[8] = { -1, -1, -1, 0, 0, 1, 1, 1 };
+
+double creatureStrength(CreatureID id) {
+    const Creature* creature = GameState::getCreatureData(id);
+    if (!creature) {
+        return 0;
+    }
+    if (creature->getAiValue() > 0) {
+        return creature->getAiValue();
+    }
+    return creature->getHitPoints() * (creature->getMinDamage() + creature->getMaxDamage()) * 0.5;
+}
+
+void keepBest(std::vector<AdventureAI::Candidate>& best, const AdventureAI::Candidate& candidate) {
+    if (best.size() == CANDIDATES_KEPT && candidate.score <= best.back().score) {
+        return;
+    }
+    auto position = std::upper_bound(best.begin(), best.end(), candidate,
+        [](const AdventureAI::Candidate& a, const AdventureAI::Candidate& b) { return a.score > b.score; });
+    best.insert(position, candidate);
+    if (best.size() > CANDIDATES_KEPT) {
+        best.pop_back();
+    }
+}
+
+} // namespace
+
+AdventureAI::AdventureAI(ThreadPool& threadPool, int turnBudgetMs)
+    : pool(threadPool), turnBudget(std::chrono::milliseconds(turnBudgetMs)) {
+}
+
+double AdventureAI::objectValue(const MapObject& object, PlayerID player, const Hero* hero) const {
+    if (const auto* mine = dynamic_cast<const ResourceMine*>(&object)) {
+        if (mine->getOwner() == player) {
+            return 0;
+        }
+        double perUnit = mine->getResourceType() == ResourceType::Gold ? 1.0 : RARE_RESOURCE_VALUE;
+        double value = mine->getDailyProduction() * perUnit;
+        return mine->getOwner() != 0 ? value * ENEMY_MINE_BONUS : value;
+    }
+    if (const auto* monsters = dynamic_cast<const MonsterGroup*>(&object)) {
+        double strength = monsters->getCount() * creatureStrength(monsters->getCreatureType());
+        if (strength <= 0) {
+            return 0;
+        }
+        // Experience grows with the strength beaten; the reward is paid out directly
+        double reward = strength * 0.5 + monsters->getReward().gold;
+        if (!hero) {
+            return reward;
+        }
+
+        BattleSetup setup;
+        setup.hero = hero;
+        for (int i = 0; i < Army::MAX_SLOTS; i++) {
+            setup.playerArmy.push_back(hero->getArmy().getSlot(i));
+        }
+        setup.enemyArmy.emplace_back(monsters->getCreatureType(), monsters->getCount());
+        BattleEstimate estimate = estimator.estimate(setup);
+        if (estimate.winProbability < MIN_WIN_PROBABILITY) {
+            return 0;
+        }
+        double losses = 0;
+        for (size_t i = 0; i < setup.playerArmy.size(); i++) {
+            const ArmySlot& slot = setup.playerArmy[i];
+            if (!slot.isEmpty()) {
+                losses += (slot.count - estimate.expectedPlayerSurvivors[i]) * creatureStrength(slot.creatureId);
+            }
+        }
+        return std::max(0.0, estimate.winProbability * reward - losses);
+    }
+    return 0;
+}
+
+AITurnReport AdventureAI::playTurn(HostedGame& game) {
+    auto start = Clock::now();
+    auto deadline = start + turnBudget;
+    AITurnReport report;
+
+    GameState& state = game.getState();
+    if (!state.isGameRunning()) {
+        return report;
+    }
+    PlayerID playerId = state.getCurrentPlayer();
+    const Player* player = state.getPlayer(playerId);
+    if (!player || player->isHumanPlayer()) {
+        return report;
+    }
+    report.player = playerId;
+
+    if (const GameMap* map = state.getMap()) {
+        // Upper bound on any target's value, for cutting searches short
+        double bestPossibleValue = 0;
+        for (const auto& object : map->getAllObjects()) {
+            bestPossibleValue = std::max(bestPossibleValue,
+                                         objectValue(*object, playerId, nullptr));
+        }
+
+        std::vector<HeroID> active;
+        for (HeroID heroId : player->getHeroes()) {
+            const Hero* hero = state.getHero(heroId);
+            if (hero && hero->getMovementPoints() > 0) {
+                active.push_back(heroId);
+            }
+        }
+
+        while (!active.empty() && report.rounds < MAX_ROUNDS && Clock::now() < deadline) {
+            report.rounds++;
+
+            // Nothing changes the state while the heroes search, and each hero's flood has its
+            // own cache entry
+            ReachabilityCache& reachability = *state.getReachabilityCache();
+            for (HeroID heroId : active) {
+                reachability.track(heroId);
+            }
+            std::vector<HeroPlan> plans(active.size());
+            pool.parallelFor(active.size(), [&](size_t index) {
+                plans[index].hero = active[index];
+                planHero(state, *state.getHero(active[index]), playerId, bestPossibleValue, reachability, deadline,
+                         plans[index]);
+            });
+
+            std::vector<size_t> order(plans.size());
+            std::iota(order.begin(), order.end(), 0);
+            for (const HeroPlan& plan : plans) {
+                report.tilesSearched += plan.tilesSearched;
+                report.outOfTime |= plan.outOfTime;
+            }
+            auto topScore = [&plans](size_t index) { return plans[index].best.empty() ? 0.0 : plans[index].best[0].score; };
+            std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return topScore(a) > topScore(b); });
+
+            std::vector<uint32_t> claimed;
+            std::vector<HeroID> stillActive;
+            for (size_t index : order) {
+                if (Clock::now() >= deadline) {
+                    report.outOfTime = true;
+                    break;
+                }
+                const HeroPlan& plan = plans[index];
+                auto target = std::find_if(plan.best.begin(), plan.best.end(), [&claimed](const Candidate& candidate) {
+                    return std::find(claimed.begin(), claimed.end(), candidate.objectId) == claimed.end();
+                });
+                if (target == plan.best.end()) {
+                    continue;   // Nothing worth doing within reach
+                }
+                claimed.push_back(target->objectId);
+
+                Hero* hero = state.getHero(plan.hero);
+                if (!(hero->getPosition() == target->destination)) {
+                    CommandOutcome moved = game.apply(GameCommand::moveHero(playerId, plan.hero, target->destination));
+                    report.commands++;
+                    if (!moved.succeeded() || !(moved.heroPosition == target->destination)) {
+                        continue;   // Out of movement (or blocked) for this turn
+                    }
+                }
+                if (target->fight) {
+                    CommandOutcome fought = game.apply(GameCommand::fight(playerId, plan.hero, target->objectId));
+                    report.commands++;
+                    if (!fought.succeeded() || !fought.objectRemoved) {
+                        continue;
+                    }
+                }
+                if (hero->getMovementPoints() > 0) {
+                    stillActive.push_back(plan.hero);
+                }
+            }
+            active.swap(stillActive);
+        }
+    }
+
+    game.apply(GameCommand::endTurn(playerId));
+    report.commands++;
+    report.ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    return report;
+}
+
+void AdventureAI::planHero(const GameState& state, const Hero& hero, PlayerID player, double bestPossibleValue,
+                           ReachabilityCache& reachability, Clock::time_point deadline, HeroPlan& plan) const {
+    const GameMap& map = *state.getMap();
+    const int maxMovement = std::max(1, hero.getMaxMovementPoints());
+    if (!map.isValidPosition(hero.getPosition())) {
+        return;
+    }
+
+    // The flood only changes when the hero moves or the map around it does, so heroes that stay
+    // put between rounds and turns reuse it
+    const ReachabilityMap& reach = reachability.getReachability(hero, HORIZON_DAYS * maxMovement);
+    std::vector<uint32_t> seenObjects;
+
+    for (const Position& current : reach.reachableTiles) {
+        int currentCost = reach.getCost(current);
+        if (++plan.tilesSearched % DEADLINE_CHECK_EVERY == 0 && Clock::now() >= deadline) {
+            plan.outOfTime = true;
+            return;
+        }
+        // Tiles come cheapest first, so targets only get further from here: stop once none
+        // could make the list
+        if (plan.best.size() == CANDIDATES_KEPT &&
+            plan.best.back().score >= bestPossibleValue / (1.0 + static_cast<double>(currentCost) / maxMovement)) {
+            return;
+        }
+
+        for (int dir = 0; dir < 8; dir++) {
+            Position next(current.x + NEIGHBOUR_DX[dir], current.y + NEIGHBOUR_DY[dir], current.z);
+            if (!map.isValidPosition(next)) {
+                continue;
+            }
+
+            const MapTile& tile = map.getTileUnchecked(next.x, next.y, next.z);
+            if ((tile.object == ObjectType::Monster || tile.object == ObjectType::Mine) &&
+                std::find(seenObjects.begin(), seenObjects.end(), tile.objectId) == seenObjects.end()) {
+                seenObjects.push_back(tile.objectId);
+                const MapObject* object = map.getObject(tile.objectId);
+                double value = object ? objectValue(*object, player, &hero) : 0;
+                if (value > 0) {
+                    // Monsters are fought from the tile next to them, mines are walked onto
+                    Candidate candidate;
+                    candidate.objectId = tile.objectId;
+                    candidate.fight = tile.object == ObjectType::Monster;
+                    candidate.destination = candidate.fight ? current : next;
+                    candidate.cost = candidate.fight ? currentCost
+                                                     : currentCost + Pathfinder::getStepCost(map, current, next);
+                    candidate.score = value / (1.0 + static_cast<double>(candidate.cost) / maxMovement);
+                    keepBest(plan.best, candidate);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "../gamestate/GameHost.h"
+#include "../battle/BattleEstimator.h"
+#include "../core/ThreadPool.h"
+#include <chrono>
+#include <vector>
+
+// What one computer player's turn did
+struct AITurnReport {
+    PlayerID player = 0;          // 0 if the current player was not computer-controlled
+    int commands = 0;             // Commands applied, including the final EndTurn
+    int rounds = 0;               // Plan-and-act rounds
+    size_t tilesSearched = 0;
+    bool outOfTime = false;       // Some search was cut short by the budget
+    double ms = 0;
+};
+
+// Adventure map AI for players whose isHumanPlayer() is false.
+//
+// A turn runs in rounds. Each round, every hero that can still act searches the map around it in
+// parallel on the pool. Its Dijkstra flood, bounded to a few days of movement, comes from the
+// game's ReachabilityCache and is walked cheapest tile first, scoring the unowned mines and
+// beatable monster groups next to the tiles by value over travel time. Fights are judged by
+// BattleEstimator: the reward weighted by the chance of winning, less the expected losses. The
+// walk meets candidates nearest first and stops once nothing further away could beat what it
+// holds, or when the turn's deadline passes, keeping the best found so far (anytime search).
+// Heroes then take their best targets in score order, never two the same, and walk towards or
+// attack them through the game's commands. The turn ends with EndTurn once no hero has anything
+// left to do or the budget is spent, so a turn never takes much longer than the budget.
+//
+// Safe to share between games: playTurn keeps no game state between calls (only estimates) and
+// may run for several games at once. Because searches can be cut short by time, the commands
+// chosen depend on the machine's speed; record a command log to reproduce a game.
+class AdventureAI {
+public:
+    static const int DEFAULT_TURN_BUDGET_MS = 20;
+    static const int HORIZON_DAYS = 3;         // How far ahead, in days of movement, heroes look
+    static const int MAX_ROUNDS = 4;
+
+    struct Candidate {
+        uint32_t objectId = 0;
+        Position destination;     // Where to walk: the mine itself, or a tile next to the monsters
+        int cost = 0;             // Movement points to get to destination
+        double score = 0;
+        bool fight = false;
+    };
+
+private:
+    ThreadPool& pool;
+    std::chrono::microseconds turnBudget;
+    mutable BattleEstimator estimator;     // Shared by the heroes' searches; locks internally
+
+    struct HeroPlan {
+        HeroID hero = 0;
+        std::vector<Candidate> best;    // Highest score first
+        size_t tilesSearched = 0;
+        bool outOfTime = false;
+    };
+
+public:
+    explicit AdventureAI(ThreadPool& threadPool, int turnBudgetMs = DEFAULT_TURN_BUDGET_MS);
+
+    void setTurnBudget(int turnBudgetMs) { turnBudget = std::chrono::milliseconds(turnBudgetMs); }
+    int getTurnBudgetMs() const {
+        return static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(turnBudget).count());
+    }
+
+    // Play the current player's whole turn if it is computer-controlled. For GameHost::setTurnHandler.
+    AITurnReport playTurn(HostedGame& game);
+
+private:
+    void planHero(const GameState& state, const Hero& hero, PlayerID player, double bestPossibleValue,
+                  ReachabilityCache& reachability, std::chrono::steady_clock::time_point deadline,
+                  HeroPlan& plan) const;
+    // What taking the object is worth to hero; with no hero, the most it could be worth to anyone
+    double objectValue(const MapObject& object, PlayerID player, const Hero* hero) const;
+};
@@ -1,28 +1,59 @@
 #include "Battle.h"
+#include "BattleAI.h"
 #include "../gamestate/GameState.h"
 #include <iostream>
 #include <algorithm>
 #include <cmath>
 #include <climits>
 
-BattleEngine::BattleEngine(Hero* hero) 
-    : attackingHero(hero), battleActive(false), rng(std::random_device{}()) {
+BattleEngine::BattleEngine(const Hero* hero, const RandomStream& stream) 
+    : BattleEngine(hero, stream, GameState::getCreatureDatabase()) {
+}
+
+BattleEngine::BattleEngine(const Hero* hero, const RandomStream& stream,
+                           std::shared_ptr<const CreatureDatabase> database)
+    : attackingHero(hero), battleActive(false), currentRound(0), eventLog(nullptr), rng(stream), tacticalAI{ nullptr, nullptr },
+      creatures(std::move(database)) {
+}
+
+BattleEngine::BattleEngine(const Hero* hero, uint64_t seed) 
+    : attackingHero(hero), battleActive(false), currentRound(0), eventLog(nullptr), rng(seed), tacticalAI{ nullptr, nullptr },
+      creatures(GameState::getCreatureDatabase()) {
+}
+
+const Creature* BattleEngine::creatureData(CreatureID id) const {
+    return creatures ? creatures->get(id) : nullptr;
+}
+
+void BattleEngine::setTacticalAI(BattleAI* ai, bool playerSide, bool enemySide) {
+    tacticalAI[0] = playerSide ? ai : nullptr;
+    tacticalAI[1] = enemySide ? ai : nullptr;
 }
 
 void BattleEngine::addPlayerUnit(CreatureID creatureId, int count) {
-    const Creature* creatureData = GameState::getCreatureData(creatureId);
-    if (creatureData && count > 0) {
-        playerUnits.emplace_back(creatureId, count, creatureData->getHitPoints(), true);
+    const Creature* creature = creatureData(creatureId);
+    if (creature && count > 0) {
+        int slot = static_cast<int>(playerUnits.size());
+        playerUnits.emplace_back(creatureId, count, creature->getHitPoints(), true, slot);
     }
 }
 
 void BattleEngine::addEnemyUnit(CreatureID creatureId, int count) {
-    const Creature* creatureData = GameState::getCreatureData(creatureId);
-    if (creatureData && count > 0) {
-        enemyUnits.emplace_back(creatureId, count, creatureData->getHitPoints(), false);
+    const Creature* creature = creatureData(creatureId);
+    if (creature && count > 0) {
+        int slot = static_cast<int>(enemyUnits.size());
+        enemyUnits.emplace_back(creatureId, count, creature->getHitPoints(), false, slot);
     }
 }
 
+void BattleEngine::clearUnits() {
+    playerUnits.clear();
+    enemyUnits.clear();
+    initialPlayerUnits.clear();
+    initialEnemyUnits.clear();
+    battleActive = false;
+}
+
 BattleResult BattleEngine::executeBattle() {
     return executeAutoBattle(); // For now, always auto-battle
 }
@@ -34,23 +65,34 @@ BattleResult BattleEngine::executeAutoBattle() {
     const int MAX_ROUNDS = 20; // Prevent infinite battles
     
     while (battleActive && roundNumber <= MAX_ROUNDS) {
-        AsciiBattleDisplay::showBattleRound(playerUnits, enemyUnits, roundNumber);
+        currentRound = roundNumber;
+        recordEvent(BattleEventType::RoundStart);
         
         executeRound();
         
+        recordEvent(BattleEventType::RoundEnd);
+        
         if (checkBattleEnd()) {
             break;
         }
         
         roundNumber++;
-        
-        // Brief pause for readability
-        std::cout << "\nPress any key to continue to next round...\n";
-        std::cin.get();
     }
     
     endBattle();
-    return determineBattleResult();
+    BattleResult result = determineBattleResult();
+    
+    if (eventLog) {
+        BattleEvent event{};
+        event.type = BattleEventType::BattleEnd;
+        event.result = static_cast<uint8_t>(result);
+        event.round = static_cast<int16_t>(currentRound);
+        event.attackerSlot = -1;
+        event.defenderSlot = -1;
+        eventLog->append(event);
+    }
+    
+    return result;
 }
 
 void BattleEngine::initializeBattle() {
@@ -68,38 +110,28 @@ void BattleEngine::initializeBattle() {
             [](const BattleUnit& unit) { return unit.count <= 0; }),
         enemyUnits.end()
     );
+    
+    initialPlayerUnits = playerUnits;
+    initialEnemyUnits = enemyUnits;
+    
+    currentRound = 0;
+    recordEvent(BattleEventType::BattleStart);
 }
 
 void BattleEngine::executeRound() {
     // Simple turn-based combat: all player units attack, then all enemy units
     
     // Player units attack
-    for (auto& playerUnit : playerUnits) {
+    for (int i = 0; i < static_cast<int>(playerUnits.size()); i++) {
+        auto& playerUnit = playerUnits[i];
         if (playerUnit.count <= 0) continue;
         
         // Find best enemy target
-        int targetIndex = selectBestTarget(enemyUnits);
+        int targetIndex = chooseTarget(true, i);
         if (targetIndex >= 0 && targetIndex < static_cast<int>(enemyUnits.size())) {
             auto& target = enemyUnits[targetIndex];
             if (target.count > 0) {
-                int damage = calculateDamage(playerUnit, target);
-                AsciiBattleDisplay::showDamage(playerUnit, target, damage);
-                
-                // Apply damage
-                int killedUnits = damage / GameState::getCreatureData(target.creatureId)->getHitPoints();
-                target.count -= killedUnits;
-                
-                // Handle partial damage to remaining unit
-                int remainingDamage = damage % GameState::getCreatureData(target.creatureId)->getHitPoints();
-                if (remainingDamage > 0 && target.count > 0) {
-                    target.currentHealth -= remainingDamage;
-                    if (target.currentHealth <= 0) {
-                        target.count--;
-                        target.currentHealth = GameState::getCreatureData(target.creatureId)->getHitPoints();
-                    }
-                }
-                
-                target.count = std::max(0, target.count);
+                attack(playerUnit, target);
             }
         }
     }
@@ -112,32 +144,16 @@ void BattleEngine::executeRound() {
     );
     
     // Enemy units attack (if any remain)
-    for (auto& enemyUnit : enemyUnits) {
+    for (int i = 0; i < static_cast<int>(enemyUnits.size()); i++) {
+        auto& enemyUnit = enemyUnits[i];
         if (enemyUnit.count <= 0) continue;
         
         // Find best player target
-        int targetIndex = selectBestTarget(playerUnits);
+        int targetIndex = chooseTarget(false, i);
         if (targetIndex >= 0 && targetIndex < static_cast<int>(playerUnits.size())) {
             auto& target = playerUnits[targetIndex];
             if (target.count > 0) {
-                int damage = calculateDamage(enemyUnit, target);
-                AsciiBattleDisplay::showDamage(enemyUnit, target, damage);
-                
-                // Apply damage
-                int killedUnits = damage / GameState::getCreatureData(target.creatureId)->getHitPoints();
-                target.count -= killedUnits;
-                
-                // Handle partial damage
-                int remainingDamage = damage % GameState::getCreatureData(target.creatureId)->getHitPoints();
-                if (remainingDamage > 0 && target.count > 0) {
-                    target.currentHealth -= remainingDamage;
-                    if (target.currentHealth <= 0) {
-                        target.count--;
-                        target.currentHealth = GameState::getCreatureData(target.creatureId)->getHitPoints();
-                    }
-                }
-                
-                target.count = std::max(0, target.count);
+                attack(enemyUnit, target);
             }
         }
     }
@@ -150,16 +166,75 @@ void BattleEngine::executeRound() {
     );
 }
 
+void BattleEngine::attack(BattleUnit& attacker, BattleUnit& target) {
+    int damage = calculateDamage(attacker, target);
+    int killed = applyDamage(target, damage);
+    
+    if (eventLog) {
+        recordEvent(BattleEventType::Attack, &attacker, &target, damage, killed);
+        if (target.count == 0) {
+            recordEvent(BattleEventType::UnitDeath, nullptr, &target);
+        }
+    }
+}
+
+int BattleEngine::applyDamage(BattleUnit& target, int damage) {
+    int countBefore = target.count;
+    int hitPoints = creatureData(target.creatureId)->getHitPoints();
+    
+    // Apply damage
+    int killedUnits = damage / hitPoints;
+    target.count -= killedUnits;
+    
+    // Handle partial damage to remaining unit
+    int remainingDamage = damage % hitPoints;
+    if (remainingDamage > 0 && target.count > 0) {
+        target.currentHealth -= remainingDamage;
+        if (target.currentHealth <= 0) {
+            target.count--;
+            target.currentHealth = hitPoints;
+        }
+    }
+    
+    target.count = std::max(0, target.count);
+    return countBefore - target.count;
+}
+
+void BattleEngine::recordEvent(BattleEventType type, const BattleUnit* actor, const BattleUnit* target,
+                               int damage, int killed) {
+    if (!eventLog) {
+        return;
+    }
+    
+    BattleEvent event{};
+    event.type = type;
+    event.round = static_cast<int16_t>(currentRound);
+    event.attackerSlot = actor ? static_cast<int16_t>(actor->slot) : -1;
+    event.defenderSlot = target ? static_cast<int16_t>(target->slot) : -1;
+    event.attackerCreature = actor ? actor->creatureId : 0;
+    event.defenderCreature = target ? target->creatureId : 0;
+    event.damage = damage;
+    event.killed = killed;
+    
+    if (actor) {
+        event.playerSide = actor->isPlayerControlled ? 1 : 0;
+    } else if (target) {
+        event.playerSide = target->isPlayerControlled ? 1 : 0;
+    }
+    
+    eventLog->append(event);
+}
+
 int BattleEngine::calculateDamage(const BattleUnit& attacker, const BattleUnit& defender) {
-    const Creature* attackerCreature = GameState::getCreatureData(attacker.creatureId);
-    const Creature* defenderCreature = GameState::getCreatureData(defender.creatureId);
+    const Creature* attackerCreature = creatureData(attacker.creatureId);
+    const Creature* defenderCreature = creatureData(defender.creatureId);
     
     if (!attackerCreature || !defenderCreature) {
         return 0;
     }
     
     // Base damage calculation
-    int baseDamage = attackerCreature->calculateDamageAgainst(*defenderCreature);
+    int baseDamage = attackerCreature->calculateDamageAgainst(*defenderCreature, rng);
     
     // Apply hero bonuses if attacking hero exists
     if (attacker.isPlayerControlled && attackingHero) {
@@ -171,12 +246,25 @@ int BattleEngine::calculateDamage(const BattleUnit& attacker, const BattleUnit&
     int totalDamage = baseDamage * attacker.count;
     
     // Add some randomness (±20%)
-    std::uniform_real_distribution<float> variance(0.8f, 1.2f);
-    totalDamage = static_cast<int>(totalDamage * variance(rng));
+    totalDamage = static_cast<int>(totalDamage * rng.nextFloat(0.8f, 1.2f));
     
     return std::max(1, totalDamage);
 }
 
+int BattleEngine::chooseTarget(bool playerSide, int actorIndex) {
+    const std::vector<BattleUnit>& targets = playerSide ? enemyUnits : playerUnits;
+    BattleAI* ai = tacticalAI[playerSide ? 0 : 1];
+    BattleState state;
+    if (ai && BattleState::capture(playerUnits, enemyUnits, attackingHero, playerSide, actorIndex, currentRound, state)) {
+        // A fresh stream per decision, keyed by the battle stream's position
+        int target = ai->chooseTarget(state, rng.split(rng.getCounter()));
+        if (target >= 0) {
+            return target;
+        }
+    }
+    return selectBestTarget(targets);
+}
+
 int BattleEngine::selectBestTarget(const std::vector<BattleUnit>& targets) {
     if (targets.empty()) {
         return -1;
@@ -189,7 +277,7 @@ int BattleEngine::selectBestTarget(const std::vector<BattleUnit>& targets) {
     for (int i = 0; i < static_cast<int>(targets.size()); i++) {
         if (targets[i].count <= 0) continue;
         
-        const Creature* creature = GameState::getCreatureData(targets[i].creatureId);
+        const Creature* creature = creatureData(targets[i].creatureId);
         if (creature) {
             int totalHealth = creature->getHitPoints() * targets[i].count;
             if (totalHealth < lowestHealth) {
@@ -214,7 +302,7 @@ int BattleEngine::selectBestAttacker(const std::vector<BattleUnit>& attackers) {
     for (int i = 0; i < static_cast<int>(attackers.size()); i++) {
         if (attackers[i].count <= 0) continue;
         
-        const Creature* creature = GameState::getCreatureData(attackers[i].creatureId);
+        const Creature* creature = creatureData(attackers[i].creatureId);
         if (creature && creature->getAttack() > highestAttack) {
             highestAttack = creature->getAttack();
             bestIndex = i;
@@ -242,15 +330,40 @@ BattleResult BattleEngine::determineBattleResult() {
     return playerHasUnits ? BattleResult::Victory : BattleResult::Defeat;
 }
 
+namespace {
+
+int casualtiesInSlot(const std::vector<BattleUnit>& initialUnits, const std::vector<BattleUnit>& survivors, int slot) {
+    auto initial = std::find_if(initialUnits.begin(), initialUnits.end(),
+        [slot](const BattleUnit& unit) { return unit.slot == slot; });
+    if (initial == initialUnits.end()) {
+        return 0;
+    }
+    
+    auto survivor = std::find_if(survivors.begin(), survivors.end(),
+        [slot](const BattleUnit& unit) { return unit.slot == slot; });
+    int remaining = (survivor != survivors.end()) ? survivor->count : 0;
+    return initial->count - remaining;
+}
+
+} // namespace
+
+int BattleEngine::getPlayerCasualties(int slot) const {
+    return casualtiesInSlot(initialPlayerUnits, playerUnits, slot);
+}
+
+int BattleEngine::getEnemyCasualties(int slot) const {
+    return casualtiesInSlot(initialEnemyUnits, enemyUnits, slot);
+}
+
 int BattleEngine::calculateExperienceGained() const {
     int totalExperience = 0;
     
     // Experience is based on enemy units that were defeated
-    for (const auto& unit : enemyUnits) {
-        const Creature* creature = GameState::getCreatureData(unit.creatureId);
+    for (const auto& unit : initialEnemyUnits) {
+        const Creature* creature = creatureData(unit.creatureId);
         if (creature) {
             // Experience = creature AI value * defeated count
-            totalExperience += creature->getAiValue() * std::max(0, 5 - unit.count); // Assuming started with 5
+            totalExperience += creature->getAiValue() * getEnemyCasualties(unit.slot);
         }
     }
     
@@ -258,6 +371,51 @@ int BattleEngine::calculateExperienceGained() const {
 }
 
 // ASCII Battle Display Implementation
+void AsciiBattleDisplay::attach(BattleEventLog& log, const BattleEngine& engine, bool pauseBetweenRounds) {
+    log.setListener([&engine, pauseBetweenRounds](const BattleEvent& event) {
+        switch (event.type) {
+            case BattleEventType::RoundStart:
+                showBattleRound(engine.getPlayerUnits(), engine.getEnemyUnits(), event.round);
+                break;
+                
+            case BattleEventType::RoundEnd:
+                // Brief pause for readability while both sides are still standing
+                if (pauseBetweenRounds && !engine.getPlayerUnits().empty() && !engine.getEnemyUnits().empty()) {
+                    std::cout << "\nPress any key to continue to next round...\n";
+                    std::cin.get();
+                }
+                break;
+                
+            default:
+                showEvent(event);
+                break;
+        }
+    });
+}
+
+void AsciiBattleDisplay::showEvent(const BattleEvent& event) {
+    const Creature* attackerCreature = GameState::getCreatureData(event.attackerCreature);
+    const Creature* defenderCreature = GameState::getCreatureData(event.defenderCreature);
+    
+    switch (event.type) {
+        case BattleEventType::Attack:
+            if (attackerCreature && defenderCreature) {
+                std::cout << attackerCreature->getName() << " attacks " 
+                          << defenderCreature->getName() << " for " << event.damage << " damage!\n";
+            }
+            break;
+            
+        case BattleEventType::UnitDeath:
+            if (defenderCreature) {
+                std::cout << "The " << defenderCreature->getName() << " stack is destroyed!\n";
+            }
+            break;
+            
+        default:
+            break;
+    }
+}
+
 void AsciiBattleDisplay::showBattleStart(const Hero* hero, const std::vector<BattleUnit>& enemies) {
     std::cout << "\n╔══════════════════════════════════════════════════════════════╗\n";
     std::cout << "║                        BATTLE BEGINS!                       ║\n";
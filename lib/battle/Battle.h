@@ -3,9 +3,13 @@
 #include "../../include/GameTypes.h"
 #include "../entities/hero/Hero.h"
 #include "../entities/creature/Creature.h"
+#include "BattleEvents.h"
+#include "../core/Random.h"
 #include <vector>
 #include <memory>
-#include <random>
+
+class BattleAI;
+class CreatureDatabase;
 
 enum class BattleResult {
     Victory,
@@ -18,26 +22,50 @@ struct BattleUnit {
     int count;
     int currentHealth;
     bool isPlayerControlled;
+    int slot;  // Order in which the unit was added to its side
     
-    BattleUnit(CreatureID id, int cnt, int health, bool player) 
-        : creatureId(id), count(cnt), currentHealth(health), isPlayerControlled(player) {}
+    BattleUnit(CreatureID id, int cnt, int health, bool player, int unitSlot = -1) 
+        : creatureId(id), count(cnt), currentHealth(health), isPlayerControlled(player), slot(unitSlot) {}
 };
 
 class BattleEngine {
 private:
-    Hero* attackingHero;
+    const Hero* attackingHero;
     std::vector<BattleUnit> playerUnits;
     std::vector<BattleUnit> enemyUnits;
+    std::vector<BattleUnit> initialPlayerUnits;  // Snapshot taken when the battle starts
+    std::vector<BattleUnit> initialEnemyUnits;
     bool battleActive;
-    std::mt19937 rng;
+    int currentRound;
+    BattleEventLog* eventLog;  // Optional, nothing is recorded when null
+    RandomStream rng;
+    BattleAI* tacticalAI[2];   // Target choice per side (player, enemy); selectBestTarget when null
+    std::shared_ptr<const CreatureDatabase> creatures;  // Creature stats, pinned for the engine's lifetime
     
 public:
-    BattleEngine(Hero* hero);
+    // All rolls come from the given stream, so a battle replays exactly from its stream's seed.
+    // Creature stats come from database, or from GameState's current database when none is given.
+    BattleEngine(const Hero* hero, const RandomStream& stream);
+    BattleEngine(const Hero* hero, const RandomStream& stream, std::shared_ptr<const CreatureDatabase> database);
+    BattleEngine(const Hero* hero, uint64_t seed);
     ~BattleEngine() = default;
     
+    // The engine does no I/O itself; presentation consumes the event log instead
+    void setEventLog(BattleEventLog* log) { eventLog = log; }
+    BattleEventLog* getEventLog() const { return eventLog; }
+    
+    // Let a search pick the targets of either side. Its streams are split from the battle's without
+    // consuming it, so the battle still replays exactly from its seed (given no search time budget).
+    void setTacticalAI(BattleAI* ai, bool playerSide = true, bool enemySide = true);
+    
+    void setSeed(uint64_t seed) { rng = RandomStream(seed); }
+    void setRandomStream(const RandomStream& stream) { rng = stream; }
+    RandomStream& getRandomStream() { return rng; }
+    
     // Battle setup
     void addPlayerUnit(CreatureID creatureId, int count);
     void addEnemyUnit(CreatureID creatureId, int count);
+    void clearUnits();
     
     // Battle execution
     BattleResult executeBattle();
@@ -51,17 +79,29 @@ public:
     const std::vector<BattleUnit>& getPlayerUnits() const { return playerUnits; }
     const std::vector<BattleUnit>& getEnemyUnits() const { return enemyUnits; }
     
+    // Losses per unit slot, valid once a battle has been executed
+    int getPlayerCasualties(int slot) const;
+    int getEnemyCasualties(int slot) const;
+    const std::vector<BattleUnit>& getInitialPlayerUnits() const { return initialPlayerUnits; }
+    const std::vector<BattleUnit>& getInitialEnemyUnits() const { return initialEnemyUnits; }
+    
     // Experience calculation
     int calculateExperienceGained() const;
     
 private:
+    const Creature* creatureData(CreatureID id) const;
     void initializeBattle();
     int calculateDamage(const BattleUnit& attacker, const BattleUnit& defender);
+    int applyDamage(BattleUnit& target, int damage);
+    void attack(BattleUnit& attacker, BattleUnit& target);
+    void recordEvent(BattleEventType type, const BattleUnit* actor = nullptr, const BattleUnit* target = nullptr,
+                     int damage = 0, int killed = 0);
     void executeRound();
     bool checkBattleEnd();
     BattleResult determineBattleResult();
     
     // AI decision making
+    int chooseTarget(bool playerSide, int actorIndex);
     int selectBestTarget(const std::vector<BattleUnit>& targets);
     int selectBestAttacker(const std::vector<BattleUnit>& attackers);
 };
@@ -69,6 +109,10 @@ private:
 // Simple ASCII battle display
 class AsciiBattleDisplay {
 public:
+    // Stream the engine's events to the console as they are recorded, optionally waiting for a key after each round
+    static void attach(BattleEventLog& log, const BattleEngine& engine, bool pauseBetweenRounds = true);
+    static void showEvent(const BattleEvent& event);
+
     static void showBattleStart(const Hero* hero, const std::vector<BattleUnit>& enemies);
     static void showBattleRound(const std::vector<BattleUnit>& playerUnits, 
                                const std::vector<BattleUnit>& enemyUnits, 
@@ -0,0 +1,304 @@
+#include "BattleAI.h"
+#include "../gamestate/GameState.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <climits>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const int DEADLINE_CHECK_EVERY = 32;   // Iterations between clock reads
+
+// Per decision point: statistics of each target, indexed like the units of the side being attacked
+struct Node {
+    uint32_t visits[BattleState::MAX_UNITS] = {};
+    float value[BattleState::MAX_UNITS] = {};     // Sum of player-side rewards
+    int32_t child[BattleState::MAX_UNITS];
+
+    Node() { std::fill(std::begin(child), std::end(child), -1); }
+};
+
+using RootVisits = std::array<uint32_t, BattleState::MAX_UNITS>;
+
+// Player-side reward in [0, 1]: any win beats any loss, then health left decides
+double playerReward(const BattleState& state, const double initialHealth[2]) {
+    if (state.hasUnits(0)) {
+        return 0.5 + 0.5 * state.remainingHealth(0) / initialHealth[0];
+    }
+    return 0.5 * (1.0 - state.remainingHealth(1) / initialHealth[1]);
+}
+
+// UCB1 from the acting side's point of view; untried targets go first
+int selectTarget(const Node& node, const BattleState& state, float exploration) {
+    int defender = 1 - state.side;
+    uint32_t total = 0;
+    for (int i = 0; i < state.unitCount[defender]; i++) {
+        if (state.units[defender][i].count > 0) {
+            if (node.visits[i] == 0) {
+                return i;
+            }
+            total += node.visits[i];
+        }
+    }
+
+    int best = -1;
+    double bestScore = -1.0;
+    double logTotal = std::log(static_cast<double>(total));
+    for (int i = 0; i < state.unitCount[defender]; i++) {
+        if (state.units[defender][i].count <= 0) {
+            continue;
+        }
+        double mean = node.value[i] / node.visits[i];
+        if (state.side == 1) {
+            mean = 1.0 - mean;
+        }
+        double score = mean + exploration * std::sqrt(logTotal / node.visits[i]);
+        if (score > bestScore) {
+            bestScore = score;
+            best = i;
+        }
+    }
+    return best;
+}
+
+// One tree: returns how often each root target was tried. Stops early at the deadline if it has one.
+RootVisits searchTree(const BattleState& root, RandomStream rng, int iterations, float exploration,
+                      bool hasDeadline, Clock::time_point deadline, uint64_t& playouts) {
+    const double initialHealth[2] = { std::max(1.0, root.remainingHealth(0)), std::max(1.0, root.remainingHealth(1)) };
+
+    // Each iteration adds at most one node, so the tree never reallocates
+    std::vector<Node> tree;
+    tree.reserve(static_cast<size_t>(iterations) + 1);
+    tree.emplace_back();
+    std::vector<std::pair<int32_t, int32_t>> path;
+
+    for (int iteration = 0; iteration < iterations; iteration++) {
+        if (hasDeadline && iteration > 0 && iteration % DEADLINE_CHECK_EVERY == 0 && Clock::now() >= deadline) {
+            break;
+        }
+
+        BattleState state = root;
+        path.clear();
+        int32_t node = 0;
+        while (!state.isFinished()) {
+            int target;
+            if (node < 0) {
+                target = state.weakestTarget();     // Past the tree: play out
+            } else {
+                target = selectTarget(tree[node], state, exploration);
+                path.push_back({ node, target });
+                if (tree[node].visits[target] == 0) {
+                    node = -1;      // First try of this target: play out from here
+                } else {
+                    if (tree[node].child[target] < 0) {
+                        tree[node].child[target] = static_cast<int32_t>(tree.size());
+                        tree.emplace_back();
+                    }
+                    node = tree[node].child[target];
+                }
+            }
+            state.attack(target, rng);
+        }
+
+        float reward = static_cast<float>(playerReward(state, initialHealth));
+        for (const auto& [visited, target] : path) {
+            tree[visited].visits[target]++;
+            tree[visited].value[target] += reward;
+        }
+        playouts++;
+    }
+
+    RootVisits visits;
+    std::copy(std::begin(tree[0].visits), std::end(tree[0].visits), visits.begin());
+    return visits;
+}
+
+} // namespace
+
+bool BattleState::capture(const std::vector<BattleUnit>& playerUnits, const std::vector<BattleUnit>& enemyUnits,
+                          const Hero* hero, bool playerActs, int actor, int round, BattleState& state) {
+    if (playerUnits.size() > MAX_UNITS || enemyUnits.size() > MAX_UNITS) {
+        return false;
+    }
+
+    const std::vector<BattleUnit>* sides[2] = { &playerUnits, &enemyUnits };
+    for (int side = 0; side < 2; side++) {
+        state.unitCount[side] = static_cast<int32_t>(sides[side]->size());
+        for (int i = 0; i < state.unitCount[side]; i++) {
+            const BattleUnit& unit = (*sides[side])[i];
+            const Creature* creature = GameState::getCreatureData(unit.creatureId);
+            if (!creature) {
+                return false;
+            }
+            Unit& captured = state.units[side][i];
+            captured.count = unit.count;
+            captured.health = unit.currentHealth;
+            captured.hitPoints = creature->getHitPoints();
+            captured.attack = creature->getAttack();
+            captured.defense = creature->getDefense();
+            captured.minDamage = creature->getMinDamage();
+            captured.maxDamage = creature->getMaxDamage();
+        }
+    }
+    state.side = playerActs ? 0 : 1;
+    state.actor = actor;
+    state.round = std::max(1, round);
+    state.heroAttackBonus = hero ? 1.0f + hero->getAttack() * 0.05f : 1.0f;
+    return true;
+}
+
+bool BattleState::hasUnits(int whichSide) const {
+    for (int i = 0; i < unitCount[whichSide]; i++) {
+        if (units[whichSide][i].count > 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool BattleState::isFinished() const {
+    return round > MAX_ROUNDS || !hasUnits(0) || !hasUnits(1);
+}
+
+double BattleState::remainingHealth(int whichSide) const {
+    double health = 0;
+    for (int i = 0; i < unitCount[whichSide]; i++) {
+        const Unit& unit = units[whichSide][i];
+        if (unit.count > 0) {
+            health += static_cast<double>(unit.count - 1) * unit.hitPoints + unit.health;
+        }
+    }
+    return health;
+}
+
+int BattleState::weakestTarget() const {
+    int defender = 1 - side;
+    int best = -1;
+    int64_t lowestHealth = INT64_MAX;
+    for (int i = 0; i < unitCount[defender]; i++) {
+        const Unit& unit = units[defender][i];
+        if (unit.count > 0) {
+            int64_t totalHealth = static_cast<int64_t>(unit.hitPoints) * unit.count;
+            if (totalHealth < lowestHealth) {
+                lowestHealth = totalHealth;
+                best = i;
+            }
+        }
+    }
+    return best;
+}
+
+// Same rolls, in the same order, as BattleEngine::calculateDamage
+int BattleState::rollDamage(const Unit& attacker, const Unit& defender, RandomStream& rng) const {
+    int baseDamage = attacker.minDamage == attacker.maxDamage ? attacker.minDamage
+                                                              : rng.nextInt(attacker.minDamage, attacker.maxDamage);
+    float attackDefenseRatio = static_cast<float>(attacker.attack) / static_cast<float>(defender.defense + 1);
+    if (attackDefenseRatio > 1.0f) {
+        baseDamage = static_cast<int>(baseDamage * (1.0f + (attackDefenseRatio - 1.0f) * 0.1f));
+    } else if (attackDefenseRatio < 1.0f) {
+        baseDamage = static_cast<int>(baseDamage * attackDefenseRatio);
+    }
+    baseDamage = std::max(1, baseDamage);
+
+    if (side == 0) {
+        baseDamage = static_cast<int>(baseDamage * heroAttackBonus);
+    }
+    int totalDamage = baseDamage * attacker.count;
+    totalDamage = static_cast<int>(totalDamage * rng.nextFloat(0.8f, 1.2f));
+    return std::max(1, totalDamage);
+}
+
+void BattleState::attack(int target, RandomStream& rng) {
+    Unit& defender = units[1 - side][target];
+    int damage = rollDamage(units[side][actor], defender, rng);
+
+    // Same as BattleEngine::applyDamage
+    defender.count -= damage / defender.hitPoints;
+    int remainingDamage = damage % defender.hitPoints;
+    if (remainingDamage > 0 && defender.count > 0) {
+        defender.health -= remainingDamage;
+        if (defender.health <= 0) {
+            defender.count--;
+            defender.health = defender.hitPoints;
+        }
+    }
+    defender.count = std::max(0, defender.count);
+
+    advance();
+}
+
+void BattleState::advance() {
+    actor++;
+    while (true) {
+        if (actor >= unitCount[side]) {
+            // The player side acts first in every round
+            if (side == 1) {
+                round++;
+            }
+            side = 1 - side;
+            actor = 0;
+            if (isFinished()) {
+                return;
+            }
+        }
+        if (units[side][actor].count > 0) {
+            return;
+        }
+        actor++;
+    }
+}
+
+BattleAI::BattleAI(ThreadPool& threadPool, const BattleAIConfig& searchConfig)
+    : pool(threadPool), config(searchConfig), decisions(0), playouts(0) {
+}
+
+int BattleAI::chooseTarget(const BattleState& state, const RandomStream& stream) {
+    int defender = 1 - state.side;
+    int onlyTarget = -1;
+    int targets = 0;
+    for (int i = 0; i < state.unitCount[defender]; i++) {
+        if (state.units[defender][i].count > 0) {
+            onlyTarget = i;
+            targets++;
+        }
+    }
+    if (targets <= 1 || state.isFinished()) {
+        return onlyTarget;   // Nothing to choose
+    }
+
+    const BattleAIConfig searchConfig = config;
+    int trees = std::max(1, searchConfig.trees);
+    int iterations = std::max(1, searchConfig.rollouts / trees);
+    bool hasDeadline = searchConfig.timeBudgetMs > 0;
+    Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(searchConfig.timeBudgetMs);
+
+    std::vector<RootVisits> rootVisits(trees);
+    std::vector<uint64_t> treePlayouts(trees, 0);
+    pool.parallelFor(static_cast<size_t>(trees), [&](size_t tree) {
+        rootVisits[tree] = searchTree(state, stream.split(tree), iterations, searchConfig.exploration,
+                                      hasDeadline, deadline, treePlayouts[tree]);
+    });
+
+    // Most visited target over all trees; ties go to the lower index
+    RootVisits total = {};
+    uint64_t decisionPlayouts = 0;
+    for (int tree = 0; tree < trees; tree++) {
+        for (int i = 0; i < BattleState::MAX_UNITS; i++) {
+            total[i] += rootVisits[tree][i];
+        }
+        decisionPlayouts += treePlayouts[tree];
+    }
+    int best = -1;
+    for (int i = 0; i < state.unitCount[defender]; i++) {
+        if (state.units[defender][i].count > 0 && (best < 0 || total[i] > total[best])) {
+            best = i;
+        }
+    }
+
+    decisions.fetch_add(1, std::memory_order_relaxed);
+    playouts.fetch_add(decisionPlayouts, std::memory_order_relaxed);
+    return best;
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "Battle.h"
+#include "../core/ThreadPool.h"
+#include <atomic>
+#include <cstdint>
+
+// Search limits for BattleAI
+struct BattleAIConfig {
+    int rollouts = 2048;        // Playouts per decision, over all trees
+    int timeBudgetMs = 0;       // Per decision; 0 always runs every rollout, so choices depend only on the seed
+    int trees = 8;              // Independent trees, searched in parallel and merged at the root
+    float exploration = 0.7f;   // UCB1 constant; rewards are in [0, 1]
+};
+
+// Snapshot of a battle for search: fixed arrays with the creature stats inline, so copying one
+// per playout is a memcpy. Units keep the engine's order, dead ones stay with count 0, so target
+// indices mean the same here as in the engine's unit vectors. Attacks follow BattleEngine's rules
+// and draw the same rolls from the stream.
+struct BattleState {
+    static const int MAX_UNITS = 8;
+    static const int MAX_ROUNDS = 20;
+
+    struct Unit {
+        int32_t count;
+        int32_t health;         // Of the top creature
+        int32_t hitPoints;
+        int32_t attack;
+        int32_t defense;
+        int32_t minDamage;
+        int32_t maxDamage;
+    };
+
+    Unit units[2][MAX_UNITS];   // Player side, enemy side
+    int32_t unitCount[2];
+    int32_t side;               // Side of the unit to act next
+    int32_t actor;              // Its index on that side
+    int32_t round;
+    float heroAttackBonus;      // Damage multiplier for the player side
+
+    // False if the sides do not fit the fixed arrays
+    static bool capture(const std::vector<BattleUnit>& playerUnits, const std::vector<BattleUnit>& enemyUnits,
+                        const Hero* hero, bool playerActs, int actor, int round, BattleState& state);
+
+    bool isFinished() const;
+    bool hasUnits(int whichSide) const;
+    double remainingHealth(int whichSide) const;
+
+    // Default policy, same as the engine's: the weakest living stack on the other side
+    int weakestTarget() const;
+
+    // The acting unit attacks the given unit on the other side, then play passes to the next unit
+    void attack(int target, RandomStream& rng);
+
+private:
+    int rollDamage(const Unit& attacker, const Unit& defender, RandomStream& rng) const;
+    void advance();
+};
+
+// Monte Carlo tree search for battle targeting.
+//
+// Each decision (which enemy stack the acting unit attacks) is searched with UCB1 over a tree of
+// the following decisions of both sides, each side maximizing its own outcome. The tree is open
+// loop: nodes stand for action sequences, not states, and every iteration replays the sequence
+// from the root with fresh damage rolls, so chance is sampled rather than branched on. Past the
+// tree a playout finishes the battle with the default policy. The reward favours winning, then
+// winning with more of the army left (or, losing, taking more of the enemy along).
+//
+// The rollouts are split over a fixed number of trees searched in parallel on the pool, each with
+// its own stream split from the decision's, and the root visit counts are summed. Without a time
+// budget the choice depends only on the stream, not on the thread count. One BattleAI may serve
+// several battles at once.
+class BattleAI {
+private:
+    ThreadPool& pool;
+    BattleAIConfig config;
+    std::atomic<uint64_t> decisions;
+    std::atomic<uint64_t> playouts;
+
+public:
+    explicit BattleAI(ThreadPool& threadPool, const BattleAIConfig& searchConfig = BattleAIConfig());
+
+    const BattleAIConfig& getConfig() const { return config; }
+    void setConfig(const BattleAIConfig& searchConfig) { config = searchConfig; }
+
+    // Index of the unit on the other side the acting unit should attack, -1 if none is alive
+    int chooseTarget(const BattleState& state, const RandomStream& stream);
+
+    uint64_t getDecisionCount() const { return decisions.load(std::memory_order_relaxed); }
+    uint64_t getPlayoutCount() const { return playouts.load(std::memory_order_relaxed); }
+};
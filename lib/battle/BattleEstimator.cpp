@@ -0,0 +1,289 @@
+#include "BattleEstimator.h"
+#include "../gamestate/GameState.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const int MAX_ROUNDS = 20;               // As BattleEngine::executeAutoBattle
+const double VARIANCE_CV2 = 0.4 * 0.4 / 12.0;   // Squared CV of the engine's +-20% damage roll
+const double NOISE_SCALE = 0.5;          // Square law: half the spread of the damage totals; fits bench/battle_estimator
+const double MIN_NOISE = 0.02;           // Keeps near-even battles from snapping to 0 or 1
+const double MAX_SURVIVING_FRACTION = 0.9999;
+
+// A fielded unit of the setup: creature, count and where it came from
+struct Stack {
+    const Creature* creature;
+    int count;
+    size_t setupIndex;
+};
+
+// The current creature definitions; an empty set before any are loaded
+std::shared_ptr<const CreatureDatabase> pinnedCreatures() {
+    static const std::shared_ptr<const CreatureDatabase> none = std::make_shared<const CreatureDatabase>();
+    std::shared_ptr<const CreatureDatabase> creatures = GameState::getCreatureDatabase();
+    return creatures ? creatures : none;
+}
+
+// Slots the engine would field, in the order it would field them: that order decides who strikes
+// first and which stack each attack falls on, so it is part of the battle
+std::vector<Stack> fieldedStacks(const std::vector<ArmySlot>& army, const CreatureDatabase& creatures) {
+    std::vector<Stack> stacks;
+    for (size_t i = 0; i < army.size(); i++) {
+        const Creature* creature = creatures.get(army[i].creatureId);
+        if (army[i].count > 0 && creature) {
+            stacks.push_back({ creature, army[i].count, i });
+        }
+    }
+    return stacks;
+}
+
+uint64_t mix(uint64_t value) {
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+    return value ^ (value >> 31);
+}
+
+// Mean and squared coefficient of variation of one attack's base damage per creature, following
+// Creature::calculateDamageAgainst and BattleEngine::calculateDamage over the whole damage range
+struct AttackDamage {
+    double mean = 0;
+    double cv2 = 0;
+};
+
+AttackDamage attackDamage(const Creature& attacker, const Creature& defender, const Hero* hero) {
+    float attackDefenseRatio = static_cast<float>(attacker.getAttack()) / static_cast<float>(defender.getDefense() + 1);
+    float attackBonus = hero ? 1.0f + (hero->getAttack() * 0.05f) : 1.0f;
+
+    double sum = 0;
+    double sumSquares = 0;
+    int low = attacker.getMinDamage();
+    int high = std::max(low, attacker.getMaxDamage());
+    for (int roll = low; roll <= high; roll++) {
+        int damage = roll;
+        if (attackDefenseRatio > 1.0f) {
+            damage = static_cast<int>(damage * (1.0f + (attackDefenseRatio - 1.0f) * 0.1f));
+        } else if (attackDefenseRatio < 1.0f) {
+            damage = static_cast<int>(damage * attackDefenseRatio);
+        }
+        damage = std::max(1, damage);
+        if (hero) {
+            damage = static_cast<int>(damage * attackBonus);
+        }
+        sum += damage;
+        sumSquares += static_cast<double>(damage) * damage;
+    }
+
+    AttackDamage result;
+    double rolls = high - low + 1;
+    result.mean = sum / rolls;
+    double variance = std::max(0.0, sumSquares / rolls - result.mean * result.mean);
+    result.cv2 = (result.mean > 0 ? variance / (result.mean * result.mean) : 0) + VARIANCE_CV2;
+    return result;
+}
+
+// Expected-value battle over the fielded stacks; survivors come back in the same order
+BattleEstimate estimateStacks(const std::vector<Stack> sides[2], const Hero* hero) {
+    BattleEstimate estimate;
+    std::vector<double> health[2];
+    double initialHealth[2] = { 0, 0 };
+    for (int side = 0; side < 2; side++) {
+        for (const Stack& stack : sides[side]) {
+            health[side].push_back(static_cast<double>(stack.count) * stack.creature->getHitPoints());
+            initialHealth[side] += health[side].back();
+        }
+    }
+    auto countOf = [&](int side, size_t index) {
+        return std::ceil(health[side][index] / sides[side][index].creature->getHitPoints() - 1e-9);
+    };
+    auto alive = [&](int side) {
+        return std::any_of(health[side].begin(), health[side].end(), [](double hp) { return hp > 1e-9; });
+    };
+
+    // Damage of every attacker/defender pair, computed once
+    std::vector<AttackDamage> pairs[2];
+    for (int side = 0; side < 2; side++) {
+        for (const Stack& attacker : sides[side]) {
+            for (const Stack& defender : sides[1 - side]) {
+                pairs[side].push_back(attackDamage(*attacker.creature, *defender.creature, side == 0 ? hero : nullptr));
+            }
+        }
+    }
+
+    double attacks[2] = { 0, 0 };
+    double cv2Sum[2] = { 0, 0 };
+    int round = 0;
+    if (alive(0) && alive(1)) {
+        for (round = 1; round <= MAX_ROUNDS; round++) {
+            for (int side = 0; side < 2; side++) {
+                int defenderSide = 1 - side;
+                for (size_t attacker = 0; attacker < sides[side].size(); attacker++) {
+                    double attackers = countOf(side, attacker);
+                    if (attackers <= 0) {
+                        continue;
+                    }
+
+                    // The engine's weakest-stack targeting
+                    int target = -1;
+                    double lowestHealth = 0;
+                    for (size_t defender = 0; defender < sides[defenderSide].size(); defender++) {
+                        double total = countOf(defenderSide, defender) * sides[defenderSide][defender].creature->getHitPoints();
+                        if (total > 0 && (target < 0 || total < lowestHealth)) {
+                            target = static_cast<int>(defender);
+                            lowestHealth = total;
+                        }
+                    }
+                    if (target < 0) {
+                        break;
+                    }
+
+                    const AttackDamage& damage = pairs[side][attacker * sides[defenderSide].size() + target];
+                    // The +-20% roll is truncated to an int: half a point lost on average
+                    double dealt = std::max(1.0, damage.mean * attackers - 0.5);
+                    health[defenderSide][target] = std::max(0.0, health[defenderSide][target] - dealt);
+                    attacks[side]++;
+                    cv2Sum[side] += damage.cv2;
+                }
+            }
+            if (!alive(0) || !alive(1)) {
+                break;
+            }
+        }
+    }
+    estimate.expectedRounds = std::min(round, MAX_ROUNDS);
+
+    double remaining[2];
+    for (int side = 0; side < 2; side++) {
+        remaining[side] = 0;
+        for (double hp : health[side]) {
+            remaining[side] += hp;
+        }
+    }
+    bool playerAlive = alive(0);
+    bool enemyAlive = alive(1);
+
+    // Lanchester's square law: the winner keeps sqrt(1 - 1/R^2) of its strength against a side R times weaker
+    double logRatio;
+    if (!playerAlive && !enemyAlive) {
+        logRatio = 0;
+    } else if (playerAlive) {
+        double kept = std::min(MAX_SURVIVING_FRACTION, remaining[0] / std::max(1.0, initialHealth[0]));
+        logRatio = -0.5 * std::log(1.0 - kept * kept);
+    } else {
+        double kept = std::min(MAX_SURVIVING_FRACTION, remaining[1] / std::max(1.0, initialHealth[1]));
+        logRatio = 0.5 * std::log(1.0 - kept * kept);
+    }
+
+    // Each side's total damage varies by its per-attack spread over the attacks it made
+    double noise = 0;
+    for (int side = 0; side < 2; side++) {
+        if (attacks[side] > 0) {
+            noise += cv2Sum[side] / (attacks[side] * attacks[side]);
+        }
+    }
+    noise = std::max(MIN_NOISE, NOISE_SCALE * std::sqrt(noise));
+    estimate.winProbability = 0.5 * std::erfc(-logRatio / (noise * std::sqrt(2.0)));
+
+    // The expected run's survivors, weighted by the chance their side is the one left standing.
+    // Both sides survive a battle that runs out of rounds, which the engine counts as a victory.
+    bool timedOut = playerAlive && enemyAlive;
+    for (int side = 0; side < 2; side++) {
+        std::vector<double>& survivors = side == 0 ? estimate.expectedPlayerSurvivors : estimate.expectedEnemySurvivors;
+        double weight = side == 0 ? estimate.winProbability : (timedOut ? 1.0 : 1.0 - estimate.winProbability);
+        for (size_t i = 0; i < sides[side].size(); i++) {
+            survivors.push_back(weight * countOf(side, i));
+        }
+    }
+    return estimate;
+}
+
+// Signature of a battle: definitions generation, hero attack, then each side's fielded stacks
+std::vector<uint64_t> battleSignature(const std::vector<Stack> sides[2], const Hero* hero,
+                                      const CreatureDatabase& creatures) {
+    std::vector<uint64_t> signature;
+    signature.reserve(4 + sides[0].size() + sides[1].size());
+    signature.push_back(creatures.getGeneration());
+    signature.push_back(hero ? static_cast<uint64_t>(static_cast<uint32_t>(hero->getAttack())) : ~0ull);
+    for (int side = 0; side < 2; side++) {
+        signature.push_back(sides[side].size());
+        for (const Stack& stack : sides[side]) {
+            signature.push_back((static_cast<uint64_t>(stack.creature->getId()) << 32) |
+                                static_cast<uint32_t>(stack.count));
+        }
+    }
+    return signature;
+}
+
+// Back from fielded stacks to the setup's slots; unfielded slots have no survivors
+BattleEstimate toSetupOrder(const BattleEstimate& fielded, const std::vector<Stack> sides[2],
+                            const BattleSetup& setup) {
+    BattleEstimate estimate;
+    estimate.winProbability = fielded.winProbability;
+    estimate.expectedRounds = fielded.expectedRounds;
+    estimate.expectedPlayerSurvivors.assign(setup.playerArmy.size(), 0.0);
+    estimate.expectedEnemySurvivors.assign(setup.enemyArmy.size(), 0.0);
+    for (size_t i = 0; i < sides[0].size(); i++) {
+        estimate.expectedPlayerSurvivors[sides[0][i].setupIndex] = fielded.expectedPlayerSurvivors[i];
+    }
+    for (size_t i = 0; i < sides[1].size(); i++) {
+        estimate.expectedEnemySurvivors[sides[1][i].setupIndex] = fielded.expectedEnemySurvivors[i];
+    }
+    return estimate;
+}
+
+} // namespace
+
+BattleEstimator::BattleEstimator(size_t cacheCapacity)
+    : shardCapacity(std::max<size_t>(1, cacheCapacity / SHARD_COUNT)), hits(0), misses(0) {
+}
+
+BattleEstimate BattleEstimator::compute(const BattleSetup& setup) {
+    std::shared_ptr<const CreatureDatabase> creatures = pinnedCreatures();
+    const std::vector<Stack> sides[2] = { fieldedStacks(setup.playerArmy, *creatures),
+                                          fieldedStacks(setup.enemyArmy, *creatures) };
+    return toSetupOrder(estimateStacks(sides, setup.hero), sides, setup);
+}
+
+BattleEstimate BattleEstimator::estimate(const BattleSetup& setup) {
+    // Stacks and signature come from the same definitions even if they are reloaded meanwhile
+    std::shared_ptr<const CreatureDatabase> creatures = pinnedCreatures();
+    const std::vector<Stack> sides[2] = { fieldedStacks(setup.playerArmy, *creatures),
+                                          fieldedStacks(setup.enemyArmy, *creatures) };
+    std::vector<uint64_t> signature = battleSignature(sides, setup.hero, *creatures);
+
+    uint64_t hash = 0;
+    for (uint64_t value : signature) {
+        hash = mix(hash ^ value);
+    }
+    Shard& shard = shards[(hash >> 32) % SHARD_COUNT];
+
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto found = shard.entries.find(hash);
+        if (found != shard.entries.end() && found->second.signature == signature) {
+            hits.fetch_add(1, std::memory_order_relaxed);
+            return toSetupOrder(found->second.estimate, sides, setup);
+        }
+    }
+
+    // Computed outside the lock; two threads missing on the same battle just both compute it
+    misses.fetch_add(1, std::memory_order_relaxed);
+    BattleEstimate fielded = estimateStacks(sides, setup.hero);
+    BattleEstimate estimate = toSetupOrder(fielded, sides, setup);
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (shard.entries.size() >= shardCapacity) {
+        shard.entries.clear();      // Cheaper than tracking recency; the hot entries come straight back
+    }
+    CachedEstimate& entry = shard.entries[hash];
+    entry.signature = std::move(signature);
+    entry.estimate = std::move(fielded);
+    return estimate;
+}
+
+void BattleEstimator::clearCache() {
+    for (Shard& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.entries.clear();
+    }
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "BattleSimulator.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// Predicted outcome of a battle, without fighting it
+struct BattleEstimate {
+    double winProbability = 0.0;
+    double expectedRounds = 0.0;
+
+    // Expected survivors per unit, in the order of BattleSetup::playerArmy / enemyArmy
+    std::vector<double> expectedPlayerSurvivors;
+    std::vector<double> expectedEnemySurvivors;
+};
+
+// Predicts auto-battle results from aggregate army stats, for AI planning and quick combat.
+//
+// The battle is played once with expected values instead of rolls: the engine's round order and
+// weakest-stack targeting, each attack dealing its mean damage (over the attacker's damage range
+// after attack/defense and the hero's attack bonus) into the target's pool of hit points. How far
+// the winner gets ahead gives a strength ratio by Lanchester's square law, and the win probability
+// is that ratio's log against the spread the damage rolls leave over the attacks made. Speed is
+// not used because the engine ignores it too: the player's side always strikes first.
+//
+// Estimates are cached under a hash of the battle's canonical signature: the hero's attack and
+// each side's fielded stacks (empty slots dropped; the order stays, since it decides who strikes
+// first and where the overkill goes). The signature is kept with the entry and compared, so hash
+// collisions cost a recomputation, not a wrong answer.
+// The cache is sharded and safe to use from several threads. Entries are tied to the generation
+// of the creature definitions they were computed from, so reloading definitions never reuses them.
+class BattleEstimator {
+public:
+    static const size_t DEFAULT_CACHE_CAPACITY = 1 << 16;
+
+private:
+    static const size_t SHARD_COUNT = 16;
+
+    struct CachedEstimate {
+        std::vector<uint64_t> signature;
+        BattleEstimate estimate;        // Per fielded stack
+    };
+
+    struct Shard {
+        std::mutex mutex;
+        std::unordered_map<uint64_t, CachedEstimate> entries;
+    };
+
+    std::array<Shard, SHARD_COUNT> shards;
+    size_t shardCapacity;
+    std::atomic<uint64_t> hits;
+    std::atomic<uint64_t> misses;
+
+public:
+    explicit BattleEstimator(size_t cacheCapacity = DEFAULT_CACHE_CAPACITY);
+
+    BattleEstimator(const BattleEstimator&) = delete;
+    BattleEstimator& operator=(const BattleEstimator&) = delete;
+
+    BattleEstimate estimate(const BattleSetup& setup);
+
+    // Without the cache
+    static BattleEstimate compute(const BattleSetup& setup);
+
+    void clearCache();
+    uint64_t getCacheHits() const { return hits.load(std::memory_order_relaxed); }
+    uint64_t getCacheMisses() const { return misses.load(std::memory_order_relaxed); }
+};
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "../../include/GameTypes.h"
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include <vector>
+
+enum class BattleEventType : uint8_t {
+    BattleStart,
+    RoundStart,
+    Attack,
+    UnitDeath,
+    RoundEnd,
+    BattleEnd
+};
+
+// One thing that happened in a battle. Plain data so logs can be copied, stored and replayed as bytes.
+struct BattleEvent {
+    BattleEventType type;
+    uint8_t playerSide;        // 1 if the acting unit (Attack) or dying unit (UnitDeath) is player controlled
+    uint8_t result;            // BattleResult for BattleEnd
+    uint8_t reserved;
+    int16_t round;
+    int16_t attackerSlot;      // BattleUnit::slot of the attacker, -1 if not applicable
+    int16_t defenderSlot;      // BattleUnit::slot of the defender or dying unit, -1 if not applicable
+    int16_t reserved2;
+    CreatureID attackerCreature;
+    CreatureID defenderCreature;
+    int32_t damage;
+    int32_t killed;
+};
+static_assert(std::is_trivially_copyable<BattleEvent>::value, "BattleEvent must stay plain data");
+static_assert(sizeof(BattleEvent) == 28, "BattleEvent layout changed");
+
+// Append-only event buffer filled by BattleEngine. Consumers either read it after the battle
+// or install a listener to receive events as they are recorded.
+class BattleEventLog {
+private:
+    std::vector<BattleEvent> events;
+    std::function<void(const BattleEvent&)> listener;
+
+public:
+    void reserve(size_t count) { events.reserve(count); }
+    void clear() { events.clear(); }
+
+    void append(const BattleEvent& event) {
+        events.push_back(event);
+        if (listener) {
+            listener(event);
+        }
+    }
+
+    const std::vector<BattleEvent>& getEvents() const { return events; }
+    size_t size() const { return events.size(); }
+    bool empty() const { return events.empty(); }
+
+    void setListener(std::function<void(const BattleEvent&)> callback) { listener = std::move(callback); }
+};
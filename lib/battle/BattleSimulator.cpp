@@ -0,0 +1,119 @@
+#include "BattleSimulator.h"
+#include "../gamestate/GameState.h"
+#include <algorithm>
+
+namespace {
+
+// Setup index of each unit the engine will actually field (empty or unknown slots are skipped)
+std::vector<size_t> fieldedSlots(const std::vector<ArmySlot>& army, const CreatureDatabase& creatures) {
+    std::vector<size_t> slots;
+    for (size_t i = 0; i < army.size(); i++) {
+        if (!army[i].isEmpty() && creatures.get(army[i].creatureId)) {
+            slots.push_back(i);
+        }
+    }
+    return slots;
+}
+
+struct ChunkTotals {
+    int64_t battles = 0;
+    int64_t victories = 0;
+    int64_t experience = 0;
+    std::vector<int64_t> playerCasualties;
+    std::vector<int64_t> enemyCasualties;
+};
+
+} // namespace
+
+BattleSimulator::BattleSimulator(unsigned threadCount) : pool(threadCount) {
+}
+
+BattleResult BattleSimulator::simulateOne(BattleEngine& engine, const BattleSetup& setup) {
+    engine.clearUnits();
+    for (const auto& slot : setup.playerArmy) {
+        engine.addPlayerUnit(slot.creatureId, slot.count);
+    }
+    for (const auto& slot : setup.enemyArmy) {
+        engine.addEnemyUnit(slot.creatureId, slot.count);
+    }
+    return engine.executeAutoBattle();
+}
+
+BattleStatistics BattleSimulator::run(const BattleSetup& setup, int64_t battleCount, uint64_t seed) {
+    if (!GameState::isCreatureDatabaseLoaded()) {
+        GameState::loadCreatureDatabase();
+    }
+
+    // Every engine of the batch reads this database, so reloading definitions meanwhile
+    // neither frees it under them nor mixes old and new stats
+    std::shared_ptr<const CreatureDatabase> creatures = GameState::getCreatureDatabase();
+
+    BattleStatistics stats;
+    stats.expectedPlayerCasualties.assign(setup.playerArmy.size(), 0.0);
+    stats.expectedEnemyCasualties.assign(setup.enemyArmy.size(), 0.0);
+    if (battleCount <= 0) {
+        return stats;
+    }
+
+    const std::vector<size_t> playerSlots = fieldedSlots(setup.playerArmy, *creatures);
+    const std::vector<size_t> enemySlots = fieldedSlots(setup.enemyArmy, *creatures);
+
+    size_t chunkCount = static_cast<size_t>((battleCount + BATTLES_PER_CHUNK - 1) / BATTLES_PER_CHUNK);
+    std::vector<ChunkTotals> chunks(chunkCount);
+
+    const RandomStream batchStream(seed);
+    pool.parallelFor(chunkCount, [&](size_t chunkIndex) {
+        ChunkTotals& totals = chunks[chunkIndex];
+        totals.playerCasualties.assign(playerSlots.size(), 0);
+        totals.enemyCasualties.assign(enemySlots.size(), 0);
+
+        BattleEngine engine(setup.hero, batchStream.split(chunkIndex), creatures);
+
+        int64_t first = static_cast<int64_t>(chunkIndex) * BATTLES_PER_CHUNK;
+        int64_t last = std::min(battleCount, first + BATTLES_PER_CHUNK);
+        for (int64_t battle = first; battle < last; battle++) {
+            BattleResult result = simulateOne(engine, setup);
+
+            totals.battles++;
+            if (result == BattleResult::Victory) {
+                totals.victories++;
+            }
+            totals.experience += engine.calculateExperienceGained();
+            for (size_t i = 0; i < playerSlots.size(); i++) {
+                totals.playerCasualties[i] += engine.getPlayerCasualties(static_cast<int>(i));
+            }
+            for (size_t i = 0; i < enemySlots.size(); i++) {
+                totals.enemyCasualties[i] += engine.getEnemyCasualties(static_cast<int>(i));
+            }
+        }
+    });
+
+    // Merge in chunk order so the totals are identical for any thread count
+    int64_t experience = 0;
+    std::vector<int64_t> playerCasualties(playerSlots.size(), 0);
+    std::vector<int64_t> enemyCasualties(enemySlots.size(), 0);
+    for (const auto& totals : chunks) {
+        stats.battles += totals.battles;
+        stats.victories += totals.victories;
+        experience += totals.experience;
+        for (size_t i = 0; i < playerSlots.size(); i++) {
+            playerCasualties[i] += totals.playerCasualties[i];
+        }
+        for (size_t i = 0; i < enemySlots.size(); i++) {
+            enemyCasualties[i] += totals.enemyCasualties[i];
+        }
+    }
+
+    double battles = static_cast<double>(stats.battles);
+    stats.defeats = stats.battles - stats.victories;
+    stats.winProbability = stats.victories / battles;
+    stats.expectedExperience = experience / battles;
+    for (size_t i = 0; i < playerSlots.size(); i++) {
+        stats.expectedPlayerCasualties[playerSlots[i]] = playerCasualties[i] / battles;
+    }
+    for (size_t i = 0; i < enemySlots.size(); i++) {
+        stats.expectedEnemyCasualties[enemySlots[i]] = enemyCasualties[i] / battles;
+    }
+
+    return stats;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "Battle.h"
+#include "../core/ThreadPool.h"
+#include <cstdint>
+#include <vector>
+
+// Armies and commander for a batch of simulated battles
+struct BattleSetup {
+    const Hero* hero = nullptr;          // Player-side commander (attack bonus), may be null
+    std::vector<ArmySlot> playerArmy;
+    std::vector<ArmySlot> enemyArmy;
+};
+
+// Aggregated outcome of many simulated battles
+struct BattleStatistics {
+    int64_t battles = 0;
+    int64_t victories = 0;
+    int64_t defeats = 0;
+
+    double winProbability = 0.0;
+    double expectedExperience = 0.0;
+
+    // Expected losses per unit, in the order of BattleSetup::playerArmy / enemyArmy
+    std::vector<double> expectedPlayerCasualties;
+    std::vector<double> expectedEnemyCasualties;
+};
+
+// Runs independent headless battles in parallel for balance sweeps.
+// Battles are split into fixed-size chunks, each drawing from the batch seed's stream split by
+// chunk index, so results depend on the seed but not on the thread count.
+class BattleSimulator {
+private:
+    ThreadPool pool;
+
+public:
+    static const int BATTLES_PER_CHUNK = 4096;
+
+    // threadCount 0 uses one thread per hardware core
+    explicit BattleSimulator(unsigned threadCount = 0);
+
+    BattleStatistics run(const BattleSetup& setup, int64_t battleCount, uint64_t seed);
+
+    // Single headless battle, for callers that want the full engine state afterwards
+    static BattleResult simulateOne(BattleEngine& engine, const BattleSetup& setup);
+
+    unsigned getThreadCount() const { return pool.getThreadCount(); }
+};
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+
+// Bounded lock-free queue for many producer threads and one consumer thread.
+//
+// A ring of cells, each with a sequence number telling producers and the consumer whose turn
+// the cell is (Vyukov's bounded queue). Producers claim a cell with one CAS on the shared tail;
+// the consumer needs no atomic read-modify-write at all. Nothing is allocated after construction,
+// so elements must be plain data. tryPush fails instead of blocking when the queue is full,
+// leaving the caller to decide how to push back on its source.
+template <typename T>
+class MpscQueue {
+    static_assert(std::is_trivially_copyable<T>::value, "MpscQueue elements must be plain data");
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    // Producers and the consumer work on different cache lines
+    static const size_t CACHE_LINE = 64;
+
+    std::unique_ptr<Cell[]> cells;
+    size_t mask;
+    alignas(CACHE_LINE) std::atomic<size_t> tail;   // Next position to claim, shared by producers
+    alignas(CACHE_LINE) size_t head;                // Next position to read, consumer only
+
+public:
+    // capacity is rounded up to a power of two
+    explicit MpscQueue(size_t capacity) : tail(0), head(0) {
+        size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        cells.reset(new Cell[size]);
+        mask = size - 1;
+        for (size_t i = 0; i < size; i++) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    size_t capacity() const { return mask + 1; }
+
+    // Any thread. Returns false if the queue is full.
+    bool tryPush(const T& value) {
+        size_t position = tail.load(std::memory_order_relaxed);
+        while (true) {
+            Cell& cell = cells[position & mask];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+            if (difference == 0) {
+                if (tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    cell.value = value;
+                    cell.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (difference < 0) {
+                return false;  // The consumer has not freed this cell yet: full
+            } else {
+                position = tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Consumer thread only. Returns false if the queue is empty (or the next push is still
+    // being written).
+    bool tryPop(T& value) {
+        Cell& cell = cells[head & mask];
+        if (cell.sequence.load(std::memory_order_acquire) != head + 1) {
+            return false;
+        }
+        value = cell.value;
+        cell.sequence.store(head + mask + 1, std::memory_order_release);
+        head++;
+        return true;
+    }
+
+    // Consumer thread only. Pop up to maxCount elements into consume(const T&); returns the count.
+    template <typename Consume>
+    size_t drain(Consume consume, size_t maxCount = SIZE_MAX) {
+        size_t count = 0;
+        while (count < maxCount) {
+            Cell& cell = cells[head & mask];
+            if (cell.sequence.load(std::memory_order_acquire) != head + 1) {
+                break;
+            }
+            T value = cell.value;
+            cell.sequence.store(head + mask + 1, std::memory_order_release);  // Free the cell first
+            head++;
+            count++;
+            consume(value);
+        }
+        return count;
+    }
+
+    // Consumer thread only. Approximate while producers are active.
+    size_t sizeApprox() const {
+        size_t claimed = tail.load(std::memory_order_relaxed);
+        return claimed > head ? claimed - head : 0;
+    }
+};
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+
+// Deterministic random numbers for game logic.
+//
+// A stream is a key plus a counter: the n-th value is SplitMix64's finalizer applied to
+// key + n * golden ratio, so values depend only on (key, n) and never on which thread draws
+// them or on anything process-wide. split() derives an independent stream from this one's key
+// and a caller-chosen id without consuming any values, which lets parallel work (battles,
+// simulation chunks, per-player processing) each take their own stream by index and still
+// reproduce exactly for the same root seed. Conversions to ranges are done here rather than
+// with std distributions, whose output differs between standard libraries.
+class RandomStream {
+private:
+    static const uint64_t GOLDEN_GAMMA = 0x9E3779B97F4A7C15ull;
+
+    uint64_t key;
+    uint64_t counter;
+
+    static uint64_t mix(uint64_t value) {
+        value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+        value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+        return value ^ (value >> 31);
+    }
+
+public:
+    explicit RandomStream(uint64_t seed = 0) : key(mix(seed + GOLDEN_GAMMA)), counter(0) {}
+
+    // Independent stream for sub-task streamId; the same id always gives the same stream
+    RandomStream split(uint64_t streamId) const {
+        RandomStream child;
+        child.key = mix(key ^ mix(streamId + GOLDEN_GAMMA));
+        return child;
+    }
+
+    uint64_t next() { return mix(key + ++counter * GOLDEN_GAMMA); }
+    uint32_t nextU32() { return static_cast<uint32_t>(next() >> 32); }
+
+    // Uniform in [low, high], both inclusive
+    int nextInt(int low, int high) {
+        if (high <= low) {
+            return low;
+        }
+        // Lemire's multiply-and-reject, unbiased for any range
+        uint32_t range = static_cast<uint32_t>(static_cast<int64_t>(high) - low + 1);
+        if (range == 0) {
+            return static_cast<int>(nextU32());   // The whole int range
+        }
+        uint64_t product = static_cast<uint64_t>(nextU32()) * range;
+        uint32_t fraction = static_cast<uint32_t>(product);
+        if (fraction < range) {
+            uint32_t threshold = (0u - range) % range;
+            while (fraction < threshold) {
+                product = static_cast<uint64_t>(nextU32()) * range;
+                fraction = static_cast<uint32_t>(product);
+            }
+        }
+        return static_cast<int>(low + static_cast<int64_t>(product >> 32));
+    }
+
+    // Uniform in [0, 1) with 24 bits of precision
+    float nextFloat() { return static_cast<float>(next() >> 40) * (1.0f / 16777216.0f); }
+    float nextFloat(float low, float high) { return low + (high - low) * nextFloat(); }
+
+    // Position within the stream, for saving and resuming it
+    uint64_t getKey() const { return key; }
+    uint64_t getCounter() const { return counter; }
+    void setCounter(uint64_t value) { counter = value; }
+};
@@ -0,0 +1,88 @@
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+ThreadPool::ThreadPool(unsigned threadCount) : stopping(false) {
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    workers.reserve(threadCount);
+    for (unsigned i = 0; i < threadCount; i++) {
+        workers.emplace_back([this]() { workerLoop(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopping = true;
+    }
+    taskAvailable.notify_all();
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        tasks.push(std::move(task));
+    }
+    taskAvailable.notify_one();
+}
+
+void ThreadPool::parallelFor(size_t taskCount, const std::function<void(size_t)>& task) {
+    if (taskCount == 0) {
+        return;
+    }
+
+    // Indices are claimed from a shared counter by the helpers and by the caller
+    struct Batch {
+        std::atomic<size_t> nextIndex{0};
+        std::atomic<size_t> finished{0};
+        std::mutex doneMutex;
+        std::condition_variable done;
+    };
+    auto batch = std::make_shared<Batch>();
+
+    auto drain = [batch, taskCount, &task]() {
+        size_t completed = 0;
+        for (size_t index = batch->nextIndex++; index < taskCount; index = batch->nextIndex++) {
+            task(index);
+            completed++;
+        }
+        if (completed > 0 && batch->finished.fetch_add(completed) + completed == taskCount) {
+            std::lock_guard<std::mutex> lock(batch->doneMutex);
+            batch->done.notify_all();
+        }
+    };
+
+    size_t helpers = std::min(taskCount - 1, workers.size());
+    for (size_t i = 0; i < helpers; i++) {
+        submit(drain);
+    }
+
+    drain();
+
+    std::unique_lock<std::mutex> lock(batch->doneMutex);
+    batch->done.wait(lock, [&batch, taskCount]() { return batch->finished.load() == taskCount; });
+}
+
+void ThreadPool::workerLoop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            taskAvailable.wait(lock, [this]() { return stopping || !tasks.empty(); });
+            if (stopping && tasks.empty()) {
+                return;
+            }
+            task = std::move(tasks.front());
+            tasks.pop();
+        }
+        task();
+    }
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+// Fixed-size pool of worker threads for CPU-bound batch work (simulations, AI, end-of-day processing)
+class ThreadPool {
+private:
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> tasks;
+    std::mutex queueMutex;
+    std::condition_variable taskAvailable;
+    bool stopping;
+
+public:
+    // threadCount 0 uses one thread per hardware core
+    explicit ThreadPool(unsigned threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    unsigned getThreadCount() const { return static_cast<unsigned>(workers.size()); }
+
+    // Queue a task without waiting for it
+    void submit(std::function<void()> task);
+
+    // Run task(index) for every index in [0, taskCount) and block until all have finished.
+    // The calling thread works on the batch too, so this is safe to call from a worker.
+    void parallelFor(size_t taskCount, const std::function<void(size_t)>& task);
+
+private:
+    void workerLoop();
+};
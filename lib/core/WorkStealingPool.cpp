@@ -0,0 +1,132 @@
+#include "WorkStealingPool.h"
+#include <algorithm>
+
+namespace {
+
+// Identifies the pool and deque of the current worker thread
+thread_local const WorkStealingPool* currentPool = nullptr;
+thread_local size_t currentWorker = 0;
+
+} // namespace
+
+WorkStealingPool::WorkStealingPool(unsigned threadCount) : queuedTasks(0), nextQueue(0), stopping(false) {
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for (unsigned i = 0; i < threadCount; i++) {
+        queues.push_back(std::make_unique<Worker>());
+    }
+    threads.reserve(threadCount);
+    for (unsigned i = 0; i < threadCount; i++) {
+        threads.emplace_back([this, i]() { workerLoop(i); });
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    taskAvailable.notify_all();
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+void WorkStealingPool::submit(std::function<void()> task) {
+    size_t index = currentPool == this ? currentWorker : nextQueue++ % queues.size();
+    push(index, std::move(task));
+    {
+        // Counted under the sleep mutex so a worker can't miss it between its check and its wait
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        queuedTasks++;
+    }
+    taskAvailable.notify_one();
+}
+
+void WorkStealingPool::parallelFor(size_t taskCount, const std::function<void(size_t)>& task) {
+    if (taskCount == 0) {
+        return;
+    }
+
+    struct Batch {
+        std::atomic<size_t> finished{0};
+        std::mutex doneMutex;
+        std::condition_variable done;
+    };
+    auto batch = std::make_shared<Batch>();
+
+    // Contiguous ranges per worker keep neighbouring tasks together; stealing evens out the rest
+    for (size_t index = 0; index < taskCount; index++) {
+        size_t queue = index * queues.size() / taskCount;
+        push(queue, [batch, taskCount, index, &task]() {
+            task(index);
+            if (batch->finished.fetch_add(1) + 1 == taskCount) {
+                std::lock_guard<std::mutex> lock(batch->doneMutex);
+                batch->done.notify_all();
+            }
+        });
+    }
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        queuedTasks += taskCount;
+    }
+    taskAvailable.notify_all();
+
+    std::unique_lock<std::mutex> lock(batch->doneMutex);
+    batch->done.wait(lock, [&batch, taskCount]() { return batch->finished.load() == taskCount; });
+}
+
+void WorkStealingPool::push(size_t index, std::function<void()> task) {
+    std::lock_guard<std::mutex> lock(queues[index]->mutex);
+    queues[index]->tasks.push_back(std::move(task));
+}
+
+bool WorkStealingPool::popTask(size_t index, std::function<void()>& task) {
+    // Own deque from the back (most recently pushed, likely still in cache)
+    {
+        Worker& own = *queues[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            queuedTasks--;
+            return true;
+        }
+    }
+
+    // Steal the oldest task of the next worker that has one
+    for (size_t offset = 1; offset < queues.size(); offset++) {
+        Worker& victim = *queues[(index + offset) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            queuedTasks--;
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::workerLoop(size_t index) {
+    currentPool = this;
+    currentWorker = index;
+
+    std::function<void()> task;
+    while (true) {
+        if (popTask(index, task)) {
+            task();
+            task = nullptr;
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        taskAvailable.wait(lock, [this]() { return stopping || queuedTasks.load() > 0; });
+        if (stopping && queuedTasks.load() == 0) {
+            return;
+        }
+    }
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Worker threads with one task deque each, for many small independent tasks of uneven size
+// (one per hosted game). A worker runs its own newest task first and, once its deque is empty,
+// steals the oldest task of another worker, so a few slow tasks don't hold up the rest.
+class WorkStealingPool {
+private:
+    struct Worker {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<Worker>> queues;
+    std::vector<std::thread> threads;
+    std::atomic<size_t> queuedTasks;
+    std::atomic<size_t> nextQueue;     // Round-robin target for tasks submitted from other threads
+    std::mutex sleepMutex;
+    std::condition_variable taskAvailable;
+    bool stopping;
+
+public:
+    // threadCount 0 uses one thread per hardware core
+    explicit WorkStealingPool(unsigned threadCount = 0);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    unsigned getThreadCount() const { return static_cast<unsigned>(threads.size()); }
+
+    // Queue a task. From a worker it goes to that worker's own deque, otherwise round-robin.
+    void submit(std::function<void()> task);
+
+    // Run task(index) for every index in [0, taskCount) and block until all have finished.
+    // Must not be called from one of this pool's workers.
+    void parallelFor(size_t taskCount, const std::function<void(size_t)>& task);
+
+private:
+    void workerLoop(size_t index);
+    bool popTask(size_t index, std::function<void()>& task);
+    void push(size_t index, std::function<void()> task);
+};
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Appends plain values to a byte buffer in native byte order
+class BinaryWriter {
+private:
+    std::vector<uint8_t> bytes;
+
+public:
+    template <typename T>
+    void write(const T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "only plain data can be written directly");
+        const uint8_t* raw = reinterpret_cast<const uint8_t*>(&value);
+        bytes.insert(bytes.end(), raw, raw + sizeof(T));
+    }
+
+    void writeString(const std::string& value) {
+        write(static_cast<uint32_t>(value.size()));
+        bytes.insert(bytes.end(), value.begin(), value.end());
+    }
+
+    template <typename T>
+    void writeArray(const std::vector<T>& values) {
+        write(static_cast<uint32_t>(values.size()));
+        for (const T& value : values) {
+            write(value);
+        }
+    }
+
+    const std::vector<uint8_t>& getBytes() const { return bytes; }
+    std::vector<uint8_t>& getBytes() { return bytes; }
+    size_t getSize() const { return bytes.size(); }
+};
+
+// Reads values written by BinaryWriter. Throws std::runtime_error when the input runs out.
+class BinaryReader {
+private:
+    const uint8_t* data;
+    size_t size;
+    size_t offset;
+
+public:
+    BinaryReader(const uint8_t* data, size_t size) : data(data), size(size), offset(0) {}
+
+    template <typename T>
+    T read() {
+        static_assert(std::is_trivially_copyable<T>::value, "only plain data can be read directly");
+        T value;
+        std::memcpy(&value, take(sizeof(T)), sizeof(T));
+        return value;
+    }
+
+    std::string readString() {
+        uint32_t length = read<uint32_t>();
+        const uint8_t* chars = take(length);
+        return std::string(reinterpret_cast<const char*>(chars), length);
+    }
+
+    template <typename T>
+    std::vector<T> readArray() {
+        uint32_t count = read<uint32_t>();
+        if (count > remaining() / sizeof(T)) {
+            throw std::runtime_error("Unexpected end of data");
+        }
+        std::vector<T> values;
+        values.reserve(count);
+        for (uint32_t i = 0; i < count; i++) {
+            values.push_back(read<T>());
+        }
+        return values;
+    }
+
+    size_t remaining() const { return size - offset; }
+    size_t getOffset() const { return offset; }
+
+private:
+    const uint8_t* take(size_t count) {
+        if (count > remaining()) {
+            throw std::runtime_error("Unexpected end of data");
+        }
+        const uint8_t* start = data + offset;
+        offset += count;
+        return start;
+    }
+};
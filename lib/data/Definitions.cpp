@@ -0,0 +1,499 @@
+#include "Definitions.h"
+#include "../entities/creature/Creature.h"
+#include "../entities/hero/Hero.h"
+#include "../map/GameMap.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+struct CacheHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t sourceHash;
+    uint32_t creatureCount;
+    uint32_t creatureOffset;
+    uint32_t heroClassCount;
+    uint32_t heroClassOffset;
+    uint32_t mapObjectCount;
+    uint32_t mapObjectOffset;
+};
+
+const char CACHE_MAGIC[4] = { 'R', 'D', 'E', 'F' };
+
+const char* const FACTION_NAMES[] = {
+    "Castle", "Rampart", "Tower", "Inferno", "Necropolis", "Dungeon", "Stronghold", "Fortress", "Neutral"
+};
+const char* const ABILITY_NAMES[] = {
+    "Flying", "Shooting", "DoubleAttack", "NoMeleeRetaliation", "MagicResistance", "Regeneration",
+    "Undead", "FireImmunity", "WaterImmunity", "EarthImmunity", "AirImmunity"
+};
+const char* const HERO_CLASS_NAMES[] = {
+    "Knight", "Cleric", "Ranger", "Druid", "Alchemist", "Wizard", "Demoniac", "Heretic",
+    "DeathKnight", "Necromancer", "Overlord", "Warlock", "Barbarian", "BattleMage", "Beastmaster", "Witch"
+};
+const char* const OBJECT_TYPE_NAMES[] = {
+    "None", "Hero", "Town", "Mine", "Dwelling", "Artifact", "Resource", "Monster", "Treasure",
+    "Shrine", "Library", "Tree", "Rock", "Decoration"
+};
+const char* const RESOURCE_NAMES[] = {
+    "Wood", "Mercury", "Ore", "Sulfur", "Crystal", "Gems", "Gold"
+};
+
+template <size_t N>
+int findName(const char* const (&names)[N], const std::string& name) {
+    for (size_t i = 0; i < N; i++) {
+        if (name == names[i]) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+size_t alignUp(size_t value) {
+    return (value + 7) & ~static_cast<size_t>(7);
+}
+
+// Line-oriented parser for the subset of TOML used by definition files:
+// [[table]] headers, key = value pairs, strings, integers, booleans,
+// arrays of strings and single-line inline tables of integers.
+class DefinitionParser {
+private:
+    const std::string& sourcePath;
+    int lineNumber;
+    std::vector<int> creatureLines;   // Line of each creature's [[creature]] header
+
+public:
+    std::vector<CreatureDefinition> creatures;
+    std::vector<HeroClassDefinition> heroClasses;
+    std::vector<MapObjectDefinition> mapObjects;
+
+    explicit DefinitionParser(const std::string& path) : sourcePath(path), lineNumber(0) {}
+
+    void parse(const std::string& text) {
+        enum class Section { None, Creature, HeroClass, MapObject } section = Section::None;
+
+        std::istringstream lines(text);
+        std::string line;
+        while (std::getline(lines, line)) {
+            lineNumber++;
+            line = trim(stripComment(line));
+            if (line.empty()) {
+                continue;
+            }
+
+            if (line.size() > 4 && line.compare(0, 2, "[[") == 0 && line.compare(line.size() - 2, 2, "]]") == 0) {
+                std::string table = trim(line.substr(2, line.size() - 4));
+                if (table == "creature") {
+                    section = Section::Creature;
+                    creatures.push_back(CreatureDefinition{});
+                    creatureLines.push_back(lineNumber);
+                } else if (table == "hero_class") {
+                    section = Section::HeroClass;
+                    heroClasses.push_back(HeroClassDefinition{});
+                } else if (table == "map_object") {
+                    section = Section::MapObject;
+                    mapObjects.push_back(MapObjectDefinition{});
+                } else {
+                    fail("unknown table [[" + table + "]]");
+                }
+                continue;
+            }
+
+            size_t equals = line.find('=');
+            if (equals == std::string::npos) {
+                fail("expected key = value");
+            }
+            std::string key = trim(line.substr(0, equals));
+            std::string value = trim(line.substr(equals + 1));
+
+            switch (section) {
+                case Section::Creature: setCreatureField(creatures.back(), key, value); break;
+                case Section::HeroClass: setHeroClassField(heroClasses.back(), key, value); break;
+                case Section::MapObject: setMapObjectField(mapObjects.back(), key, value); break;
+                case Section::None: fail("key outside of a [[table]]");
+            }
+        }
+
+        validateCreatures();
+    }
+
+private:
+    [[noreturn]] void fail(const std::string& message) const {
+        failAt(lineNumber, message);
+    }
+
+    [[noreturn]] void failAt(int line, const std::string& message) const {
+        throw std::runtime_error(sourcePath + ":" + std::to_string(line) + ": " + message);
+    }
+
+    // Battle code divides by hit points and the creature database indexes by id, so stats
+    // that would break either are rejected here rather than at first use
+    void validateCreatures() const {
+        std::vector<uint32_t> seen;
+        for (size_t i = 0; i < creatures.size(); i++) {
+            const CreatureDefinition& def = creatures[i];
+            int line = creatureLines[i];
+            if (def.id == 0 || def.id > DefinitionStore::MAX_CREATURE_ID) {
+                failAt(line, "creature id must be between 1 and " + std::to_string(DefinitionStore::MAX_CREATURE_ID));
+            }
+            if (std::find(seen.begin(), seen.end(), def.id) != seen.end()) {
+                failAt(line, "duplicate creature id " + std::to_string(def.id));
+            }
+            seen.push_back(def.id);
+            if (def.hitPoints <= 0) {
+                failAt(line, "creature " + std::to_string(def.id) + " needs hit_points above 0");
+            }
+            if (def.minDamage < 0 || def.minDamage > def.maxDamage) {
+                failAt(line, "creature " + std::to_string(def.id) + " needs 0 <= min_damage <= max_damage");
+            }
+            if (def.tier < 1 || def.tier > 7) {
+                failAt(line, "creature " + std::to_string(def.id) + " needs a tier from 1 to 7");
+            }
+        }
+    }
+
+    static std::string trim(const std::string& text) {
+        size_t first = text.find_first_not_of(" \t\r");
+        if (first == std::string::npos) {
+            return "";
+        }
+        size_t last = text.find_last_not_of(" \t\r");
+        return text.substr(first, last - first + 1);
+    }
+
+    static std::string stripComment(const std::string& text) {
+        bool inString = false;
+        for (size_t i = 0; i < text.size(); i++) {
+            if (text[i] == '"') {
+                inString = !inString;
+            } else if (text[i] == '#' && !inString) {
+                return text.substr(0, i);
+            }
+        }
+        return text;
+    }
+
+    std::string parseString(const std::string& value) const {
+        if (value.size() < 2 || value.front() != '"' || value.back() != '"') {
+            fail("expected a quoted string, got " + value);
+        }
+        return value.substr(1, value.size() - 2);
+    }
+
+    int parseInt(const std::string& value) const {
+        try {
+            size_t used = 0;
+            int result = std::stoi(value, &used);
+            if (used == value.size()) {
+                return result;
+            }
+        } catch (const std::exception&) {
+        }
+        fail("expected an integer, got " + value);
+    }
+
+    uint32_t parseNonNegative(const std::string& value) const {
+        int result = parseInt(value);
+        if (result < 0) {
+            fail("expected a value of 0 or more, got " + value);
+        }
+        return static_cast<uint32_t>(result);
+    }
+
+    bool parseBool(const std::string& value) const {
+        if (value == "true") return true;
+        if (value == "false") return false;
+        fail("expected true or false, got " + value);
+    }
+
+    std::vector<std::string> parseStringArray(const std::string& value) const {
+        if (value.size() < 2 || value.front() != '[' || value.back() != ']') {
+            fail("expected an array, got " + value);
+        }
+        std::vector<std::string> items;
+        std::stringstream stream(value.substr(1, value.size() - 2));
+        std::string item;
+        while (std::getline(stream, item, ',')) {
+            item = trim(item);
+            if (!item.empty()) {
+                items.push_back(parseString(item));
+            }
+        }
+        return items;
+    }
+
+    std::vector<std::pair<std::string, int>> parseIntTable(const std::string& value) const {
+        if (value.size() < 2 || value.front() != '{' || value.back() != '}') {
+            fail("expected an inline table, got " + value);
+        }
+        std::vector<std::pair<std::string, int>> entries;
+        std::stringstream stream(value.substr(1, value.size() - 2));
+        std::string entry;
+        while (std::getline(stream, entry, ',')) {
+            size_t equals = entry.find('=');
+            if (equals == std::string::npos) {
+                if (trim(entry).empty()) continue;
+                fail("expected key = value inside inline table");
+            }
+            entries.emplace_back(trim(entry.substr(0, equals)), parseInt(trim(entry.substr(equals + 1))));
+        }
+        return entries;
+    }
+
+    template <size_t N>
+    uint8_t parseEnum(const char* const (&names)[N], const std::string& value, const char* what) const {
+        std::string name = parseString(value);
+        int index = findName(names, name);
+        if (index < 0) {
+            fail(std::string("unknown ") + what + " \"" + name + "\"");
+        }
+        return static_cast<uint8_t>(index);
+    }
+
+    void copyName(char (&target)[32], const std::string& value) const {
+        std::string name = parseString(value);
+        if (name.size() >= sizeof(target)) {
+            fail("name longer than 31 characters: " + name);
+        }
+        std::memset(target, 0, sizeof(target));
+        std::memcpy(target, name.data(), name.size());
+    }
+
+    void setCreatureField(CreatureDefinition& def, const std::string& key, const std::string& value) {
+        if (key == "id") def.id = parseNonNegative(value);
+        else if (key == "name") copyName(def.name, value);
+        else if (key == "faction") def.faction = parseEnum(FACTION_NAMES, value, "faction");
+        else if (key == "tier") def.tier = static_cast<uint8_t>(std::min(parseNonNegative(value), 0xFFu));
+        else if (key == "attack") def.attack = parseInt(value);
+        else if (key == "defense") def.defense = parseInt(value);
+        else if (key == "min_damage") def.minDamage = parseInt(value);
+        else if (key == "max_damage") def.maxDamage = parseInt(value);
+        else if (key == "hit_points") def.hitPoints = parseInt(value);
+        else if (key == "speed") def.speed = parseInt(value);
+        else if (key == "ai_value") def.aiValue = parseInt(value);
+        else if (key == "upgrade") {
+            def.upgradeTarget = parseNonNegative(value);
+            def.hasUpgrade = 1;
+        } else if (key == "abilities") {
+            for (const auto& ability : parseStringArray(value)) {
+                int index = findName(ABILITY_NAMES, ability);
+                if (index < 0) {
+                    fail("unknown ability \"" + ability + "\"");
+                }
+                def.abilityMask |= 1u << index;
+            }
+        } else if (key == "cost") {
+            for (const auto& [resource, amount] : parseIntTable(value)) {
+                int index = -1;
+                for (size_t i = 0; i < 7; i++) {
+                    std::string lower = RESOURCE_NAMES[i];
+                    lower[0] = static_cast<char>(lower[0] - 'A' + 'a');
+                    if (resource == lower) {
+                        index = static_cast<int>(i);
+                    }
+                }
+                if (index < 0) {
+                    fail("unknown resource \"" + resource + "\"");
+                }
+                def.cost[index] = amount;
+            }
+        } else {
+            fail("unknown creature field \"" + key + "\"");
+        }
+    }
+
+    void setHeroClassField(HeroClassDefinition& def, const std::string& key, const std::string& value) {
+        if (key == "class") def.heroClass = parseEnum(HERO_CLASS_NAMES, value, "hero class");
+        else if (key == "name") copyName(def.name, value);
+        else if (key == "faction") def.faction = parseEnum(FACTION_NAMES, value, "faction");
+        else if (key == "attack") def.attack = parseInt(value);
+        else if (key == "defense") def.defense = parseInt(value);
+        else if (key == "spell_power") def.spellPower = parseInt(value);
+        else if (key == "knowledge") def.knowledge = parseInt(value);
+        else fail("unknown hero_class field \"" + key + "\"");
+    }
+
+    void setMapObjectField(MapObjectDefinition& def, const std::string& key, const std::string& value) {
+        if (key == "name") copyName(def.name, value);
+        else if (key == "type") def.objectType = parseEnum(OBJECT_TYPE_NAMES, value, "object type");
+        else if (key == "resource") def.resourceType = parseEnum(RESOURCE_NAMES, value, "resource");
+        else if (key == "blocks") def.blocksMovement = parseBool(value) ? 1 : 0;
+        else if (key == "production") def.dailyProduction = parseInt(value);
+        else fail("unknown map_object field \"" + key + "\"");
+    }
+};
+
+template <typename Record>
+void appendRecords(std::vector<uint8_t>& image, const std::vector<Record>& records, uint32_t& offset) {
+    image.resize(alignUp(image.size()));
+    offset = static_cast<uint32_t>(image.size());
+    const uint8_t* first = reinterpret_cast<const uint8_t*>(records.data());
+    image.insert(image.end(), first, first + records.size() * sizeof(Record));
+}
+
+std::vector<uint8_t> buildCacheImage(const DefinitionParser& parsed, uint64_t sourceHash) {
+    CacheHeader header{};
+    std::memcpy(header.magic, CACHE_MAGIC, sizeof(header.magic));
+    header.version = DefinitionStore::CACHE_VERSION;
+    header.sourceHash = sourceHash;
+    header.creatureCount = static_cast<uint32_t>(parsed.creatures.size());
+    header.heroClassCount = static_cast<uint32_t>(parsed.heroClasses.size());
+    header.mapObjectCount = static_cast<uint32_t>(parsed.mapObjects.size());
+
+    std::vector<uint8_t> image(sizeof(CacheHeader));
+    appendRecords(image, parsed.creatures, header.creatureOffset);
+    appendRecords(image, parsed.heroClasses, header.heroClassOffset);
+    appendRecords(image, parsed.mapObjects, header.mapObjectOffset);
+    std::memcpy(image.data(), &header, sizeof(header));
+    return image;
+}
+
+bool writeFileAtomically(const std::string& path, const std::vector<uint8_t>& bytes) {
+    std::string tempPath = path + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            return false;
+        }
+        file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        if (!file) {
+            return false;
+        }
+    }
+    if (std::rename(tempPath.c_str(), path.c_str()) != 0) {
+        std::remove(tempPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+Creature CreatureDefinition::toCreature() const {
+    Creature creature(id, std::string(name, std::find(name, name + sizeof(name), '\0')),
+                      static_cast<Faction>(faction), static_cast<CreatureTier>(tier));
+    creature.setStats(attack, defense, minDamage, maxDamage, hitPoints, speed);
+    creature.setAiValue(aiValue);
+
+    Resources creatureCost;
+    for (int i = 0; i < 7; i++) {
+        creatureCost[static_cast<ResourceType>(i)] = cost[i];
+    }
+    creature.setCost(creatureCost);
+
+    for (int bit = 0; bit < 32; bit++) {
+        if (abilityMask & (1u << bit)) {
+            creature.addAbility(static_cast<CreatureAbility>(bit));
+        }
+    }
+    if (hasUpgrade) {
+        creature.setUpgrade(upgradeTarget);
+    }
+    return creature;
+}
+
+DefinitionStore::DefinitionStore()
+    : creatures(nullptr), heroClasses(nullptr), mapObjects(nullptr),
+      creatureCount(0), heroClassCount(0), mapObjectCount(0), loadedFromCache(false) {
+}
+
+std::shared_ptr<const DefinitionStore> DefinitionStore::load(const std::string& sourcePath,
+                                                             const std::string& cachePath) {
+    std::ifstream sourceFile(sourcePath, std::ios::binary);
+    if (!sourceFile) {
+        throw std::runtime_error("Failed to open definitions: " + sourcePath);
+    }
+    std::string source((std::istreambuf_iterator<char>(sourceFile)), std::istreambuf_iterator<char>());
+    uint64_t sourceHash = hashBytes(reinterpret_cast<const uint8_t*>(source.data()), source.size());
+
+    std::string resolvedCachePath = cachePath.empty() ? sourcePath + ".bin" : cachePath;
+    auto store = std::make_shared<DefinitionStore>();
+
+    // Fast path: the cache was built from exactly this source
+    if (store->cacheFile.open(resolvedCachePath) &&
+        store->attach(store->cacheFile.getData(), store->cacheFile.getSize(), sourceHash)) {
+        store->loadedFromCache = true;
+        return store;
+    }
+    store->cacheFile.close();
+
+    DefinitionParser parser(sourcePath);
+    parser.parse(source);
+    std::vector<uint8_t> image = buildCacheImage(parser, sourceHash);
+
+    if (writeFileAtomically(resolvedCachePath, image) &&
+        store->cacheFile.open(resolvedCachePath) &&
+        store->attach(store->cacheFile.getData(), store->cacheFile.getSize(), sourceHash)) {
+        return store;
+    }
+
+    // Cache location not writable: serve the freshly built image from memory
+    store->cacheFile.close();
+    store->cacheBuffer = std::move(image);
+    store->attach(store->cacheBuffer.data(), store->cacheBuffer.size(), sourceHash);
+    return store;
+}
+
+bool DefinitionStore::attach(const uint8_t* data, size_t size, uint64_t expectedHash) {
+    if (!data || size < sizeof(CacheHeader)) {
+        return false;
+    }
+
+    CacheHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, CACHE_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != CACHE_VERSION ||
+        header.sourceHash != expectedHash) {
+        return false;
+    }
+
+    auto fits = [size](uint32_t offset, uint32_t count, size_t recordSize) {
+        return offset % 8 == 0 && offset <= size && count <= (size - offset) / recordSize;
+    };
+    if (!fits(header.creatureOffset, header.creatureCount, sizeof(CreatureDefinition)) ||
+        !fits(header.heroClassOffset, header.heroClassCount, sizeof(HeroClassDefinition)) ||
+        !fits(header.mapObjectOffset, header.mapObjectCount, sizeof(MapObjectDefinition))) {
+        return false;
+    }
+
+    creatures = reinterpret_cast<const CreatureDefinition*>(data + header.creatureOffset);
+    heroClasses = reinterpret_cast<const HeroClassDefinition*>(data + header.heroClassOffset);
+    mapObjects = reinterpret_cast<const MapObjectDefinition*>(data + header.mapObjectOffset);
+    creatureCount = header.creatureCount;
+    heroClassCount = header.heroClassCount;
+    mapObjectCount = header.mapObjectCount;
+    return true;
+}
+
+const HeroClassDefinition* DefinitionStore::findHeroClass(int heroClass) const {
+    for (size_t i = 0; i < heroClassCount; i++) {
+        if (heroClasses[i].heroClass == heroClass) {
+            return &heroClasses[i];
+        }
+    }
+    return nullptr;
+}
+
+const MapObjectDefinition* DefinitionStore::findMapObject(const std::string& name) const {
+    for (size_t i = 0; i < mapObjectCount; i++) {
+        if (name == mapObjects[i].name) {
+            return &mapObjects[i];
+        }
+    }
+    return nullptr;
+}
+
+uint64_t DefinitionStore::hashBytes(const uint8_t* data, size_t size) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= data[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
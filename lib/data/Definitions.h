@@ -0,0 +1,109 @@
+#pragma once
+
+#include "../../include/GameTypes.h"
+#include "MappedFile.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+class Creature;
+
+// Fixed-layout definition records. The binary cache is just a header followed by arrays of
+// these, so a mapped cache file is used in place without parsing.
+struct CreatureDefinition {
+    uint32_t id;
+    char name[32];
+    uint8_t faction;          // Faction
+    uint8_t tier;             // CreatureTier
+    uint8_t hasUpgrade;
+    uint8_t reserved;
+    int32_t attack;
+    int32_t defense;
+    int32_t minDamage;
+    int32_t maxDamage;
+    int32_t hitPoints;
+    int32_t speed;
+    int32_t aiValue;
+    uint32_t abilityMask;     // Creature::abilityBit flags
+    uint32_t upgradeTarget;
+    int32_t cost[7];          // Indexed by ResourceType
+
+    Creature toCreature() const;
+};
+
+struct HeroClassDefinition {
+    uint8_t heroClass;        // HeroClass
+    uint8_t faction;          // Faction
+    uint8_t reserved[2];
+    char name[32];
+    int32_t attack;
+    int32_t defense;
+    int32_t spellPower;
+    int32_t knowledge;
+};
+
+struct MapObjectDefinition {
+    char name[32];
+    uint8_t objectType;       // ObjectType
+    uint8_t resourceType;     // ResourceType, for mines
+    uint8_t blocksMovement;
+    uint8_t reserved;
+    int32_t dailyProduction;
+};
+
+static_assert(std::is_trivially_copyable<CreatureDefinition>::value, "definition records must be plain data");
+static_assert(std::is_trivially_copyable<HeroClassDefinition>::value, "definition records must be plain data");
+static_assert(std::is_trivially_copyable<MapObjectDefinition>::value, "definition records must be plain data");
+
+// Creature, hero class and map object definitions loaded from a TOML-style text file.
+//
+// The text is only parsed when its hash differs from the one stored in the binary cache next
+// to it; otherwise the cache is memory-mapped and its record arrays are used directly.
+class DefinitionStore {
+private:
+    MappedFile cacheFile;
+    std::vector<uint8_t> cacheBuffer;  // Holds the cache image when it could not be written to disk
+
+    const CreatureDefinition* creatures;
+    const HeroClassDefinition* heroClasses;
+    const MapObjectDefinition* mapObjects;
+    size_t creatureCount;
+    size_t heroClassCount;
+    size_t mapObjectCount;
+    bool loadedFromCache;
+
+public:
+    static const uint32_t CACHE_VERSION = 2;    // 2: creature stats are validated before caching
+    static const uint32_t MAX_CREATURE_ID = 65535;
+
+    DefinitionStore();
+
+    DefinitionStore(const DefinitionStore&) = delete;
+    DefinitionStore& operator=(const DefinitionStore&) = delete;
+
+    // Load definitions from sourcePath, using or rebuilding the cache at cachePath
+    // (defaults to sourcePath + ".bin"). Throws std::runtime_error on missing or malformed input.
+    static std::shared_ptr<const DefinitionStore> load(const std::string& sourcePath,
+                                                       const std::string& cachePath = "");
+
+    const CreatureDefinition* getCreatures() const { return creatures; }
+    size_t getCreatureCount() const { return creatureCount; }
+    const HeroClassDefinition* getHeroClasses() const { return heroClasses; }
+    size_t getHeroClassCount() const { return heroClassCount; }
+    const MapObjectDefinition* getMapObjects() const { return mapObjects; }
+    size_t getMapObjectCount() const { return mapObjectCount; }
+
+    const HeroClassDefinition* findHeroClass(int heroClass) const;
+    const MapObjectDefinition* findMapObject(const std::string& name) const;
+
+    // True if the last load used an up-to-date cache instead of parsing the source
+    bool wasLoadedFromCache() const { return loadedFromCache; }
+
+    // 64-bit FNV-1a, used to detect source changes
+    static uint64_t hashBytes(const uint8_t* data, size_t size);
+
+private:
+    bool attach(const uint8_t* data, size_t size, uint64_t expectedHash);
+};
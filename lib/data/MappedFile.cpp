@@ -0,0 +1,73 @@
+#include "MappedFile.h"
+#include <fstream>
+#include <iterator>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define REALMS_HAVE_MMAP 1
+#endif
+
+MappedFile::MappedFile() : data(nullptr), size(0), mapped(false), writable(false) {
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const std::string& path, bool copyOnWrite) {
+    close();
+
+#ifdef REALMS_HAVE_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+        int protection = copyOnWrite ? (PROT_READ | PROT_WRITE) : PROT_READ;
+        void* address = mmap(nullptr, static_cast<size_t>(info.st_size), protection, MAP_PRIVATE, fd, 0);
+        if (address != MAP_FAILED) {
+            data = static_cast<const uint8_t*>(address);
+            size = static_cast<size_t>(info.st_size);
+            mapped = true;
+            writable = copyOnWrite;
+            ::close(fd);
+            return true;
+        }
+    }
+    ::close(fd);
+#endif
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    data = buffer.data();
+    size = buffer.size();
+    writable = copyOnWrite;
+    if (!data) {
+        // Empty file: keep a valid pointer so isOpen() reports success
+        buffer.resize(1);
+        data = buffer.data();
+    }
+    return true;
+}
+
+void MappedFile::close() {
+#ifdef REALMS_HAVE_MMAP
+    if (mapped && data) {
+        munmap(const_cast<uint8_t*>(data), size);
+    }
+#endif
+    data = nullptr;
+    size = 0;
+    mapped = false;
+    writable = false;
+    buffer.clear();
+    buffer.shrink_to_fit();
+}
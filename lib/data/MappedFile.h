@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Read-only view of a whole file. Uses mmap where available and falls back to reading into memory.
+class MappedFile {
+private:
+    const uint8_t* data;
+    size_t size;
+    bool mapped;
+    bool writable;
+    std::vector<uint8_t> buffer;  // Used when mmap is unavailable
+
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Returns false if the file cannot be opened; any previous mapping is released first.
+    // A copy-on-write view may be modified in memory; changes never reach the file.
+    bool open(const std::string& path, bool copyOnWrite = false);
+    void close();
+
+    bool isOpen() const { return data != nullptr; }
+    const uint8_t* getData() const { return data; }
+    uint8_t* getMutableData() { return writable ? const_cast<uint8_t*>(data) : nullptr; }
+    size_t getSize() const { return size; }
+};
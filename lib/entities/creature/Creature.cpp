@@ -1,11 +1,10 @@
 #include "Creature.h"
 #include <algorithm>
-#include <random>
 
 Creature::Creature(CreatureID id, const std::string& name, Faction faction, CreatureTier tier)
     : id(id), name(name), faction(faction), tier(tier), attack(0), defense(0),
       minDamage(0), maxDamage(0), hitPoints(0), speed(0), aiValue(0),
-      canUpgrade(false), upgradeTarget(0) {
+      abilityMask(0), canUpgrade(false), upgradeTarget(0) {
 }
 
 void Creature::setStats(int att, int def, int minDmg, int maxDmg, int hp, int spd) {
@@ -22,28 +21,29 @@ void Creature::setCost(const Resources& resources) {
 }
 
 void Creature::addAbility(CreatureAbility ability) {
-    if (std::find(abilities.begin(), abilities.end(), ability) == abilities.end()) {
-        abilities.push_back(ability);
-    }
+    abilityMask |= abilityBit(ability);
 }
 
-bool Creature::hasAbility(CreatureAbility ability) const {
-    return std::find(abilities.begin(), abilities.end(), ability) != abilities.end();
+std::vector<CreatureAbility> Creature::getAbilities() const {
+    std::vector<CreatureAbility> abilities;
+    for (int bit = 0; bit < 32; bit++) {
+        if (abilityMask & (1u << bit)) {
+            abilities.push_back(static_cast<CreatureAbility>(bit));
+        }
+    }
+    return abilities;
 }
 
-int Creature::calculateDamage() const {
+int Creature::calculateDamage(RandomStream& rng) const {
     if (minDamage == maxDamage) {
         return minDamage;
     }
     
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
-    std::uniform_int_distribution<> dis(minDamage, maxDamage);
-    return dis(gen);
+    return rng.nextInt(minDamage, maxDamage);
 }
 
-int Creature::calculateDamageAgainst(const Creature& target) const {
-    int baseDamage = calculateDamage();
+int Creature::calculateDamageAgainst(const Creature& target, RandomStream& rng) const {
+    int baseDamage = calculateDamage(rng);
     
     // Simple damage calculation with attack vs defense
     float attackDefenseRatio = static_cast<float>(attack) / static_cast<float>(target.defense + 1);
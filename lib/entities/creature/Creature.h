@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../../../include/GameTypes.h"
+#include "../../core/Random.h"
 #include <string>
 #include <vector>
 
@@ -14,6 +15,7 @@ enum class CreatureTier {
     Tier7
 };
 
+// Abilities are stored as bits in Creature::abilityMask, so keep this under 32 entries
 enum class CreatureAbility {
     Flying,
     Shooting,
@@ -48,7 +50,7 @@ private:
     int aiValue;
     
     // Special properties
-    std::vector<CreatureAbility> abilities;
+    uint32_t abilityMask;
     bool canUpgrade;
     CreatureID upgradeTarget;
     
@@ -78,15 +80,17 @@ public:
     
     // Abilities
     void addAbility(CreatureAbility ability);
-    bool hasAbility(CreatureAbility ability) const;
-    const std::vector<CreatureAbility>& getAbilities() const { return abilities; }
+    bool hasAbility(CreatureAbility ability) const { return (abilityMask & abilityBit(ability)) != 0; }
+    uint32_t getAbilityMask() const { return abilityMask; }
+    std::vector<CreatureAbility> getAbilities() const;
+    static uint32_t abilityBit(CreatureAbility ability) { return 1u << static_cast<int>(ability); }
     
     // Upgrade system
     void setUpgrade(CreatureID target) { upgradeTarget = target; canUpgrade = true; }
     bool canBeUpgraded() const { return canUpgrade; }
     CreatureID getUpgradeTarget() const { return upgradeTarget; }
     
-    // Combat calculations
-    int calculateDamage() const;
-    int calculateDamageAgainst(const Creature& target) const;
+    // Combat calculations; all randomness comes from the caller's stream
+    int calculateDamage(RandomStream& rng) const;
+    int calculateDamageAgainst(const Creature& target, RandomStream& rng) const;
 };
\ No newline at end of file
@@ -0,0 +1,24 @@
+#include "CreatureDatabase.h"
+#include <algorithm>
+#include <atomic>
+
+uint64_t CreatureDatabase::nextGeneration() {
+    static std::atomic<uint64_t> lastGeneration(0);
+    return lastGeneration.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+CreatureDatabase::CreatureDatabase(std::vector<Creature> definitions) : creatures(std::move(definitions)) {
+    std::stable_sort(creatures.begin(), creatures.end(),
+        [](const Creature& a, const Creature& b) { return a.getId() < b.getId(); });
+
+    // Later definitions of the same id replace earlier ones
+    auto last = std::unique(creatures.rbegin(), creatures.rend(),
+        [](const Creature& a, const Creature& b) { return a.getId() == b.getId(); });
+    creatures.erase(creatures.begin(), last.base());
+
+    CreatureID maxId = creatures.empty() ? 0 : creatures.back().getId();
+    indexById.assign(creatures.empty() ? 0 : static_cast<size_t>(maxId) + 1, -1);
+    for (size_t i = 0; i < creatures.size(); i++) {
+        indexById[creatures[i].getId()] = static_cast<int32_t>(i);
+    }
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "Creature.h"
+#include <cstdint>
+#include <vector>
+
+// Immutable creature definitions, stored contiguously and looked up by id with a single array index.
+// Built once at load time and then shared read-only, so simulation threads can use it without locking.
+class CreatureDatabase {
+private:
+    std::vector<Creature> creatures;    // Sorted by id
+    std::vector<int32_t> indexById;     // CreatureID -> index into creatures, -1 if unknown
+    uint64_t generation = nextGeneration();
+
+    static uint64_t nextGeneration();
+
+public:
+    CreatureDatabase() = default;
+    explicit CreatureDatabase(std::vector<Creature> definitions);
+
+    const Creature* get(CreatureID id) const {
+        if (id >= indexById.size() || indexById[id] < 0) {
+            return nullptr;
+        }
+        return &creatures[indexById[id]];
+    }
+
+    const std::vector<Creature>& getAll() const { return creatures; }
+    size_t size() const { return creatures.size(); }
+    bool empty() const { return creatures.empty(); }
+
+    // Distinct for every database built in this process, never 0; for keying data derived from it
+    uint64_t getGeneration() const { return generation; }
+};
@@ -1,4 +1,5 @@
 #include "Hero.h"
+#include "HeroStore.h"
 #include <algorithm>
 
 bool Army::addCreatures(CreatureID creatureId, int count) {
@@ -69,13 +70,30 @@ bool Army::isFull() const {
 Hero::Hero(HeroID id, const std::string& name, HeroClass hClass, Gender g)
     : id(id), name(name), heroClass(hClass), gender(g), position(0, 0, 0),
       movementPoints(0), maxMovementPoints(1000), attack(0), defense(0),
-      spellPower(0), knowledge(0), mana(0), maxMana(0), experience(0), level(1) {
+      spellPower(0), knowledge(0), mana(0), maxMana(0), experience(0), level(1), dirty(true) {
     calculateMaxMana();
     calculateMaxMovement();
     mana = maxMana;
 }
 
+void Hero::setPosition(const Position& pos) {
+    position = pos;
+    dirty = true;
+    if (storeLink.store) {
+        storeLink.store->heroMoved(storeLink.slot, pos);
+    }
+}
+
+void Hero::setMovementPoints(int points) {
+    movementPoints = points;
+    dirty = true;
+    if (storeLink.store) {
+        storeLink.store->movementPoints[storeLink.slot] = points;
+    }
+}
+
 void Hero::setPrimaryStats(int att, int def, int sp, int know) {
+    dirty = true;
     attack = att;
     defense = def;
     spellPower = sp;
@@ -85,6 +103,7 @@ void Hero::setPrimaryStats(int att, int def, int sp, int know) {
 }
 
 void Hero::increasePrimaryStat(SkillType stat, int amount) {
+    dirty = true;
     switch (stat) {
         case SkillType::Attack:
             attack += amount;
@@ -111,14 +130,17 @@ int Hero::getSkillLevel(SkillType skill) const {
 }
 
 void Hero::setSkill(SkillType skill, int skillLevel) {
+    dirty = true;
     skills[skill] = skillLevel;
 }
 
 void Hero::increaseSkill(SkillType skill) {
+    dirty = true;
     skills[skill] = std::min(3, getSkillLevel(skill) + 1);
 }
 
 void Hero::learnSpell(SpellID spellId) {
+    dirty = true;
     if (!knowsSpell(spellId)) {
         knownSpells.push_back(spellId);
     }
@@ -129,12 +151,14 @@ bool Hero::knowsSpell(SpellID spellId) const {
 }
 
 void Hero::equipArtifact(ArtifactID artifactId) {
+    dirty = true;
     if (!hasArtifact(artifactId)) {
         artifacts.push_back(artifactId);
     }
 }
 
 void Hero::removeArtifact(ArtifactID artifactId) {
+    dirty = true;
     artifacts.erase(std::remove(artifacts.begin(), artifacts.end(), artifactId), artifacts.end());
 }
 
@@ -143,6 +167,7 @@ bool Hero::hasArtifact(ArtifactID artifactId) const {
 }
 
 void Hero::gainExperience(int exp) {
+    dirty = true;
     experience += exp;
     while (canLevelUp()) {
         levelUp();
@@ -159,6 +184,7 @@ void Hero::levelUp() {
     }
     
     level++;
+    dirty = true;
     // Simple leveling - in a full implementation, this would offer choices
     attack += 1;
     defense += 1;
@@ -43,8 +43,10 @@ struct ArmySlot {
 
 // Hero's army (7 slots max)
 class Army {
-private:
+public:
     static const int MAX_SLOTS = 7;
+    
+private:
     std::array<ArmySlot, MAX_SLOTS> slots;
     
 public:
@@ -58,7 +60,22 @@ public:
     bool isFull() const;
 };
 
+class HeroStore;
+
+// The store a hero lives in and its slot there. Copies of a hero start out outside any store.
+struct HeroStoreLink {
+    HeroStore* store = nullptr;
+    uint32_t slot = 0;
+    
+    HeroStoreLink() = default;
+    HeroStoreLink(const HeroStoreLink&) {}
+    HeroStoreLink& operator=(const HeroStoreLink&) { return *this; }
+};
+
 class Hero {
+    friend class SaveGame;
+    friend class HeroStore;
+    
 private:
     HeroID id;
     std::string name;
@@ -92,6 +109,12 @@ private:
     int experience;
     int level;
     
+    // Set by every mutation; cleared when a full snapshot has been taken (see AutoSaver)
+    bool dirty;
+    
+    // Position and movement points are mirrored by the store for its sweeps
+    HeroStoreLink storeLink;
+    
 public:
     Hero(HeroID id, const std::string& name, HeroClass hClass, Gender g = Gender::Male);
     
@@ -103,11 +126,11 @@ public:
     
     // Position and movement
     const Position& getPosition() const { return position; }
-    void setPosition(const Position& pos) { position = pos; }
+    void setPosition(const Position& pos);
     int getMovementPoints() const { return movementPoints; }
     int getMaxMovementPoints() const { return maxMovementPoints; }
-    void setMovementPoints(int points) { movementPoints = points; }
-    void resetMovementPoints() { movementPoints = maxMovementPoints; }
+    void setMovementPoints(int points);
+    void resetMovementPoints() { setMovementPoints(maxMovementPoints); }
     bool canMove() const { return movementPoints > 0; }
     
     // Primary attributes
@@ -131,11 +154,11 @@ public:
     bool knowsSpell(SpellID spellId) const;
     int getMana() const { return mana; }
     int getMaxMana() const { return maxMana; }
-    void setMana(int m) { mana = m; }
-    void restoreMana() { mana = maxMana; }
+    void setMana(int m) { mana = m; dirty = true; }
+    void restoreMana() { mana = maxMana; dirty = true; }
     
     // Army management
-    Army& getArmy() { return army; }
+    Army& getArmy() { dirty = true; return army; }  // Mutable access counts as a change
     const Army& getArmy() const { return army; }
     
     // Artifacts
@@ -151,6 +174,11 @@ public:
     bool canLevelUp() const;
     void levelUp();
     
+    // Change tracking for incremental saves
+    bool isDirty() const { return dirty; }
+    void markDirty() { dirty = true; }
+    void clearDirty() { dirty = false; }
+    
 private:
     void calculateMaxMana();
     void calculateMaxMovement();
@@ -0,0 +1,208 @@
+#include "HeroStore.h"
+#include <algorithm>
+
+namespace {
+
+int floorDivide(int value, int divisor) {
+    return value >= 0 ? value / divisor : -((-value + divisor - 1) / divisor);
+}
+
+uint64_t regionKey(int regionX, int regionY, int z) {
+    return (static_cast<uint64_t>(static_cast<uint16_t>(z)) << 48) |
+           (static_cast<uint64_t>(static_cast<uint32_t>(regionX) & 0xFFFFFF) << 24) |
+           (static_cast<uint32_t>(regionY) & 0xFFFFFF);
+}
+
+uint64_t regionKeyOf(const Position& position) {
+    return regionKey(floorDivide(position.x, HeroStore::REGION_SIZE), floorDivide(position.y, HeroStore::REGION_SIZE),
+                     position.z);
+}
+
+} // namespace
+
+HeroHandle HeroStore::add(Hero hero) {
+    HeroID id = hero.getId();
+    remove(id);
+
+    uint32_t slot;
+    if (!freeSlots.empty()) {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    } else {
+        slot = static_cast<uint32_t>(slots.size());
+        slots.emplace_back();
+        generations.push_back(0);
+        ids.push_back(0);
+        positions.emplace_back();
+        movementPoints.push_back(0);
+        owners.push_back(0);
+        regionKeys.push_back(0);
+        regionIndices.push_back(0);
+    }
+
+    Hero& stored = slots[slot].emplace(std::move(hero));
+    stored.storeLink.store = this;
+    stored.storeLink.slot = slot;
+
+    ids[slot] = id;
+    positions[slot] = stored.position;
+    movementPoints[slot] = stored.movementPoints;
+    auto owner = ownerById.find(id);
+    owners[slot] = owner != ownerById.end() ? owner->second : 0;
+    insertIntoRegion(slot);
+
+    size_t position = sortedPosition(id);
+    sortedIds.insert(sortedIds.begin() + position, id);
+    sortedSlots.insert(sortedSlots.begin() + position, slot);
+    return { slot, generations[slot] };
+}
+
+bool HeroStore::remove(HeroID id) {
+    size_t position = sortedPosition(id);
+    if (position == sortedIds.size() || sortedIds[position] != id) {
+        return false;
+    }
+
+    uint32_t slot = sortedSlots[position];
+    sortedIds.erase(sortedIds.begin() + position);
+    sortedSlots.erase(sortedSlots.begin() + position);
+    removeFromRegion(slot);
+
+    slots[slot].reset();
+    generations[slot]++;
+    ids[slot] = 0;
+    owners[slot] = 0;
+    freeSlots.push_back(slot);
+    return true;
+}
+
+HeroHandle HeroStore::getHandle(HeroID id) const {
+    size_t position = sortedPosition(id);
+    if (position == sortedIds.size() || sortedIds[position] != id) {
+        return HeroHandle();
+    }
+    uint32_t slot = sortedSlots[position];
+    return { slot, generations[slot] };
+}
+
+Hero* HeroStore::get(HeroHandle handle) {
+    if (handle.index >= slots.size() || generations[handle.index] != handle.generation || !slots[handle.index]) {
+        return nullptr;
+    }
+    return &*slots[handle.index];
+}
+
+const Hero* HeroStore::get(HeroHandle handle) const {
+    return const_cast<HeroStore*>(this)->get(handle);
+}
+
+PlayerID HeroStore::getOwner(HeroID id) const {
+    auto owner = ownerById.find(id);
+    return owner != ownerById.end() ? owner->second : 0;
+}
+
+void HeroStore::setOwner(HeroID id, PlayerID owner) {
+    ownerById[id] = owner;
+    HeroHandle handle = getHandle(id);
+    if (!handle.isNull()) {
+        owners[handle.index] = owner;
+    }
+}
+
+void HeroStore::releaseOwner(HeroID id, PlayerID owner) {
+    auto current = ownerById.find(id);
+    if (current == ownerById.end() || current->second != owner) {
+        return;
+    }
+    ownerById.erase(current);
+    HeroHandle handle = getHandle(id);
+    if (!handle.isNull()) {
+        owners[handle.index] = 0;
+    }
+}
+
+void HeroStore::findInRegion(const Rect& area, int z, std::vector<HeroHandle>& found) const {
+    found.clear();
+    if (area.w <= 0 || area.h <= 0) {
+        return;
+    }
+
+    auto inside = [&](uint32_t slot) {
+        const Position& position = positions[slot];
+        return position.z == z && position.x >= area.x && position.x < area.x + area.w && position.y >= area.y &&
+               position.y < area.y + area.h;
+    };
+
+    int firstX = floorDivide(area.x, REGION_SIZE);
+    int lastX = floorDivide(area.x + area.w - 1, REGION_SIZE);
+    int firstY = floorDivide(area.y, REGION_SIZE);
+    int lastY = floorDivide(area.y + area.h - 1, REGION_SIZE);
+    uint64_t regionCount = static_cast<uint64_t>(lastX - firstX + 1) * static_cast<uint64_t>(lastY - firstY + 1);
+
+    std::vector<uint32_t> matches;
+    if (regionCount > regions.size()) {
+        // More regions in the area than occupied ones: a sweep of the positions is cheaper
+        for (uint32_t slot : sortedSlots) {
+            if (inside(slot)) {
+                matches.push_back(slot);
+            }
+        }
+    } else {
+        for (int regionY = firstY; regionY <= lastY; regionY++) {
+            for (int regionX = firstX; regionX <= lastX; regionX++) {
+                auto region = regions.find(regionKey(regionX, regionY, z));
+                if (region == regions.end()) {
+                    continue;
+                }
+                for (uint32_t slot : region->second) {
+                    if (inside(slot)) {
+                        matches.push_back(slot);
+                    }
+                }
+            }
+        }
+        std::sort(matches.begin(), matches.end(), [this](uint32_t a, uint32_t b) { return ids[a] < ids[b]; });
+    }
+
+    found.reserve(matches.size());
+    for (uint32_t slot : matches) {
+        found.push_back({ slot, generations[slot] });
+    }
+}
+
+size_t HeroStore::countOwnedBy(PlayerID owner) const {
+    size_t count = 0;
+    for (uint32_t slot : sortedSlots) {
+        count += owners[slot] == owner ? 1 : 0;
+    }
+    return count;
+}
+
+size_t HeroStore::sortedPosition(HeroID id) const {
+    return static_cast<size_t>(std::lower_bound(sortedIds.begin(), sortedIds.end(), id) - sortedIds.begin());
+}
+
+void HeroStore::heroMoved(uint32_t slot, const Position& position) {
+    positions[slot] = position;
+    if (regionKeyOf(position) != regionKeys[slot]) {
+        removeFromRegion(slot);
+        insertIntoRegion(slot);
+    }
+}
+
+void HeroStore::insertIntoRegion(uint32_t slot) {
+    uint64_t key = regionKeyOf(positions[slot]);
+    std::vector<uint32_t>& region = regions[key];
+    regionKeys[slot] = key;
+    regionIndices[slot] = static_cast<uint32_t>(region.size());
+    region.push_back(slot);
+}
+
+// Swap-and-pop; emptied regions keep their list, heroes tend to come back
+void HeroStore::removeFromRegion(uint32_t slot) {
+    std::vector<uint32_t>& region = regions[regionKeys[slot]];
+    uint32_t moved = region.back();
+    region[regionIndices[slot]] = moved;
+    regionIndices[moved] = regionIndices[slot];
+    region.pop_back();
+}
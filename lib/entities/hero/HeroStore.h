@@ -0,0 +1,159 @@
+#pragma once
+
+#include "Hero.h"
+#include "../../geometry/Rect.h"
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Reference to a stored hero: its slot and the generation of the hero in that slot. A handle to
+// a removed hero stops resolving, even once the slot holds another hero.
+struct HeroHandle {
+    static const uint32_t INVALID_INDEX = UINT32_MAX;
+
+    uint32_t index = INVALID_INDEX;
+    uint32_t generation = 0;
+
+    bool isNull() const { return index == INVALID_INDEX; }
+    bool operator==(const HeroHandle& other) const { return index == other.index && generation == other.generation; }
+    bool operator!=(const HeroHandle& other) const { return !(*this == other); }
+};
+
+// Heroes in a dense slot array, for maps with tens of thousands of them.
+//
+// Heroes live in the chunks of a deque, so they sit close together and keep their address as the
+// store grows; removed heroes leave their slot to the next one added. The fields sweeps look at
+// (position, movement points, owner) are mirrored in arrays parallel to the slots: Hero's setters
+// keep position and movement points current, and owners are set by the players' hero lists
+// through GameState. Heroes are also indexed by id, in order, so iteration and the game built
+// on it stay deterministic, and by REGION_SIZE-tile regions for area queries.
+class HeroStore {
+    friend class Hero;
+
+public:
+    static const int REGION_SIZE = 16;
+
+    // Heroes in id order as (id, hero) pairs, optionally only those owned by one player
+    template <typename HeroT>
+    class Range {
+        using Store = std::conditional_t<std::is_const<HeroT>::value, const HeroStore, HeroStore>;
+
+        Store* store;
+        bool filtered;
+        PlayerID owner;
+
+    public:
+        class iterator {
+            Store* store;
+            size_t position;
+            bool filtered;
+            PlayerID owner;
+
+            void skip() {
+                while (filtered && position < store->sortedSlots.size() &&
+                       store->owners[store->sortedSlots[position]] != owner) {
+                    position++;
+                }
+            }
+
+        public:
+            iterator(Store* store, size_t position, bool filtered, PlayerID owner)
+                : store(store), position(position), filtered(filtered), owner(owner) {
+                skip();
+            }
+
+            std::pair<HeroID, HeroT*> operator*() const {
+                return { store->sortedIds[position], &*store->slots[store->sortedSlots[position]] };
+            }
+            iterator& operator++() {
+                position++;
+                skip();
+                return *this;
+            }
+            bool operator!=(const iterator& other) const { return position != other.position; }
+            bool operator==(const iterator& other) const { return position == other.position; }
+        };
+
+        Range(Store* store, bool filtered, PlayerID owner) : store(store), filtered(filtered), owner(owner) {}
+
+        iterator begin() const { return iterator(store, 0, filtered, owner); }
+        iterator end() const { return iterator(store, store->sortedSlots.size(), false, 0); }
+        size_t size() const { return filtered ? store->countOwnedBy(owner) : store->sortedSlots.size(); }
+        bool empty() const { return begin() == end(); }
+    };
+
+private:
+    std::deque<std::optional<Hero>> slots;
+    std::vector<uint32_t> generations;
+    std::vector<uint32_t> freeSlots;
+
+    // Hot fields, parallel to the slots
+    std::vector<HeroID> ids;
+    std::vector<Position> positions;
+    std::vector<int> movementPoints;
+    std::vector<PlayerID> owners;
+
+    // Stored ids in ascending order, with the slot of each
+    std::vector<HeroID> sortedIds;
+    std::vector<uint32_t> sortedSlots;
+
+    // Owner of every hero id a player lists, stored or not (a player may list a hero before it is added)
+    std::unordered_map<HeroID, PlayerID> ownerById;
+
+    // Slots of the heroes standing in each region, and where each slot sits in its region's list
+    std::unordered_map<uint64_t, std::vector<uint32_t>> regions;
+    std::vector<uint64_t> regionKeys;
+    std::vector<uint32_t> regionIndices;
+
+public:
+    HeroStore() = default;
+
+    HeroStore(const HeroStore&) = delete;
+    HeroStore& operator=(const HeroStore&) = delete;
+
+    // Store a hero, replacing any stored hero with the same id
+    HeroHandle add(Hero hero);
+    bool remove(HeroID id);
+
+    size_t size() const { return sortedIds.size(); }
+    bool empty() const { return sortedIds.empty(); }
+
+    HeroHandle getHandle(HeroID id) const;
+    Hero* get(HeroHandle handle);
+    const Hero* get(HeroHandle handle) const;
+    Hero* find(HeroID id) { return get(getHandle(id)); }
+    const Hero* find(HeroID id) const { return get(getHandle(id)); }
+
+    // Owners follow the players' hero lists; 0 for a hero no player lists
+    PlayerID getOwner(HeroID id) const;
+    void setOwner(HeroID id, PlayerID owner);
+    void releaseOwner(HeroID id, PlayerID owner);  // Only if owner still has it
+
+    Range<Hero> all() { return Range<Hero>(this, false, 0); }
+    Range<const Hero> all() const { return Range<const Hero>(this, false, 0); }
+    Range<Hero> ownedBy(PlayerID owner) { return Range<Hero>(this, true, owner); }
+    Range<const Hero> ownedBy(PlayerID owner) const { return Range<const Hero>(this, true, owner); }
+
+    // Heroes standing inside area on level z, in id order
+    void findInRegion(const Rect& area, int z, std::vector<HeroHandle>& found) const;
+
+    // Raw slots for sweeps that don't need id order: [0, getSlotCount()), null where free.
+    // The hot field arrays below are indexed the same way.
+    size_t getSlotCount() const { return slots.size(); }
+    Hero* getSlot(size_t index) { return slots[index] ? &*slots[index] : nullptr; }
+    const Hero* getSlot(size_t index) const { return slots[index] ? &*slots[index] : nullptr; }
+    const std::vector<Position>& getPositions() const { return positions; }
+    const std::vector<int>& getMovementPoints() const { return movementPoints; }
+    const std::vector<PlayerID>& getOwners() const { return owners; }
+
+private:
+    size_t countOwnedBy(PlayerID owner) const;
+    size_t sortedPosition(HeroID id) const;
+    void heroMoved(uint32_t slot, const Position& position);
+    void insertIntoRegion(uint32_t slot);
+    void removeFromRegion(uint32_t slot);
+};
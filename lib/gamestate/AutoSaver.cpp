@@ -0,0 +1,105 @@
+#include "AutoSaver.h"
+#include <cstdio>
+#include <iostream>
+#include <stdexcept>
+
+AutoSaver::AutoSaver(const std::string& basePath, int fullSaveInterval)
+    : snapshotPath(basePath + ".sav"), deltaPath(basePath + ".delta"),
+      fullSaveInterval(fullSaveInterval < 1 ? 1 : fullSaveInterval), savesSinceFull(0),
+      baseSnapshotId(0), haveBase(false), baseWriteFailed(false), writing(false), stopping(false) {
+    writer = std::thread([this]() { writerLoop(); });
+}
+
+AutoSaver::~AutoSaver() {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopping = true;
+    }
+    workAvailable.notify_all();
+    writer.join();
+}
+
+void AutoSaver::autosave(GameState& state) {
+    if (!haveBase || baseWriteFailed || savesSinceFull + 1 >= fullSaveInterval) {
+        saveFull(state);
+        return;
+    }
+
+    savesSinceFull++;
+    enqueue(SaveGame::captureDelta(state, baseSnapshotId));
+}
+
+void AutoSaver::saveFull(GameState& state) {
+    SaveSnapshot snapshot = SaveGame::captureFull(state);
+    state.clearDirtyFlags();
+
+    baseSnapshotId = snapshot.getSnapshotId();
+    haveBase = true;
+    baseWriteFailed = false;
+    savesSinceFull = 0;
+    enqueue(std::move(snapshot));
+}
+
+void AutoSaver::flush() {
+    std::unique_lock<std::mutex> lock(queueMutex);
+    queueDrained.wait(lock, [this]() { return pending.empty() && !writing; });
+}
+
+std::string AutoSaver::getLastError() {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    return lastError;
+}
+
+void AutoSaver::enqueue(SaveSnapshot snapshot) {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        // Deltas are cumulative, so a newer one replaces a delta that has not been written yet
+        if (snapshot.isDelta() && !pending.empty() && pending.back().isDelta()) {
+            pending.back() = std::move(snapshot);
+        } else {
+            pending.push_back(std::move(snapshot));
+        }
+    }
+    workAvailable.notify_one();
+}
+
+void AutoSaver::writerLoop() {
+    std::unique_lock<std::mutex> lock(queueMutex);
+    while (true) {
+        workAvailable.wait(lock, [this]() { return stopping || !pending.empty(); });
+        if (pending.empty()) {
+            return;
+        }
+
+        SaveSnapshot snapshot = std::move(pending.front());
+        pending.pop_front();
+        writing = true;
+        lock.unlock();
+
+        std::string error;
+        try {
+            if (snapshot.isDelta()) {
+                snapshot.write(deltaPath);
+            } else {
+                snapshot.write(snapshotPath);
+                // The old delta belongs to the previous snapshot
+                std::remove(deltaPath.c_str());
+            }
+        } catch (const std::exception& e) {
+            error = e.what();
+            if (!snapshot.isDelta()) {
+                baseWriteFailed = true;
+            }
+            std::cerr << "Autosave failed: " << error << std::endl;
+        }
+
+        lock.lock();
+        writing = false;
+        if (!error.empty()) {
+            lastError = error;
+        }
+        if (pending.empty()) {
+            queueDrained.notify_all();
+        }
+    }
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "SaveGame.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Periodic saves written by a background thread.
+//
+// autosave() captures the game on the calling thread and returns; the writer thread does the
+// disk I/O. A full snapshot goes to <basePath>.sav on the first call and every fullSaveInterval
+// calls. The calls in between write a delta to <basePath>.delta. The delta holds everything
+// marked dirty since that snapshot, so capturing it costs time in proportion to what changed.
+// The AutoSaver owns the dirty flags of the states it saves: they are cleared after each full
+// snapshot. Restore with SaveGame::load(getSnapshotPath(), getDeltaPath()).
+class AutoSaver {
+private:
+    std::string snapshotPath;
+    std::string deltaPath;
+    int fullSaveInterval;
+    int savesSinceFull;
+    uint64_t baseSnapshotId;
+    bool haveBase;
+    std::atomic<bool> baseWriteFailed;
+
+    std::thread writer;
+    std::mutex queueMutex;
+    std::condition_variable workAvailable;
+    std::condition_variable queueDrained;
+    std::deque<SaveSnapshot> pending;
+    bool writing;
+    bool stopping;
+    std::string lastError;
+
+public:
+    explicit AutoSaver(const std::string& basePath, int fullSaveInterval = 7);
+    ~AutoSaver();  // Finishes queued writes
+
+    AutoSaver(const AutoSaver&) = delete;
+    AutoSaver& operator=(const AutoSaver&) = delete;
+
+    // Queue a delta, or a full snapshot when one is due
+    void autosave(GameState& state);
+    // Queue a full snapshot and make it the base for later deltas
+    void saveFull(GameState& state);
+
+    // Block until everything queued so far is on disk
+    void flush();
+
+    const std::string& getSnapshotPath() const { return snapshotPath; }
+    const std::string& getDeltaPath() const { return deltaPath; }
+
+    // Message of the most recent failed write, empty if none
+    std::string getLastError();
+
+private:
+    void enqueue(SaveSnapshot snapshot);
+    void writerLoop();
+};
@@ -0,0 +1,317 @@
+#include "CommandLog.h"
+#include "SaveGame.h"
+#include "../data/MappedFile.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+const char LOG_MAGIC[4] = { 'R', 'E', 'C', 'L' };
+const size_t FLUSH_BYTES = 64 * 1024;
+
+enum class LogRecord : uint8_t {
+    Command = 1,
+    Checkpoint = 2
+};
+
+using Clock = std::chrono::steady_clock;
+
+class StateHasher {
+private:
+    uint64_t hash = 0xcbf29ce484222325ull;
+
+public:
+    void add(uint64_t value) {
+        hash = (hash ^ value) * 0x9E3779B97F4A7C15ull;
+        hash ^= hash >> 32;
+    }
+
+    void add(const Position& position) {
+        add(static_cast<uint32_t>(position.x));
+        add(static_cast<uint32_t>(position.y));
+        add(static_cast<uint32_t>(position.z));
+    }
+
+    void add(const Resources& resources) {
+        for (int value : { resources.wood, resources.mercury, resources.ore, resources.sulfur, resources.crystal,
+                           resources.gems, resources.gold }) {
+            add(static_cast<uint32_t>(value));
+        }
+    }
+
+    void addBytes(const uint8_t* data, size_t size) {
+        size_t offset = 0;
+        for (; offset + sizeof(uint64_t) <= size; offset += sizeof(uint64_t)) {
+            uint64_t word;
+            std::memcpy(&word, data + offset, sizeof(word));
+            add(word);
+        }
+        uint64_t tail = 0;
+        std::memcpy(&tail, data + offset, size - offset);
+        add(tail ^ size);
+    }
+
+    uint64_t get() const { return hash; }
+};
+
+std::string directoryOf(const std::string& path) {
+    size_t slash = path.find_last_of('/');
+    return slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+}
+
+std::string fileNameOf(const std::string& path) {
+    size_t slash = path.find_last_of('/');
+    return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+} // namespace
+
+uint64_t hashGameState(const GameState& state) {
+    StateHasher hasher;
+    hasher.add(state.isGameRunning());
+    hasher.add(state.isGameWon());
+    hasher.add(state.getWinner());
+    const TurnManager& turns = state.getTurnManager();
+    hasher.add(turns.getCurrentPlayer());
+    hasher.add(static_cast<uint32_t>(turns.getTurnNumber()));
+    hasher.add(static_cast<uint32_t>(turns.getDayNumber()));
+
+    for (const auto& [id, player] : state.getAllPlayers()) {
+        hasher.add(id);
+        hasher.add(player->getResources());
+        for (HeroID hero : player->getHeroes()) {
+            hasher.add(hero);
+        }
+        for (TownID town : player->getTowns()) {
+            hasher.add(town);
+        }
+        hasher.add(player->isActivePlayer());
+    }
+
+    for (const auto& [id, hero] : state.getAllHeroes()) {
+        hasher.add(id);
+        hasher.add(hero->getPosition());
+        for (int value : { hero->getMovementPoints(), hero->getMaxMovementPoints(), hero->getAttack(),
+                           hero->getDefense(), hero->getSpellPower(), hero->getKnowledge(), hero->getMana(),
+                           hero->getMaxMana(), hero->getExperience(), hero->getLevel() }) {
+            hasher.add(static_cast<uint32_t>(value));
+        }
+        for (const auto& [skill, level] : hero->getAllSkills()) {
+            hasher.add((static_cast<uint64_t>(skill) << 32) | static_cast<uint32_t>(level));
+        }
+        for (int slot = 0; slot < Army::MAX_SLOTS; slot++) {
+            const ArmySlot& army = hero->getArmy().getSlot(slot);
+            hasher.add((static_cast<uint64_t>(army.creatureId) << 32) | static_cast<uint32_t>(army.count));
+        }
+        for (SpellID spell : hero->getKnownSpells()) {
+            hasher.add(spell);
+        }
+        for (ArtifactID artifact : hero->getArtifacts()) {
+            hasher.add(artifact);
+        }
+    }
+
+    const GameMap* map = state.getMap();
+    if (!map) {
+        return hasher.get();
+    }
+
+    std::vector<const MapObject*> objects;
+    objects.reserve(map->getAllObjects().size());
+    for (const auto& object : map->getAllObjects()) {
+        objects.push_back(object.get());
+    }
+    std::sort(objects.begin(), objects.end(), [](const MapObject* a, const MapObject* b) {
+        return a->getId() < b->getId();
+    });
+    for (const MapObject* object : objects) {
+        hasher.add(object->getId());
+        hasher.add(static_cast<uint8_t>(object->getType()));
+        hasher.add(object->getPosition());
+        hasher.add(object->blocksMovement());
+        if (const auto* mine = dynamic_cast<const ResourceMine*>(object)) {
+            hasher.add(mine->getOwner());
+            hasher.add(static_cast<uint32_t>(mine->getDailyProduction()));
+        } else if (const auto* monsters = dynamic_cast<const MonsterGroup*>(object)) {
+            hasher.add(monsters->getCreatureType());
+            hasher.add(static_cast<uint32_t>(monsters->getCount()));
+        }
+    }
+
+    // MapTile has no padding bytes, so the planes can be hashed as raw memory
+    hasher.addBytes(reinterpret_cast<const uint8_t*>(map->getTileData()), map->getTileCount() * sizeof(MapTile));
+    return hasher.get();
+}
+
+CommandLogWriter::CommandLogWriter(const std::string& path, const GameState& gameState,
+                                   const CommandProcessor& processor, uint32_t checkpointInterval)
+    : state(gameState), checkpointInterval(std::max(1u, checkpointInterval)), commandCount(0),
+      checkpointedCount(0), failed(false) {
+    std::string startPath = path + ".start";
+    SaveGame::save(state, startPath);
+
+    file.open(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        throw std::runtime_error("Failed to create command log: " + path);
+    }
+
+    pending.write(LOG_MAGIC);
+    pending.write(static_cast<uint32_t>(FORMAT_VERSION));
+    pending.write(processor.getBattleSeed());
+    pending.write(processor.getBattlesFought());
+    pending.write(this->checkpointInterval);
+    pending.writeString(fileNameOf(startPath));
+    // Checkpoint 0 pins the start save to the state the log was started from
+    checkpoint();
+    if (failed) {
+        throw std::runtime_error("Failed to write command log: " + path);
+    }
+}
+
+CommandLogWriter::~CommandLogWriter() {
+    close();
+}
+
+void CommandLogWriter::record(const GameCommand& command, const CommandOutcome& outcome) {
+    if (!file.is_open()) {
+        return;
+    }
+    pending.write(LogRecord::Command);
+    pending.write(outcome.status);
+    pending.write(command);
+    commandCount++;
+
+    if (commandCount % checkpointInterval == 0) {
+        checkpoint();
+    } else if (pending.getSize() >= FLUSH_BYTES) {
+        flush();
+    }
+}
+
+void CommandLogWriter::close() {
+    if (!file.is_open()) {
+        return;
+    }
+    if (checkpointedCount != commandCount) {
+        checkpoint();
+    }
+    file.close();
+}
+
+void CommandLogWriter::checkpoint() {
+    pending.write(LogRecord::Checkpoint);
+    pending.write(commandCount);
+    pending.write(hashGameState(state));
+    checkpointedCount = commandCount;
+    flush();
+}
+
+void CommandLogWriter::flush() {
+    std::vector<uint8_t>& bytes = pending.getBytes();
+    file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    file.flush();
+    failed |= !file;
+    bytes.clear();
+}
+
+ReplayReport CommandReplayer::replay(const std::string& path) {
+    MappedFile file;
+    if (!file.open(path)) {
+        throw std::runtime_error("Failed to open command log: " + path);
+    }
+    BinaryReader in(file.getData(), file.getSize());
+
+    uint32_t magic = in.read<uint32_t>();
+    if (std::memcmp(&magic, LOG_MAGIC, sizeof(magic)) != 0) {
+        throw std::runtime_error("Not a command log: " + path);
+    }
+    if (in.read<uint32_t>() != CommandLogWriter::FORMAT_VERSION) {
+        throw std::runtime_error("Unsupported command log version: " + path);
+    }
+    uint32_t battleSeed = in.read<uint32_t>();
+    uint32_t battlesFought = in.read<uint32_t>();
+    in.read<uint32_t>();  // Checkpoint interval, informational
+    std::string startPath = directoryOf(path) + in.readString();
+
+    if (!GameState::isCreatureDatabaseLoaded()) {
+        GameState::loadCreatureDatabase();
+    }
+    std::unique_ptr<GameState> state = SaveGame::load(startPath);
+    ReplayReport report;
+    const size_t COMMAND_TYPES = sizeof(report.byType) / sizeof(report.byType[0]);
+    CommandProcessor processor(*state, battleSeed);
+    processor.setBattlesFought(battlesFought);
+
+    auto keepIfSlow = [&report](const ReplayedCommand& replayed) {
+        auto& slowest = report.slowest;
+        if (slowest.size() == SLOWEST_KEPT && replayed.microseconds <= slowest.back().microseconds) {
+            return;
+        }
+        auto position = std::upper_bound(slowest.begin(), slowest.end(), replayed,
+            [](const ReplayedCommand& a, const ReplayedCommand& b) { return a.microseconds > b.microseconds; });
+        slowest.insert(position, replayed);
+        if (slowest.size() > SLOWEST_KEPT) {
+            slowest.pop_back();
+        }
+    };
+
+    // A record cut short by a crash while writing ends the log
+    const size_t commandRecordSize = sizeof(LogRecord) + sizeof(CommandStatus) + sizeof(GameCommand);
+    const size_t checkpointRecordSize = sizeof(LogRecord) + 2 * sizeof(uint64_t);
+    while (in.remaining() > 0) {
+        LogRecord kind = in.read<LogRecord>();
+        if (kind == LogRecord::Command) {
+            if (in.remaining() < commandRecordSize - sizeof(LogRecord)) {
+                break;
+            }
+            CommandStatus recordedStatus = in.read<CommandStatus>();
+            GameCommand command = in.read<GameCommand>();
+            size_t type = static_cast<size_t>(command.type);
+            if (type >= COMMAND_TYPES) {
+                throw std::runtime_error("Malformed command log: " + path);
+            }
+
+            auto start = Clock::now();
+            CommandOutcome outcome = processor.apply(command);
+            double microseconds = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+
+            ReplayReport::TypeTiming& timing = report.byType[type];
+            timing.count++;
+            timing.totalMicroseconds += microseconds;
+            timing.maxMicroseconds = std::max(timing.maxMicroseconds, microseconds);
+            report.totalMs += microseconds / 1000.0;
+            keepIfSlow({ report.commands, command, microseconds });
+            report.commands++;
+
+            if (outcome.status != recordedStatus) {
+                report.diverged = true;
+                report.divergedAt = report.commands - 1;
+                report.divergence = std::string("command was ") + commandStatusName(outcome.status) +
+                                    ", recorded as " + commandStatusName(recordedStatus);
+                break;
+            }
+        } else if (kind == LogRecord::Checkpoint) {
+            if (in.remaining() < checkpointRecordSize - sizeof(LogRecord)) {
+                break;
+            }
+            uint64_t count = in.read<uint64_t>();
+            uint64_t hash = in.read<uint64_t>();
+            if (count != report.commands) {
+                throw std::runtime_error("Malformed command log: " + path);
+            }
+            if (hashGameState(*state) != hash) {
+                report.diverged = true;
+                report.divergedAt = report.commands ? report.commands - 1 : 0;
+                report.divergence = report.commands ? "state hash differs at checkpoint"
+                                                    : "start save does not match the logged state";
+                break;
+            }
+            report.checkpoints++;
+        } else {
+            throw std::runtime_error("Malformed command log: " + path);
+        }
+    }
+    return report;
+}
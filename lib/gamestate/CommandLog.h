@@ -0,0 +1,96 @@
+#pragma once
+
+#include "GameCommands.h"
+#include "../data/BinaryStream.h"
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Hash of everything commands can change: turn state, players, heroes, map objects and tiles.
+// Visits players, heroes and objects in id order, so equal states hash equally however they
+// were built (played, loaded from a save, replayed).
+uint64_t hashGameState(const GameState& state);
+
+// Append-only record of the commands applied to one game, for reproducing desyncs and slow turns.
+//
+// A log starts from a full save of the game, written next to it as <path>.start, and the position
+// of its CommandProcessor's battle streams. Then come one 26-byte record per applied command
+// (EndTurn covers the turn change and the daily events), and every checkpointInterval commands
+// and on close, a checkpoint holding hashGameState() after that command. Records are buffered
+// and written out at checkpoints. Values are stored in native byte order.
+class CommandLogWriter {
+public:
+    static const uint32_t FORMAT_VERSION = 1;
+    static const uint32_t DEFAULT_CHECKPOINT_INTERVAL = 64;
+
+private:
+    const GameState& state;
+    std::ofstream file;
+    BinaryWriter pending;
+    uint32_t checkpointInterval;
+    uint64_t commandCount;
+    uint64_t checkpointedCount;
+    bool failed;
+
+public:
+    // Starts the log from the state as it is now. Throws std::runtime_error if the log or its
+    // start save cannot be written.
+    CommandLogWriter(const std::string& path, const GameState& gameState, const CommandProcessor& processor,
+                     uint32_t checkpointInterval = DEFAULT_CHECKPOINT_INTERVAL);
+    ~CommandLogWriter();
+
+    CommandLogWriter(const CommandLogWriter&) = delete;
+    CommandLogWriter& operator=(const CommandLogWriter&) = delete;
+
+    // Call after each command was applied to the state. Never throws; see good().
+    void record(const GameCommand& command, const CommandOutcome& outcome);
+
+    // Write a final checkpoint and close the file
+    void close();
+
+    uint64_t getCommandCount() const { return commandCount; }
+    // False once a write failed; the log is then incomplete
+    bool good() const { return !failed; }
+
+private:
+    void checkpoint();
+    void flush();
+};
+
+struct ReplayedCommand {
+    uint64_t index;             // Position in the log, from 0
+    GameCommand command;
+    double microseconds;
+};
+
+struct ReplayReport {
+    uint64_t commands = 0;
+    uint64_t checkpoints = 0;         // Checkpoints that matched
+    double totalMs = 0;               // Time spent applying commands
+
+    // Set when the replay stopped disagreeing with the recording
+    bool diverged = false;
+    uint64_t divergedAt = 0;          // Index of the last command applied before the mismatch
+    std::string divergence;
+
+    struct TypeTiming {
+        uint64_t count = 0;
+        double totalMicroseconds = 0;
+        double maxMicroseconds = 0;
+    };
+    TypeTiming byType[3];             // Indexed by CommandType
+    std::vector<ReplayedCommand> slowest;   // Slowest first
+
+    double commandsPerSecond() const { return totalMs > 0 ? commands * 1000.0 / totalMs : 0; }
+};
+
+// Re-executes a command log headlessly as fast as it can, timing each command and comparing the
+// results and state hashes against the recording. Stops at the first disagreement, since every
+// later difference would follow from it. Definitions must be loaded as they were when recording.
+class CommandReplayer {
+public:
+    static const size_t SLOWEST_KEPT = 10;
+
+    // Throws std::runtime_error if the log or its start save is missing or malformed
+    static ReplayReport replay(const std::string& path);
+};
@@ -0,0 +1,191 @@
+#include "EventScheduler.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+
+uint32_t indexOf(EventScheduler::EventID id) {
+    return static_cast<uint32_t>(id);
+}
+
+uint32_t generationOf(EventScheduler::EventID id) {
+    return static_cast<uint32_t>(id >> 32);
+}
+
+} // namespace
+
+EventScheduler::EventScheduler(int currentDay) : currentDay(0), nextSequence(0), pendingCount(0), advancing(false) {
+    reset(currentDay);
+}
+
+EventScheduler::EventID EventScheduler::schedule(int day, Callback callback, int period) {
+    if (!callback) {
+        throw std::runtime_error("Scheduled event has no callback");
+    }
+
+    uint32_t index;
+    if (!freeEvents.empty()) {
+        index = freeEvents.back();
+        freeEvents.pop_back();
+    } else {
+        index = static_cast<uint32_t>(events.size());
+        events.emplace_back();
+    }
+
+    Event& event = events[index];
+    event.active = true;
+    event.day = std::max(day, currentDay + 1);
+    event.period = std::max(0, period);
+    event.sequence = nextSequence++;
+    event.callback = std::move(callback);
+    pendingCount++;
+
+    EventID id = (static_cast<EventID>(event.generation) << 32) | index;
+    insert(id, event.day);
+    return id;
+}
+
+bool EventScheduler::cancel(EventID id) {
+    if (!find(id)) {
+        return false;
+    }
+    // The id stays in its wheel slot and is skipped when the slot comes up
+    release(indexOf(id));
+    return true;
+}
+
+bool EventScheduler::isScheduled(EventID id) const {
+    return find(id) != nullptr;
+}
+
+size_t EventScheduler::advanceTo(int day) {
+    if (advancing) {
+        throw std::runtime_error("Scheduler advanced from one of its own callbacks");
+    }
+    advancing = true;
+    size_t ran = 0;
+    while (currentDay < day) {
+        currentDay++;
+        uint32_t now = static_cast<uint32_t>(currentDay);
+
+        // Entering a new span at some level brings that span's events down, highest level first
+        if ((now & ((1u << (LEVELS * SLOT_BITS)) - 1)) == 0) {
+            cascade(overflow);
+        }
+        for (int level = LEVELS - 1; level > 0; level--) {
+            if ((now & ((1u << (level * SLOT_BITS)) - 1)) == 0) {
+                cascade(wheel[level][(now >> (level * SLOT_BITS)) & (SLOTS - 1)]);
+            }
+        }
+        try {
+            ran += runDay();
+        } catch (...) {
+            advancing = false;
+            throw;
+        }
+    }
+    advancing = false;
+    return ran;
+}
+
+void EventScheduler::reset(int day) {
+    if (day < 0 || advancing) {
+        throw std::runtime_error("Scheduler reset to a negative day or from one of its callbacks");
+    }
+    for (uint32_t index = 0; index < events.size(); index++) {
+        if (events[index].active) {
+            release(index);
+        }
+    }
+    for (auto& level : wheel) {
+        for (std::vector<EventID>& slot : level) {
+            slot.clear();
+        }
+    }
+    overflow.clear();
+    currentDay = day;
+}
+
+EventScheduler::Event* EventScheduler::find(EventID id) {
+    uint32_t index = indexOf(id);
+    if (index >= events.size() || !events[index].active || events[index].generation != generationOf(id)) {
+        return nullptr;
+    }
+    return &events[index];
+}
+
+const EventScheduler::Event* EventScheduler::find(EventID id) const {
+    return const_cast<EventScheduler*>(this)->find(id);
+}
+
+void EventScheduler::release(uint32_t index) {
+    Event& event = events[index];
+    event.active = false;
+    event.generation++;
+    event.callback = nullptr;
+    freeEvents.push_back(index);
+    pendingCount--;
+}
+
+// The level is the highest base-64 digit in which day differs from the current day: the event
+// waits there until the current day reaches its span at that level
+void EventScheduler::insert(EventID id, int day) {
+    uint32_t target = static_cast<uint32_t>(day);
+    uint32_t differing = target ^ static_cast<uint32_t>(currentDay);
+    if (differing >> (LEVELS * SLOT_BITS)) {
+        overflow.push_back(id);
+        return;
+    }
+
+    int level = 0;
+    while (level + 1 < LEVELS && (differing >> ((level + 1) * SLOT_BITS))) {
+        level++;
+    }
+    wheel[level][(target >> (level * SLOT_BITS)) & (SLOTS - 1)].push_back(id);
+}
+
+void EventScheduler::cascade(std::vector<EventID>& slot) {
+    std::vector<EventID> moving;
+    moving.swap(slot);
+    for (EventID id : moving) {
+        if (const Event* event = find(id)) {
+            insert(id, event->day);
+        }
+    }
+}
+
+// Level 0 slot of the current day holds exactly the events due today
+size_t EventScheduler::runDay() {
+    // Today's list is kept apart while it runs: callbacks can schedule into the slot again
+    due.clear();
+    due.swap(wheel[0][static_cast<uint32_t>(currentDay) & (SLOTS - 1)]);
+    due.erase(std::remove_if(due.begin(), due.end(), [this](EventID id) { return !find(id); }), due.end());
+    std::sort(due.begin(), due.end(), [this](EventID a, EventID b) {
+        return events[indexOf(a)].sequence < events[indexOf(b)].sequence;
+    });
+
+    size_t ran = 0;
+    for (EventID id : due) {
+        if (!find(id)) {
+            continue;           // Cancelled by an earlier callback today
+        }
+
+        // Moved out while it runs: a callback scheduling new events may grow the event table
+        Callback callback = std::move(events[indexOf(id)].callback);
+        callback(currentDay);
+        ran++;
+
+        Event* event = find(id);
+        if (!event) {
+            continue;           // Cancelled itself
+        }
+        if (event->period > 0) {
+            event->callback = std::move(callback);
+            event->day = currentDay + event->period;
+            insert(id, event->day);
+        } else {
+            release(indexOf(id));
+        }
+    }
+    return ran;
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// Day-keyed event scheduler on a hierarchical timer wheel.
+//
+// Game systems register callbacks for the day they are due (mine production, creature growth,
+// timed map events, the end of a hero's buff) instead of being swept every turn. advanceTo()
+// runs only what has come due: level 0 of the wheel holds the events of the next 64 days, one
+// slot per day, and each higher level holds 64 times longer spans whose events are moved down a
+// level as the current day reaches them. Scheduling and cancelling are constant time; advancing
+// a day costs the events due that day plus the occasional cascade.
+//
+// Events due the same day run in the order they were first scheduled, so the game stays
+// deterministic. Callbacks may schedule and cancel events, including themselves; an event
+// scheduled for the current day or earlier runs on the next day advanced to.
+class EventScheduler {
+public:
+    using EventID = uint64_t;
+    using Callback = std::function<void(int day)>;
+
+    static const EventID INVALID_EVENT = 0;
+
+private:
+    static const int SLOT_BITS = 6;
+    static const int SLOTS = 1 << SLOT_BITS;
+    static const int LEVELS = 4;               // 64^4 days ahead; later events wait in overflow
+
+    struct Event {
+        uint32_t generation = 0;               // Bumped on release, so stale ids do not match
+        bool active = false;
+        int day = 0;
+        int period = 0;
+        uint64_t sequence = 0;                 // Registration order, kept when a repeat is rescheduled
+        Callback callback;
+    };
+
+    std::vector<Event> events;                 // Indexed by the low half of an EventID
+    std::vector<uint32_t> freeEvents;
+    std::vector<EventID> wheel[LEVELS][SLOTS];
+    std::vector<EventID> overflow;
+    std::vector<EventID> due;                  // Scratch for the day being run
+    int currentDay;
+    uint64_t nextSequence;
+    size_t pendingCount;
+    bool advancing;
+
+public:
+    explicit EventScheduler(int currentDay = 1);
+
+    EventScheduler(const EventScheduler&) = delete;
+    EventScheduler& operator=(const EventScheduler&) = delete;
+
+    // Run callback on day, then every period days after it if period > 0
+    EventID schedule(int day, Callback callback, int period = 0);
+    // Returns false if the event already ran (and does not repeat) or was cancelled
+    bool cancel(EventID id);
+    bool isScheduled(EventID id) const;
+
+    // Run everything due after the current day up to and including day; returns callbacks run
+    size_t advanceTo(int day);
+
+    // Drop every event and restart the clock at currentDay
+    void reset(int currentDay);
+
+    int getCurrentDay() const { return currentDay; }
+    size_t getPendingCount() const { return pendingCount; }
+
+private:
+    Event* find(EventID id);
+    const Event* find(EventID id) const;
+    void release(uint32_t index);
+    void insert(EventID id, int day);
+    void cascade(std::vector<EventID>& slot);
+    size_t runDay();
+};
@@ -0,0 +1,220 @@
+#include "GameCommands.h"
+#include <algorithm>
+#include <cstdlib>
+
+GameCommand GameCommand::moveHero(PlayerID player, HeroID hero, const Position& target) {
+    GameCommand command = {};
+    command.type = CommandType::MoveHero;
+    command.player = player;
+    command.hero = hero;
+    command.target = target;
+    return command;
+}
+
+GameCommand GameCommand::endTurn(PlayerID player) {
+    GameCommand command = {};
+    command.type = CommandType::EndTurn;
+    command.player = player;
+    return command;
+}
+
+GameCommand GameCommand::fight(PlayerID player, HeroID hero, uint32_t objectId) {
+    GameCommand command = {};
+    command.type = CommandType::Fight;
+    command.player = player;
+    command.hero = hero;
+    command.objectId = objectId;
+    return command;
+}
+
+const char* commandStatusName(CommandStatus status) {
+    switch (status) {
+        case CommandStatus::Ok: return "ok";
+        case CommandStatus::NotYourTurn: return "not your turn";
+        case CommandStatus::UnknownHero: return "unknown hero";
+        case CommandStatus::NotYourHero: return "not your hero";
+        case CommandStatus::UnknownTarget: return "unknown target";
+        case CommandStatus::Unreachable: return "unreachable";
+        case CommandStatus::NoMovementLeft: return "no movement left";
+        case CommandStatus::TooFar: return "too far";
+        case CommandStatus::GameOver: return "game over";
+        case CommandStatus::Busy: return "busy";
+    }
+    return "unknown";
+}
+
+CommandProcessor::CommandProcessor(GameState& gameState, uint32_t battleSeed)
+    : state(gameState), pathfinderMap(nullptr), battleSeed(battleSeed), battleStreams(battleSeed), battlesFought(0) {
+}
+
+CommandOutcome CommandProcessor::apply(const GameCommand& command) {
+    CommandOutcome outcome;
+    if (!state.isGameRunning()) {
+        outcome.status = CommandStatus::GameOver;
+        return outcome;
+    }
+    if (command.player != state.getCurrentPlayer()) {
+        outcome.status = CommandStatus::NotYourTurn;
+        return outcome;
+    }
+
+    switch (command.type) {
+        case CommandType::MoveHero:
+            if (Hero* hero = findOwnedHero(command, outcome)) {
+                return moveHero(command, *hero);
+            }
+            return outcome;
+        case CommandType::Fight:
+            if (Hero* hero = findOwnedHero(command, outcome)) {
+                return fight(command, *hero);
+            }
+            return outcome;
+        case CommandType::EndTurn:
+            return endTurn();
+    }
+
+    outcome.status = CommandStatus::UnknownTarget;
+    return outcome;
+}
+
+Hero* CommandProcessor::findOwnedHero(const GameCommand& command, CommandOutcome& outcome) {
+    Hero* hero = state.getHero(command.hero);
+    if (!hero) {
+        outcome.status = CommandStatus::UnknownHero;
+        return nullptr;
+    }
+
+    const Player* player = state.getPlayer(command.player);
+    if (!player || std::find(player->getHeroes().begin(), player->getHeroes().end(), command.hero) ==
+                   player->getHeroes().end()) {
+        outcome.status = CommandStatus::NotYourHero;
+        return nullptr;
+    }
+    return hero;
+}
+
+CommandOutcome CommandProcessor::moveHero(const GameCommand& command, Hero& hero) {
+    CommandOutcome outcome;
+    outcome.heroPosition = hero.getPosition();
+    outcome.movementPoints = hero.getMovementPoints();
+
+    GameMap* map = state.getMap();
+    if (!map || !map->isValidPosition(command.target)) {
+        outcome.status = CommandStatus::UnknownTarget;
+        return outcome;
+    }
+    if (hero.getMovementPoints() <= 0) {
+        outcome.status = CommandStatus::NoMovementLeft;
+        return outcome;
+    }
+
+    if (!pathfinder || pathfinderMap != map) {
+        pathfinder = std::make_unique<Pathfinder>(*map);
+        pathfinderMap = map;
+    }
+    if (!pathfinder->findPath(hero, command.target, path)) {
+        outcome.status = CommandStatus::Unreachable;
+        return outcome;
+    }
+
+    int steps = path.getAffordableSteps(hero.getMovementPoints());
+    if (steps == 0) {
+        outcome.status = CommandStatus::NoMovementLeft;
+        return outcome;
+    }
+
+    Position from = hero.getPosition();
+    Position to = path.steps[steps - 1];
+    map->moveHero(hero.getId(), from, to);
+    hero.setPosition(to);
+    hero.setMovementPoints(hero.getMovementPoints() - path.cumulativeCost[steps - 1]);
+
+    // Walking onto a mine takes it over
+    const MapTile& tile = map->getTile(to);
+    if (tile.object == ObjectType::Mine) {
+        ResourceMine* mine = dynamic_cast<ResourceMine*>(map->getObject(tile.objectId));
+        if (mine && mine->getOwner() != command.player) {
+            mine->setOwner(command.player);
+            outcome.claimedMine = mine->getId();
+        }
+    }
+
+    outcome.heroPosition = to;
+    outcome.movementPoints = hero.getMovementPoints();
+    return outcome;
+}
+
+CommandOutcome CommandProcessor::fight(const GameCommand& command, Hero& hero) {
+    CommandOutcome outcome;
+    outcome.heroPosition = hero.getPosition();
+    outcome.movementPoints = hero.getMovementPoints();
+
+    GameMap* map = state.getMap();
+    MonsterGroup* monsters = map ? dynamic_cast<MonsterGroup*>(map->getObject(command.objectId)) : nullptr;
+    if (!monsters) {
+        outcome.status = CommandStatus::UnknownTarget;
+        return outcome;
+    }
+
+    const Position& heroPos = hero.getPosition();
+    const Position& monsterPos = monsters->getPosition();
+    if (heroPos.z != monsterPos.z ||
+        std::max(std::abs(heroPos.x - monsterPos.x), std::abs(heroPos.y - monsterPos.y)) > 1) {
+        outcome.status = CommandStatus::TooFar;
+        return outcome;
+    }
+
+    BattleEngine battle(&hero, battleStreams.split(battlesFought++));
+    const Army& army = hero.getArmy();
+    for (int i = 0; i < Army::MAX_SLOTS; i++) {
+        const ArmySlot& slot = army.getSlot(i);
+        if (!slot.isEmpty()) {
+            battle.addPlayerUnit(slot.creatureId, slot.count);
+        }
+    }
+    battle.addEnemyUnit(monsters->getCreatureType(), monsters->getCount());
+
+    outcome.battleResult = battle.executeAutoBattle();
+
+    // Survivors fill the army slots in order
+    Army& updatedArmy = hero.getArmy();
+    for (int i = 0; i < Army::MAX_SLOTS; i++) {
+        updatedArmy.getSlot(i) = ArmySlot();
+    }
+    int slotIndex = 0;
+    for (const auto& unit : battle.getPlayerUnits()) {
+        if (unit.count > 0 && slotIndex < Army::MAX_SLOTS) {
+            updatedArmy.getSlot(slotIndex++) = ArmySlot(unit.creatureId, unit.count);
+        }
+    }
+
+    // The round limit can end a battle the hero survives with monsters still standing; only a
+    // group with no survivors is beaten
+    int survivors = 0;
+    for (const auto& unit : battle.getEnemyUnits()) {
+        survivors += unit.count;
+    }
+    if (outcome.battleResult == BattleResult::Victory && survivors == 0) {
+        outcome.experienceGained = battle.calculateExperienceGained();
+        hero.gainExperience(outcome.experienceGained);
+        map->removeObject(monsters->getId());
+        outcome.objectRemoved = true;
+    } else {
+        monsters->setCount(survivors);
+    }
+    return outcome;
+}
+
+CommandOutcome CommandProcessor::endTurn() {
+    CommandOutcome outcome;
+    TurnManager& turns = state.getTurnManager();
+
+    int day = turns.getDayNumber();
+    turns.nextPlayer();
+    if (turns.getDayNumber() != day) {
+        state.processDailyEvents();
+        outcome.newDay = true;
+    }
+    outcome.nextPlayer = turns.getCurrentPlayer();
+    return outcome;
+}
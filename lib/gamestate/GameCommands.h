@@ -0,0 +1,98 @@
+#pragma once
+
+#include "GameState.h"
+#include "../battle/Battle.h"
+#include "../map/Pathfinder.h"
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+
+// Player actions that change the game. Commands are plain data so they can be queued,
+// sent over the network and logged without allocation.
+enum class CommandType : uint8_t {
+    MoveHero,   // Walk hero along the cheapest path towards target, as far as movement allows
+    EndTurn,    // Hand the turn to the next player; a new day starts after the last one
+    Fight       // Hero attacks the monster group objectId on an adjacent tile
+};
+
+struct GameCommand {
+    CommandType type;
+    PlayerID player;
+    uint16_t reserved;
+    HeroID hero;
+    uint32_t objectId;
+    Position target;
+
+    static GameCommand moveHero(PlayerID player, HeroID hero, const Position& target);
+    static GameCommand endTurn(PlayerID player);
+    static GameCommand fight(PlayerID player, HeroID hero, uint32_t objectId);
+};
+static_assert(std::is_trivially_copyable<GameCommand>::value, "commands must be plain data");
+
+enum class CommandStatus : uint8_t {
+    Ok,
+    NotYourTurn,
+    UnknownHero,
+    NotYourHero,
+    UnknownTarget,
+    Unreachable,
+    NoMovementLeft,
+    TooFar,
+    GameOver,
+    Busy            // Not applied: the game's command queue was full, retry later
+};
+
+const char* commandStatusName(CommandStatus status);
+
+// What a command did, for reporting back to players
+struct CommandOutcome {
+    CommandStatus status = CommandStatus::Ok;
+
+    // MoveHero / Fight
+    Position heroPosition;
+    int movementPoints = 0;
+    uint32_t claimedMine = 0;       // Mine taken over by walking onto it, 0 if none
+
+    // Fight
+    BattleResult battleResult = BattleResult::Flee;
+    int experienceGained = 0;
+    bool objectRemoved = false;     // The monster group was defeated and removed from the map
+
+    // EndTurn
+    PlayerID nextPlayer = 0;
+    bool newDay = false;
+
+    bool succeeded() const { return status == CommandStatus::Ok; }
+};
+
+// Applies commands to a GameState with the same rules for every caller (server, AI, replays).
+// Each battle draws from battleSeed's stream split by a running battle counter, so the same
+// command sequence on the same state always produces the same results, on any thread.
+class CommandProcessor {
+private:
+    GameState& state;
+    std::unique_ptr<Pathfinder> pathfinder;   // Created for the current map on first use
+    const GameMap* pathfinderMap;
+    Path path;
+    uint32_t battleSeed;
+    RandomStream battleStreams;
+    uint32_t battlesFought;
+
+public:
+    explicit CommandProcessor(GameState& gameState, uint32_t battleSeed = 1);
+
+    CommandOutcome apply(const GameCommand& command);
+
+    GameState& getState() { return state; }
+
+    // Position in the battle sequence, so a command log can resume it
+    uint32_t getBattleSeed() const { return battleSeed; }
+    uint32_t getBattlesFought() const { return battlesFought; }
+    void setBattlesFought(uint32_t count) { battlesFought = count; }
+
+private:
+    CommandOutcome moveHero(const GameCommand& command, Hero& hero);
+    CommandOutcome fight(const GameCommand& command, Hero& hero);
+    CommandOutcome endTurn();
+    Hero* findOwnedHero(const GameCommand& command, CommandOutcome& outcome);
+};
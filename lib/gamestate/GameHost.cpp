@@ -0,0 +1,152 @@
+#include "GameHost.h"
+#include <algorithm>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double millisecondsSince(Clock::time_point start, Clock::time_point end) {
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+const std::vector<AppliedCommand> noCommands;
+
+} // namespace
+
+HostedGame::HostedGame(GameID gameId, GameState& gameState, uint32_t battleSeed, size_t inboxCapacity)
+    : id(gameId), state(gameState), processor(gameState, battleSeed), inbox(inboxCapacity) {
+}
+
+CommandOutcome HostedGame::apply(const GameCommand& command, uint64_t tag) {
+    CommandOutcome outcome = processor.apply(command);
+    applied.push_back({ command, outcome, tag });
+    if (recorder) {
+        recorder->record(command, outcome);
+    }
+    return outcome;
+}
+
+void HostedGame::startRecording(const std::string& path, uint32_t checkpointInterval) {
+    recorder.reset();
+    recorder = std::make_unique<CommandLogWriter>(path, state, processor, checkpointInterval);
+}
+
+void HostedGame::stopRecording() {
+    recorder.reset();
+}
+
+GameHost::GameHost(unsigned threadCount, size_t inboxCapacity)
+    : pool(threadCount), inboxCapacity(inboxCapacity), nextGameId(1) {
+}
+
+GameID GameHost::addGame(std::unique_ptr<GameState> state, uint32_t battleSeed) {
+    if (!state) {
+        return 0;
+    }
+    auto game = std::make_unique<HostedGame>(nextGameId, *state, battleSeed, inboxCapacity);
+    game->ownedState = std::move(state);
+    return addHostedGame(std::move(game));
+}
+
+GameID GameHost::addGame(GameState& state, uint32_t battleSeed) {
+    return addHostedGame(std::make_unique<HostedGame>(nextGameId, state, battleSeed, inboxCapacity));
+}
+
+GameID GameHost::addHostedGame(std::unique_ptr<HostedGame> game) {
+    GameID id = nextGameId++;
+    gameOrder.push_back(game.get());
+    games[id] = std::move(game);
+    return id;
+}
+
+bool GameHost::removeGame(GameID id) {
+    auto it = games.find(id);
+    if (it == games.end()) {
+        return false;
+    }
+    gameOrder.erase(std::find(gameOrder.begin(), gameOrder.end(), it->second.get()));
+    activeGames.erase(std::remove(activeGames.begin(), activeGames.end(), id), activeGames.end());
+    games.erase(it);
+    return true;
+}
+
+HostedGame* GameHost::getGame(GameID id) {
+    auto it = games.find(id);
+    return it != games.end() ? it->second.get() : nullptr;
+}
+
+bool GameHost::submit(GameID id, const GameCommand& command, uint64_t tag) {
+    auto it = games.find(id);
+    if (it == games.end()) {
+        return false;
+    }
+    return it->second->inbox.tryPush({ command, tag });
+}
+
+void GameHost::tick() {
+    auto tickStart = Clock::now();
+    pool.parallelFor(gameOrder.size(), [this, tickStart](size_t index) {
+        runGame(*gameOrder[index], tickStart);
+    });
+    auto tickEnd = Clock::now();
+
+    activeGames.clear();
+    latencies.clear();
+    for (HostedGame* game : gameOrder) {
+        if (!game->applied.empty()) {
+            activeGames.push_back(game->id);
+        }
+        latencies.push_back(game->stats.lastLatencyMs);
+    }
+
+    double tickMs = millisecondsSince(tickStart, tickEnd);
+    stats.ticks++;
+    stats.lastTickMs = tickMs;
+    stats.maxTickMs = std::max(stats.maxTickMs, tickMs);
+    stats.totalTickMs += tickMs;
+    if (!latencies.empty()) {
+        auto percentile = [this](size_t percent) {
+            size_t rank = std::min(latencies.size() - 1, latencies.size() * percent / 100);
+            std::nth_element(latencies.begin(), latencies.begin() + rank, latencies.end());
+            return latencies[rank];
+        };
+        stats.lastLatencyP50Ms = percentile(50);
+        stats.lastLatencyP99Ms = percentile(99);
+        stats.lastLatencyMaxMs = *std::max_element(latencies.begin(), latencies.end());
+    }
+}
+
+void GameHost::runGame(HostedGame& game, Clock::time_point tickStart) {
+    auto start = Clock::now();
+
+    // At most one inbox worth per tick, so busy producers can't keep a game's tick running
+    game.applied.clear();
+    game.inbox.drain([&game](const HostedGame::PendingCommand& pending) {
+        game.apply(pending.command, pending.tag);
+    }, game.inbox.capacity());
+
+    if (turnHandler) {
+        turnHandler(game);
+    }
+    if (tickListener) {
+        tickListener(game);
+    }
+
+    auto end = Clock::now();
+    GameTickStats& stats = game.stats;
+    stats.ticks++;
+    stats.lastLatencyMs = millisecondsSince(tickStart, end);
+    stats.maxLatencyMs = std::max(stats.maxLatencyMs, stats.lastLatencyMs);
+    stats.totalLatencyMs += stats.lastLatencyMs;
+    stats.totalBusyMs += millisecondsSince(start, end);
+}
+
+const std::vector<AppliedCommand>& GameHost::getAppliedCommands(GameID id) const {
+    auto it = games.find(id);
+    return it != games.end() ? it->second->applied : noCommands;
+}
+
+const GameTickStats* GameHost::getGameStats(GameID id) const {
+    auto it = games.find(id);
+    return it != games.end() ? &it->second->stats : nullptr;
+}
@@ -0,0 +1,149 @@
+#pragma once
+
+#include "GameCommands.h"
+#include "CommandLog.h"
+#include "../core/MpscQueue.h"
+#include "../core/WorkStealingPool.h"
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+using GameID = uint32_t;
+
+// A command applied during a tick, with the tag it was submitted with (0 for turn handler commands)
+struct AppliedCommand {
+    GameCommand command;
+    CommandOutcome outcome;
+    uint64_t tag;
+};
+
+struct GameTickStats {
+    uint64_t ticks = 0;
+    double lastLatencyMs = 0;   // From the start of the host tick until this game was done
+    double maxLatencyMs = 0;
+    double totalLatencyMs = 0;
+    double totalBusyMs = 0;     // Time spent processing this game
+
+    double meanLatencyMs() const { return ticks ? totalLatencyMs / ticks : 0; }
+};
+
+struct HostTickStats {
+    uint64_t ticks = 0;
+    double lastTickMs = 0;      // Wall time of the whole tick
+    double maxTickMs = 0;
+    double totalTickMs = 0;
+    double lastLatencyP50Ms = 0;  // Per-game latency across the games of the last tick
+    double lastLatencyP99Ms = 0;
+    double lastLatencyMaxMs = 0;
+
+    double meanTickMs() const { return ticks ? totalTickMs / ticks : 0; }
+};
+
+// One game hosted by a GameHost. During a tick it is only touched by the worker running it.
+class HostedGame {
+private:
+    friend class GameHost;
+
+    struct PendingCommand {
+        GameCommand command;
+        uint64_t tag;
+    };
+
+    GameID id;
+    std::unique_ptr<GameState> ownedState;
+    GameState& state;
+    CommandProcessor processor;
+
+    MpscQueue<PendingCommand> inbox;         // Submitted since the last tick
+    std::vector<AppliedCommand> applied;     // Results of the last tick
+    GameTickStats stats;
+    std::unique_ptr<CommandLogWriter> recorder;   // Closed before the state goes away
+
+public:
+    HostedGame(GameID gameId, GameState& gameState, uint32_t battleSeed, size_t inboxCapacity);
+
+    GameID getId() const { return id; }
+    GameState& getState() { return state; }
+    const GameState& getState() const { return state; }
+
+    // Apply a command now and record it with the tick's results. For turn handlers.
+    CommandOutcome apply(const GameCommand& command, uint64_t tag = 0);
+
+    // Log every command applied from now on to path (see CommandLogWriter). Not during a tick.
+    // Throws std::runtime_error if the log cannot be created.
+    void startRecording(const std::string& path,
+                        uint32_t checkpointInterval = CommandLogWriter::DEFAULT_CHECKPOINT_INTERVAL);
+    void stopRecording();
+    const CommandLogWriter* getRecorder() const { return recorder.get(); }
+};
+
+// Runs many independent games in one process.
+//
+// Commands can be submitted for any game from any thread; they wait in the game's inbox, a
+// bounded lock-free queue, until the next tick(). A tick runs every game as one task on a
+// work-stealing pool: the game drains its inbox and applies the commands in order, then the turn
+// handler runs (computer players). Games share only
+// the immutable definition data, so load that (GameState::loadDefinitions) before hosting games.
+// Between ticks, games, their results and their stats may be read from the thread calling tick().
+class GameHost {
+public:
+    // Called on a worker after a game's commands were applied; may apply more through the game
+    using TurnHandler = std::function<void(HostedGame&)>;
+    // Called on a worker at the end of each game's tick
+    using TickListener = std::function<void(HostedGame&)>;
+
+    // Commands a game can have queued between two ticks
+    static const size_t DEFAULT_INBOX_CAPACITY = 256;
+
+private:
+    WorkStealingPool pool;
+    size_t inboxCapacity;
+    std::unordered_map<GameID, std::unique_ptr<HostedGame>> games;
+    std::vector<HostedGame*> gameOrder;       // Tick order, in order of addition
+    std::vector<GameID> activeGames;          // Games that applied commands in the last tick
+    GameID nextGameId;
+    TurnHandler turnHandler;
+    TickListener tickListener;
+    HostTickStats stats;
+    std::vector<double> latencies;            // Scratch for the per-tick percentiles
+
+public:
+    // threadCount 0 uses one worker per hardware core
+    explicit GameHost(unsigned threadCount = 0, size_t inboxCapacity = DEFAULT_INBOX_CAPACITY);
+
+    GameHost(const GameHost&) = delete;
+    GameHost& operator=(const GameHost&) = delete;
+
+    // Host a game; the second form does not take ownership. Not during a tick.
+    GameID addGame(std::unique_ptr<GameState> state, uint32_t battleSeed = 1);
+    GameID addGame(GameState& state, uint32_t battleSeed = 1);
+    bool removeGame(GameID id);
+
+    HostedGame* getGame(GameID id);
+    size_t getGameCount() const { return gameOrder.size(); }
+    unsigned getThreadCount() const { return pool.getThreadCount(); }
+
+    // Queue a command for the game's next tick. Safe from any thread, also during a tick, but
+    // not concurrently with addGame/removeGame. Returns false for unknown games and when the
+    // game's inbox is full; the caller should report CommandStatus::Busy or retry later.
+    bool submit(GameID id, const GameCommand& command, uint64_t tag = 0);
+
+    // Run every game once and wait for all of them
+    void tick();
+
+    // Commands applied by the last tick, per game
+    const std::vector<GameID>& getActiveGames() const { return activeGames; }
+    const std::vector<AppliedCommand>& getAppliedCommands(GameID id) const;
+
+    void setTurnHandler(TurnHandler handler) { turnHandler = std::move(handler); }
+    void setTickListener(TickListener listener) { tickListener = std::move(listener); }
+
+    const GameTickStats* getGameStats(GameID id) const;
+    const HostTickStats& getStats() const { return stats; }
+
+private:
+    GameID addHostedGame(std::unique_ptr<HostedGame> game);
+    void runGame(HostedGame& game, std::chrono::steady_clock::time_point tickStart);
+};
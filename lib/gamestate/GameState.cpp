@@ -1,16 +1,38 @@
 #include "GameState.h"
 #include <algorithm>
+#include <iostream>
+#include <mutex>
+
+namespace {
+
+// Movement resets are tiny: batches of heroes keep the per-task overhead below the work
+const size_t HEROES_PER_TASK = 256;
+
+} // namespace
+
+void Player::addHero(HeroID heroId) {
+    heroes.push_back(heroId);
+    dirty = true;
+    if (heroStore) {
+        heroStore->setOwner(heroId, id);
+    }
+}
 
 void Player::removeHero(HeroID heroId) {
     heroes.erase(std::remove(heroes.begin(), heroes.end(), heroId), heroes.end());
+    dirty = true;
+    if (heroStore) {
+        heroStore->releaseOwner(heroId, id);
+    }
 }
 
 void Player::removeTown(TownID townId) {
     towns.erase(std::remove(towns.begin(), towns.end(), townId), towns.end());
+    dirty = true;
 }
 
 Player::Player(PlayerID id, const std::string& name, Faction faction, bool human)
-    : id(id), name(name), faction(faction), isHuman(human), isActive(true) {
+    : id(id), name(name), faction(faction), isHuman(human), isActive(true), dirty(true), heroStore(nullptr) {
 }
 
 TurnManager::TurnManager() : currentPlayerIndex(0), turnNumber(1), dayNumber(1) {
@@ -46,9 +68,12 @@ void TurnManager::nextTurn() {
     dayNumber++;
 }
 
-std::map<CreatureID, std::unique_ptr<Creature>> GameState::creatureDatabase;
+std::shared_ptr<const CreatureDatabase> GameState::creatureDatabase;
+std::shared_ptr<const DefinitionStore> GameState::definitions;
 
-GameState::GameState() : gameRunning(false), gameWon(false), winner(0), difficulty(GameDifficulty::Normal) {
+GameState::GameState()
+    : dayPool(nullptr), difficulty(GameDifficulty::Normal), gameRunning(false), gameWon(false), winner(0) {
+    scheduleRecurringEvents();
 }
 
 GameState::~GameState() = default;
@@ -68,10 +93,14 @@ void GameState::startGame() {
     gameRunning = true;
     gameWon = false;
     
-    // Load creature database if not already loaded
-    if (creatureDatabase.empty()) {
-        loadCreatureDatabase();
-    }
+    // Fall back to the built-in creatures once per process if no definitions were loaded.
+    // call_once keeps games started on different threads from racing on the shared pointer.
+    static std::once_flag builtinCreaturesLoaded;
+    std::call_once(builtinCreaturesLoaded, []() {
+        if (!isCreatureDatabaseLoaded()) {
+            loadCreatureDatabase();
+        }
+    });
 }
 
 void GameState::endGame(PlayerID winnerPlayer) {
@@ -91,54 +120,127 @@ const Player* GameState::getPlayer(PlayerID id) const {
 }
 
 void GameState::addPlayer(std::unique_ptr<Player> player) {
-    if (player) {
-        players[player->getId()] = std::move(player);
+    if (!player) {
+        return;
+    }
+    
+    PlayerID playerId = player->getId();
+    auto replaced = players.find(playerId);
+    if (replaced != players.end()) {
+        for (HeroID heroId : replaced->second->getHeroes()) {
+            heroes.releaseOwner(heroId, playerId);
+        }
+        replaced->second->heroStore = nullptr;
+    }
+    
+    // From here on the player's hero list keeps the store's owners current
+    player->heroStore = &heroes;
+    for (HeroID heroId : player->getHeroes()) {
+        heroes.setOwner(heroId, playerId);
     }
+    players[playerId] = std::move(player);
 }
 
-Hero* GameState::getHero(HeroID id) {
-    auto it = heroes.find(id);
-    return (it != heroes.end()) ? it->second.get() : nullptr;
+HeroHandle GameState::addHero(std::unique_ptr<Hero> hero) {
+    if (!hero) {
+        return HeroHandle();
+    }
+    return heroes.add(std::move(*hero));
 }
 
-const Hero* GameState::getHero(HeroID id) const {
-    auto it = heroes.find(id);
-    return (it != heroes.end()) ? it->second.get() : nullptr;
+bool GameState::removeHero(HeroID id) {
+    const Hero* hero = heroes.find(id);
+    if (!hero) {
+        return false;
+    }
+    
+    if (gameMap) {
+        gameMap->moveHero(id, hero->getPosition(), Position(-1, -1, -1));
+    }
+    if (reachabilityCache) {
+        reachabilityCache->removeHero(id);
+    }
+    if (Player* owner = getPlayer(heroes.getOwner(id))) {
+        owner->removeHero(id);
+    }
+    return heroes.remove(id);
 }
 
-void GameState::addHero(std::unique_ptr<Hero> hero) {
-    if (hero) {
-        heroes[hero->getId()] = std::move(hero);
+void GameState::setMap(std::unique_ptr<GameMap> map) {
+    reachabilityCache.reset();
+    gameMap = std::move(map);
+    if (gameMap) {
+        reachabilityCache = std::make_unique<ReachabilityCache>(*gameMap);
     }
 }
 
-const Creature* GameState::getCreatureData(CreatureID id) {
-    auto it = creatureDatabase.find(id);
-    return (it != creatureDatabase.end()) ? it->second.get() : nullptr;
+void GameState::clearDirtyFlags() {
+    for (auto& [id, player] : players) {
+        player->clearDirty();
+    }
+    for (const auto& [id, hero] : heroes.all()) {
+        hero->clearDirty();
+    }
+    if (gameMap) {
+        gameMap->clearDirtyChunks();
+    }
 }
 
 void GameState::loadCreatureDatabase() {
+    std::vector<Creature> creatures;
+    
     // Create some basic creatures for testing
-    auto peasant = std::make_unique<Creature>(1, "Peasant", Faction::Castle, CreatureTier::Tier1);
-    peasant->setStats(1, 1, 1, 1, 1, 3);
-    peasant->setCost(Resources{});
-    peasant->setAiValue(15);
-    creatureDatabase[1] = std::move(peasant);
-    
-    auto archer = std::make_unique<Creature>(2, "Archer", Faction::Castle, CreatureTier::Tier2);
-    archer->setStats(6, 3, 2, 3, 10, 4);
-    archer->addAbility(CreatureAbility::Shooting);
+    Creature peasant(1, "Peasant", Faction::Castle, CreatureTier::Tier1);
+    peasant.setStats(1, 1, 1, 1, 1, 3);
+    peasant.setCost(Resources{});
+    peasant.setAiValue(15);
+    creatures.push_back(std::move(peasant));
+    
+    Creature archer(2, "Archer", Faction::Castle, CreatureTier::Tier2);
+    archer.setStats(6, 3, 2, 3, 10, 4);
+    archer.addAbility(CreatureAbility::Shooting);
     Resources archerCost;
     archerCost.gold = 100;
     archerCost.wood = 5;
-    archer->setCost(archerCost);
-    archer->setAiValue(126);
-    creatureDatabase[2] = std::move(archer);
+    archer.setCost(archerCost);
+    archer.setAiValue(126);
+    creatures.push_back(std::move(archer));
+    
+    creatureDatabase = std::make_shared<const CreatureDatabase>(std::move(creatures));
+}
+
+bool GameState::loadDefinitions(const std::string& definitionsPath) {
+    std::shared_ptr<const DefinitionStore> store;
+    try {
+        store = DefinitionStore::load(definitionsPath);
+    } catch (const std::exception& e) {
+        std::cerr << "Failed to load definitions: " << e.what() << std::endl;
+        return false;
+    }
+    
+    std::vector<Creature> creatures;
+    creatures.reserve(store->getCreatureCount());
+    for (size_t i = 0; i < store->getCreatureCount(); i++) {
+        creatures.push_back(store->getCreatures()[i].toCreature());
+    }
+    
+    creatureDatabase = std::make_shared<const CreatureDatabase>(std::move(creatures));
+    definitions = store;
+    return true;
 }
 
 void GameState::processDailyEvents() {
-    generateDailyResources();
-    resetHeroMovement();
+    scheduler.advanceTo(turnManager.getDayNumber());
+}
+
+void GameState::scheduleRecurringEvents() {
+    int today = turnManager.getDayNumber();
+    scheduler.reset(today);
+    
+    // Income and movement every day; weeks and months start on days 8, 15, ... and 29, 57, ...
+    scheduler.schedule(today + 1, [this](int) { processEndOfDay(); }, 1);
+    scheduler.schedule(today + 7 - (today + 6) % 7, [this](int) { processWeeklyEvents(); }, 7);
+    scheduler.schedule(today + 28 - (today + 27) % 28, [this](int) { processMonthlyEvents(); }, 28);
 }
 
 void GameState::processWeeklyEvents() {
@@ -149,31 +251,51 @@ void GameState::processMonthlyEvents() {
     // Monthly events would go here
 }
 
-void GameState::generateDailyResources() {
+void GameState::processEndOfDay() {
+    std::vector<Player*> dayPlayers;
+    dayPlayers.reserve(players.size());
     for (auto& [playerId, player] : players) {
-        Resources dailyIncome;
-        dailyIncome.gold = 1000; // Base daily gold income
-        
-        // Add income from controlled mines
-        if (gameMap) {
-            // This is a simplified approach - in a full implementation,
-            // we'd track owned objects more efficiently
-            for (auto& obj : gameMap->getAllObjects()) {
-                if (obj->getType() == ObjectType::Mine) {
-                    ResourceMine* mine = static_cast<ResourceMine*>(obj.get());
-                    if (mine->getOwner() == playerId) {
-                        dailyIncome[mine->getResourceType()] += mine->getDailyProduction();
-                    }
-                }
+        dayPlayers.push_back(player.get());
+    }
+    
+    // One task per player, then one per batch of hero slots. A player's task only reads the map's
+    // income ledger and a hero's only touches that hero and its own slot, so none share state.
+    std::vector<Resources> income(dayPlayers.size());
+    size_t slotCount = heroes.getSlotCount();
+    size_t heroBatches = (slotCount + HEROES_PER_TASK - 1) / HEROES_PER_TASK;
+    auto task = [&](size_t index) {
+        if (index < dayPlayers.size()) {
+            Resources dailyIncome;
+            dailyIncome.gold = 1000; // Base daily gold income
+            
+            // Add income from controlled mines, tallied by the map as they change hands
+            if (gameMap) {
+                dailyIncome = dailyIncome + gameMap->getMineIncome(dayPlayers[index]->getId());
             }
+            income[index] = dailyIncome;
+            return;
         }
         
-        player->addResources(dailyIncome);
+        size_t first = (index - dayPlayers.size()) * HEROES_PER_TASK;
+        size_t last = std::min(first + HEROES_PER_TASK, slotCount);
+        for (size_t slot = first; slot < last; slot++) {
+            if (Hero* hero = heroes.getSlot(slot)) {
+                hero->resetMovementPoints();
+            }
+        }
+    };
+    
+    size_t taskCount = dayPlayers.size() + heroBatches;
+    if (dayPool) {
+        dayPool->parallelFor(taskCount, task);
+    } else {
+        for (size_t index = 0; index < taskCount; index++) {
+            task(index);
+        }
     }
-}
-
-void GameState::resetHeroMovement() {
-    for (auto& [id, hero] : heroes) {
-        hero->resetMovementPoints();
+    
+    // Merged in player id order
+    for (size_t i = 0; i < dayPlayers.size(); i++) {
+        dayPlayers[i]->addResources(income[i]);
     }
-}
\ No newline at end of file
+}
@@ -1,8 +1,13 @@
 #pragma once
 
 #include "../../include/GameTypes.h"
-#include "../entities/hero/Hero.h"
+#include "../entities/hero/HeroStore.h"
+#include "../entities/creature/CreatureDatabase.h"
+#include "../data/Definitions.h"
 #include "../map/GameMap.h"
+#include "../map/Reachability.h"
+#include "EventScheduler.h"
+#include "../core/ThreadPool.h"
 #include <vector>
 #include <map>
 #include <memory>
@@ -16,6 +21,9 @@ enum class GameDifficulty {
 };
 
 class Player {
+    friend class SaveGame;
+    friend class GameState;
+    
 private:
     PlayerID id;
     std::string name;
@@ -25,6 +33,8 @@ private:
     std::vector<TownID> towns;
     bool isHuman;
     bool isActive;
+    bool dirty;  // Set by every mutation; cleared when a full snapshot has been taken
+    HeroStore* heroStore;  // Set while the player is registered with a game; told about hero changes
     
 public:
     Player(PlayerID id, const std::string& name, Faction faction, bool human = true);
@@ -35,25 +45,32 @@ public:
     Faction getFaction() const { return faction; }
     bool isHumanPlayer() const { return isHuman; }
     bool isActivePlayer() const { return isActive; }
-    void setActive(bool active) { isActive = active; }
+    void setActive(bool active) { isActive = active; dirty = true; }
     
     // Resources
-    Resources& getResources() { return resources; }
+    Resources& getResources() { dirty = true; return resources; }  // Mutable access counts as a change
     const Resources& getResources() const { return resources; }
-    void addResources(const Resources& res) { resources = resources + res; }
+    void addResources(const Resources& res) { resources = resources + res; dirty = true; }
     bool canAfford(const Resources& cost) const { return resources.canAfford(cost); }
-    void spendResources(const Resources& cost) { resources = resources - cost; }
+    void spendResources(const Resources& cost) { resources = resources - cost; dirty = true; }
     
     // Heroes and towns
     const std::vector<HeroID>& getHeroes() const { return heroes; }
     const std::vector<TownID>& getTowns() const { return towns; }
-    void addHero(HeroID heroId) { heroes.push_back(heroId); }
-    void addTown(TownID townId) { towns.push_back(townId); }
+    void addHero(HeroID heroId);
+    void addTown(TownID townId) { towns.push_back(townId); dirty = true; }
     void removeHero(HeroID heroId);
     void removeTown(TownID townId);
+    
+    // Change tracking for incremental saves
+    bool isDirty() const { return dirty; }
+    void markDirty() { dirty = true; }
+    void clearDirty() { dirty = false; }
 };
 
 class TurnManager {
+    friend class SaveGame;
+    
 private:
     std::vector<PlayerID> playerOrder;
     int currentPlayerIndex;
@@ -75,21 +92,27 @@ public:
 };
 
 class GameState {
+    friend class SaveGame;
+    
 private:
     // Core game data
-    std::map<HeroID, std::unique_ptr<Hero>> heroes;
+    HeroStore heroes;
     std::map<PlayerID, std::unique_ptr<Player>> players;
     std::unique_ptr<GameMap> gameMap;
+    std::unique_ptr<ReachabilityCache> reachabilityCache;  // Declared after gameMap, it listens to it
     
     // Game flow
     TurnManager turnManager;
+    EventScheduler scheduler;  // Keyed by TurnManager's day number
+    ThreadPool* dayPool;       // Not owned; null runs end-of-day work on the calling thread
     GameDifficulty difficulty;
     bool gameRunning;
     bool gameWon;
     PlayerID winner;
     
-    // Static data repositories
-    static std::map<CreatureID, std::unique_ptr<Creature>> creatureDatabase;
+    // Static data repositories (immutable once published, shared read-only across threads)
+    static std::shared_ptr<const CreatureDatabase> creatureDatabase;
+    static std::shared_ptr<const DefinitionStore> definitions;
     
 public:
     GameState();
@@ -108,37 +131,87 @@ public:
     PlayerID getCurrentPlayer() const { return turnManager.getCurrentPlayer(); }
     void nextTurn() { turnManager.nextTurn(); }
     
+    // Day events. Systems schedule callbacks for the day they are due; processDailyEvents() runs
+    // whatever has come due up to the current day, the recurring daily, weekly and monthly events
+    // included. Scheduled callbacks are not saved: a loaded game starts with only the recurring ones.
+    EventScheduler& getScheduler() { return scheduler; }
+    const EventScheduler& getScheduler() const { return scheduler; }
+    
+    // Run end-of-day work as per-player and per-hero tasks on pool (null: on the calling thread).
+    // The pool must outlive the state. Results are merged in id order, so the game comes out
+    // the same with or without one.
+    void setThreadPool(ThreadPool* pool) { dayPool = pool; }
+    ThreadPool* getThreadPool() const { return dayPool; }
+    
     // Players
     Player* getPlayer(PlayerID id);
     const Player* getPlayer(PlayerID id) const;
     void addPlayer(std::unique_ptr<Player> player);
     const std::map<PlayerID, std::unique_ptr<Player>>& getAllPlayers() const { return players; }
     
-    // Heroes
-    Hero* getHero(HeroID id);
-    const Hero* getHero(HeroID id) const;
-    void addHero(std::unique_ptr<Hero> hero);
-    const std::map<HeroID, std::unique_ptr<Hero>>& getAllHeroes() const { return heroes; }
+    // Heroes. Handles stay valid while the hero is stored; ids are looked up by binary search.
+    Hero* getHero(HeroID id) { return heroes.find(id); }
+    const Hero* getHero(HeroID id) const { return heroes.find(id); }
+    Hero* getHero(HeroHandle handle) { return heroes.get(handle); }
+    const Hero* getHero(HeroHandle handle) const { return heroes.get(handle); }
+    HeroHandle getHeroHandle(HeroID id) const { return heroes.getHandle(id); }
+    HeroHandle addHero(std::unique_ptr<Hero> hero);
+    // Takes the hero off the map and out of its owner's list as well
+    bool removeHero(HeroID id);
+    
+    // Iteration in id order, as (id, hero) pairs
+    HeroStore::Range<Hero> getAllHeroes() { return heroes.all(); }
+    HeroStore::Range<const Hero> getAllHeroes() const { return heroes.all(); }
+    HeroStore::Range<Hero> getHeroesOf(PlayerID owner) { return heroes.ownedBy(owner); }
+    HeroStore::Range<const Hero> getHeroesOf(PlayerID owner) const { return heroes.ownedBy(owner); }
+    PlayerID getHeroOwner(HeroID id) const { return heroes.getOwner(id); }
+    
+    // Heroes standing inside area on level z, in id order
+    void findHeroesInRegion(const Rect& area, int z, std::vector<HeroHandle>& found) const {
+        heroes.findInRegion(area, z, found);
+    }
+    
+    // The store itself, for sweeps over its slots and hot field arrays
+    HeroStore& getHeroStore() { return heroes; }
+    const HeroStore& getHeroStore() const { return heroes; }
     
     // Map
     GameMap* getMap() { return gameMap.get(); }
     const GameMap* getMap() const { return gameMap.get(); }
-    void setMap(std::unique_ptr<GameMap> map) { gameMap = std::move(map); }
+    void setMap(std::unique_ptr<GameMap> map);
+    
+    // Clear the change flags on players, heroes and map tiles once a full snapshot has been taken
+    void clearDirtyFlags();
+    
+    // Per-hero reachable tiles, this turn's or within a movement budget (null until a map is set).
+    // AdventureAI keeps its heroes' search floods here.
+    ReachabilityCache* getReachabilityCache() { return reachabilityCache.get(); }
     
     // Static creature database
-    static const Creature* getCreatureData(CreatureID id);
+    static const Creature* getCreatureData(CreatureID id) {
+        return creatureDatabase ? creatureDatabase->get(id) : nullptr;
+    }
     static void loadCreatureDatabase();
+    static bool isCreatureDatabaseLoaded() { return creatureDatabase && !creatureDatabase->empty(); }
+    static std::shared_ptr<const CreatureDatabase> getCreatureDatabase() { return creatureDatabase; }
+    
+    // Data-driven definitions (creatures, hero classes, map objects); replaces the built-in creatures.
+    // Returns false and keeps the current data if the file cannot be loaded. Call before games
+    // are started on other threads; the loaded data is then shared read-only by all of them.
+    static bool loadDefinitions(const std::string& definitionsPath);
+    static std::shared_ptr<const DefinitionStore> getDefinitions() { return definitions; }
     
     // Game settings
     GameDifficulty getDifficulty() const { return difficulty; }
     void setDifficulty(GameDifficulty diff) { difficulty = diff; }
     
-    // Daily/weekly events
+    // Runs the events due up to the current day; call once the day has advanced
     void processDailyEvents();
-    void processWeeklyEvents();
-    void processMonthlyEvents();
     
 private:
-    void generateDailyResources();
-    void resetHeroMovement();
+    // Restart the scheduler at the current day with the recurring daily, weekly and monthly events
+    void scheduleRecurringEvents();
+    void processWeeklyEvents();
+    void processMonthlyEvents();
+    void processEndOfDay();
 };
\ No newline at end of file
@@ -0,0 +1,547 @@
+#include "SaveGame.h"
+#include "../data/MappedFile.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+
+struct SaveHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t snapshotId;       // Ties deltas to the snapshot they were taken against
+    int32_t width;             // 0 when the state has no map
+    int32_t height;
+    int32_t levels;
+    uint32_t tileSize;         // sizeof(MapTile) when written, guards against layout changes
+    uint64_t stateOffset;
+    uint64_t stateSize;
+    uint64_t tileOffset;
+};
+
+struct DeltaHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t baseSnapshotId;
+    int32_t width;
+    int32_t height;
+    int32_t levels;
+    uint32_t tileSize;
+    uint64_t stateSize;        // State section follows the header, then chunkCount tile chunks
+    uint32_t chunkCount;
+    uint32_t reserved;
+};
+
+const char SAVE_MAGIC[4] = { 'R', 'S', 'A', 'V' };
+const char DELTA_MAGIC[4] = { 'R', 'D', 'L', 'T' };
+const size_t TILE_ALIGNMENT = 4096;  // Page aligned, so copy-on-write faults only touch tile pages
+
+enum class ObjectRecord : uint8_t {
+    Generic,
+    Mine,
+    Monster
+};
+
+// Resources are stored as their seven amounts, without the in-memory padding lane
+void writeResources(BinaryWriter& out, const Resources& resources) {
+    for (int i = 0; i < Resources::TYPE_COUNT; i++) {
+        out.write(static_cast<int32_t>(resources.lanes[i]));
+    }
+}
+
+Resources readResources(BinaryReader& in) {
+    Resources resources;
+    for (int i = 0; i < Resources::TYPE_COUNT; i++) {
+        resources.lanes[i] = in.read<int32_t>();
+    }
+    return resources;
+}
+
+void writePadding(std::ofstream& file, size_t count) {
+    static const char zeros[256] = {};
+    while (count > 0) {
+        size_t chunk = count < sizeof(zeros) ? count : sizeof(zeros);
+        file.write(zeros, static_cast<std::streamsize>(chunk));
+        count -= chunk;
+    }
+}
+
+uint64_t generateSnapshotId() {
+    static std::atomic<uint64_t> counter(0);
+    uint64_t now = static_cast<uint64_t>(std::chrono::system_clock::now().time_since_epoch().count());
+    return now ^ (++counter << 48);
+}
+
+} // namespace
+
+void SaveSnapshot::write(const std::string& path) const {
+    std::string tempPath = path + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            throw std::runtime_error("Failed to create save file: " + tempPath);
+        }
+
+        file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        if (!tiles.empty()) {
+            // The tile planes are already contiguous and row-major, one level after another
+            writePadding(file, tileOffset - bytes.size());
+            file.write(reinterpret_cast<const char*>(tiles.data()),
+                       static_cast<std::streamsize>(tiles.size() * sizeof(MapTile)));
+        }
+
+        if (!file) {
+            file.close();
+            std::remove(tempPath.c_str());
+            throw std::runtime_error("Failed to write save file: " + tempPath);
+        }
+    }
+
+    if (std::rename(tempPath.c_str(), path.c_str()) != 0) {
+        std::remove(tempPath.c_str());
+        throw std::runtime_error("Failed to replace save file: " + path);
+    }
+}
+
+void SaveGame::save(const GameState& state, const std::string& path) {
+    captureFull(state).write(path);
+}
+
+SaveSnapshot SaveGame::captureFull(const GameState& state) {
+    BinaryWriter out;
+    writeState(out, state, false);
+
+    const GameMap* map = state.gameMap.get();
+    SaveHeader header = {};
+    std::memcpy(header.magic, SAVE_MAGIC, sizeof(header.magic));
+    header.version = FORMAT_VERSION;
+    header.snapshotId = generateSnapshotId();
+    header.tileSize = sizeof(MapTile);
+    header.stateOffset = sizeof(SaveHeader);
+    header.stateSize = out.getSize();
+
+    SaveSnapshot snapshot;
+    snapshot.snapshotId = header.snapshotId;
+    if (map) {
+        header.width = map->getWidth();
+        header.height = map->getHeight();
+        header.levels = map->getLevels();
+
+        size_t stateEnd = sizeof(SaveHeader) + out.getSize();
+        header.tileOffset = (stateEnd + TILE_ALIGNMENT - 1) / TILE_ALIGNMENT * TILE_ALIGNMENT;
+        snapshot.tileOffset = header.tileOffset;
+        snapshot.tiles.assign(map->getTileData(), map->getTileData() + map->getTileCount());
+    }
+
+    snapshot.bytes.resize(sizeof(SaveHeader));
+    std::memcpy(snapshot.bytes.data(), &header, sizeof(header));
+    snapshot.bytes.insert(snapshot.bytes.end(), out.getBytes().begin(), out.getBytes().end());
+    return snapshot;
+}
+
+SaveSnapshot SaveGame::captureDelta(const GameState& state, uint64_t baseSnapshotId) {
+    BinaryWriter out;
+    writeState(out, state, true);
+
+    DeltaHeader header = {};
+    std::memcpy(header.magic, DELTA_MAGIC, sizeof(header.magic));
+    header.version = FORMAT_VERSION;
+    header.baseSnapshotId = baseSnapshotId;
+    header.tileSize = sizeof(MapTile);
+    header.stateSize = out.getSize();
+
+    const GameMap* map = state.gameMap.get();
+    if (map) {
+        header.width = map->getWidth();
+        header.height = map->getHeight();
+        header.levels = map->getLevels();
+
+        const int chunkSize = GameMap::TILE_CHUNK_SIZE;
+        for (int z = 0; z < map->getLevels(); z++) {
+            for (int chunkY = 0; chunkY < map->getChunksY(); chunkY++) {
+                for (int chunkX = 0; chunkX < map->getChunksX(); chunkX++) {
+                    size_t chunkIndex = map->getChunkIndex(chunkX, chunkY, z);
+                    if (!map->isChunkDirty(chunkIndex)) {
+                        continue;
+                    }
+
+                    out.write(static_cast<uint32_t>(chunkIndex));
+                    int x0 = chunkX * chunkSize;
+                    int x1 = std::min(x0 + chunkSize, map->getWidth());
+                    int y1 = std::min(chunkY * chunkSize + chunkSize, map->getHeight());
+                    for (int y = chunkY * chunkSize; y < y1; y++) {
+                        const MapTile* row = &map->getTileUnchecked(x0, y, z);
+                        for (int x = x0; x < x1; x++) {
+                            out.write(row[x - x0]);
+                        }
+                    }
+                    header.chunkCount++;
+                }
+            }
+        }
+    }
+
+    SaveSnapshot snapshot;
+    snapshot.snapshotId = baseSnapshotId;
+    snapshot.delta = true;
+    snapshot.bytes.resize(sizeof(DeltaHeader));
+    std::memcpy(snapshot.bytes.data(), &header, sizeof(header));
+    snapshot.bytes.insert(snapshot.bytes.end(), out.getBytes().begin(), out.getBytes().end());
+    return snapshot;
+}
+
+std::unique_ptr<GameState> SaveGame::load(const std::string& path) {
+    return load(path, "");
+}
+
+std::unique_ptr<GameState> SaveGame::load(const std::string& path, const std::string& deltaPath) {
+    auto file = std::make_shared<MappedFile>();
+    if (!file->open(path, true)) {
+        throw std::runtime_error("Failed to open save file: " + path);
+    }
+
+    const uint8_t* data = file->getData();
+    size_t size = file->getSize();
+
+    SaveHeader header;
+    if (size < sizeof(header)) {
+        throw std::runtime_error("Not a save file: " + path);
+    }
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, SAVE_MAGIC, sizeof(header.magic)) != 0) {
+        throw std::runtime_error("Not a save file: " + path);
+    }
+    if (header.version != FORMAT_VERSION || header.tileSize != sizeof(MapTile)) {
+        throw std::runtime_error("Unsupported save file version: " + path);
+    }
+    if (header.stateOffset > size || header.stateSize > size - header.stateOffset) {
+        throw std::runtime_error("Truncated save file: " + path);
+    }
+
+    // A delta only applies to the exact snapshot it was taken against
+    MappedFile deltaFile;
+    DeltaHeader delta = {};
+    bool applyDelta = false;
+    if (!deltaPath.empty() && deltaFile.open(deltaPath) && deltaFile.getSize() >= sizeof(delta)) {
+        std::memcpy(&delta, deltaFile.getData(), sizeof(delta));
+        applyDelta = std::memcmp(delta.magic, DELTA_MAGIC, sizeof(delta.magic)) == 0 &&
+                     delta.version == FORMAT_VERSION &&
+                     delta.baseSnapshotId == header.snapshotId &&
+                     delta.width == header.width && delta.height == header.height &&
+                     delta.levels == header.levels && delta.tileSize == header.tileSize;
+        if (applyDelta && delta.stateSize > deltaFile.getSize() - sizeof(delta)) {
+            throw std::runtime_error("Truncated save delta: " + deltaPath);
+        }
+    }
+
+    auto state = std::make_unique<GameState>();
+
+    auto readTurnState = [&state](BinaryReader& in) {
+        state->difficulty = static_cast<GameDifficulty>(in.read<uint8_t>());
+        state->gameRunning = in.read<uint8_t>() != 0;
+        state->gameWon = in.read<uint8_t>() != 0;
+        state->winner = in.read<PlayerID>();
+
+        TurnManager& turns = state->turnManager;
+        turns.playerOrder = in.readArray<PlayerID>();
+        turns.currentPlayerIndex = in.read<int32_t>();
+        turns.turnNumber = in.read<int32_t>();
+        turns.dayNumber = in.read<int32_t>();
+        if (turns.currentPlayerIndex < 0 ||
+            (!turns.playerOrder.empty() && turns.currentPlayerIndex >= static_cast<int>(turns.playerOrder.size()))) {
+            throw std::runtime_error("Invalid current player");
+        }
+    };
+
+    // Records are keyed by id; a delta lists every id and carries records only for the dirty ones
+    auto readRecords = [](BinaryReader& in, auto readRecord, auto& records) {
+        using Id = typename std::decay_t<decltype(records)>::key_type;
+        std::decay_t<decltype(records)> current;
+        uint32_t count = in.read<uint32_t>();
+        for (uint32_t i = 0; i < count; i++) {
+            Id id = in.read<Id>();
+            if (in.read<uint8_t>() != 0) {
+                current[id] = readRecord(in);
+            } else {
+                auto previous = records.find(id);
+                if (previous == records.end()) {
+                    throw std::runtime_error("Delta refers to a missing record");
+                }
+                current[id] = std::move(previous->second);
+            }
+        }
+        records = std::move(current);
+    };
+
+    std::string source = path;
+    try {
+        BinaryReader in(data + header.stateOffset, header.stateSize);
+        std::map<PlayerID, std::unique_ptr<Player>> players;
+        std::map<HeroID, std::unique_ptr<Hero>> heroes;
+
+        readTurnState(in);
+        readRecords(in, readPlayer, players);
+        readRecords(in, readHero, heroes);
+
+        // With a delta, turn state, records and objects come from the delta instead
+        BinaryReader deltaIn(applyDelta ? deltaFile.getData() + sizeof(delta) : nullptr,
+                             applyDelta ? delta.stateSize : 0);
+        if (applyDelta) {
+            source = deltaPath;
+            readTurnState(deltaIn);
+            readRecords(deltaIn, readPlayer, players);
+            readRecords(deltaIn, readHero, heroes);
+        }
+        BinaryReader& mapIn = applyDelta ? deltaIn : in;
+
+        for (auto& [id, player] : players) {
+            state->addPlayer(std::move(player));
+        }
+        for (auto& [id, hero] : heroes) {
+            state->addHero(std::move(hero));
+        }
+
+        if (header.width > 0) {
+            auto map = std::make_unique<GameMap>(header.width, header.height, header.levels,
+                                                 file, static_cast<size_t>(header.tileOffset));
+            map->setName(mapIn.readString());
+            map->setDescription(mapIn.readString());
+
+            uint32_t objectCount = mapIn.read<uint32_t>();
+            for (uint32_t i = 0; i < objectCount; i++) {
+                map->restoreObject(readObject(mapIn));
+            }
+
+            if (applyDelta) {
+                // Chunk records follow the state section; copying them in only touches their pages
+                BinaryReader chunks(deltaFile.getData() + sizeof(delta) + delta.stateSize,
+                                    deltaFile.getSize() - sizeof(delta) - delta.stateSize);
+                const int chunkSize = GameMap::TILE_CHUNK_SIZE;
+                for (uint32_t i = 0; i < delta.chunkCount; i++) {
+                    uint32_t chunkIndex = chunks.read<uint32_t>();
+                    if (chunkIndex >= map->getChunkCount()) {
+                        throw std::runtime_error("Invalid tile chunk");
+                    }
+                    int chunkX = static_cast<int>(chunkIndex % map->getChunksX());
+                    int chunkY = static_cast<int>(chunkIndex / map->getChunksX() % map->getChunksY());
+                    int z = static_cast<int>(chunkIndex / map->getChunksX() / map->getChunksY());
+                    int x0 = chunkX * chunkSize;
+                    int x1 = std::min(x0 + chunkSize, map->getWidth());
+                    int y1 = std::min(chunkY * chunkSize + chunkSize, map->getHeight());
+                    for (int y = chunkY * chunkSize; y < y1; y++) {
+                        MapTile* row = &map->getTileUnchecked(x0, y, z);
+                        for (int x = x0; x < x1; x++) {
+                            row[x - x0] = chunks.read<MapTile>();
+                        }
+                    }
+                }
+            }
+            state->setMap(std::move(map));
+        }
+    } catch (const std::runtime_error& e) {
+        throw std::runtime_error("Corrupt save file " + source + ": " + e.what());
+    }
+
+    // Recurring day events pick up from the saved day; one-off scheduled callbacks are not saved
+    state->scheduleRecurringEvents();
+
+    // The loaded state matches what is on disk
+    state->clearDirtyFlags();
+    return state;
+}
+
+void SaveGame::writeState(BinaryWriter& out, const GameState& state, bool dirtyOnly) {
+    // Game flow
+    out.write(static_cast<uint8_t>(state.difficulty));
+    out.write(static_cast<uint8_t>(state.gameRunning));
+    out.write(static_cast<uint8_t>(state.gameWon));
+    out.write(state.winner);
+
+    const TurnManager& turns = state.turnManager;
+    out.writeArray(turns.playerOrder);
+    out.write(static_cast<int32_t>(turns.currentPlayerIndex));
+    out.write(static_cast<int32_t>(turns.turnNumber));
+    out.write(static_cast<int32_t>(turns.dayNumber));
+
+    out.write(static_cast<uint32_t>(state.players.size()));
+    for (const auto& [id, player] : state.players) {
+        bool present = !dirtyOnly || player->isDirty();
+        out.write(id);
+        out.write(static_cast<uint8_t>(present));
+        if (present) {
+            writePlayer(out, *player);
+        }
+    }
+
+    out.write(static_cast<uint32_t>(state.heroes.size()));
+    for (const auto& [id, hero] : state.heroes.all()) {
+        bool present = !dirtyOnly || hero->isDirty();
+        out.write(id);
+        out.write(static_cast<uint8_t>(present));
+        if (present) {
+            writeHero(out, *hero);
+        }
+    }
+
+    // Objects are few compared to tiles and are always written in full
+    if (const GameMap* map = state.gameMap.get()) {
+        out.writeString(map->getName());
+        out.writeString(map->getDescription());
+        out.write(static_cast<uint32_t>(map->getAllObjects().size()));
+        for (const auto& object : map->getAllObjects()) {
+            writeObject(out, *object);
+        }
+    }
+}
+
+void SaveGame::writePlayer(BinaryWriter& out, const Player& player) {
+    out.write(player.id);
+    out.writeString(player.name);
+    out.write(static_cast<uint8_t>(player.faction));
+    writeResources(out, player.resources);
+    out.writeArray(player.heroes);
+    out.writeArray(player.towns);
+    out.write(static_cast<uint8_t>(player.isHuman));
+    out.write(static_cast<uint8_t>(player.isActive));
+}
+
+std::unique_ptr<Player> SaveGame::readPlayer(BinaryReader& in) {
+    PlayerID id = in.read<PlayerID>();
+    std::string name = in.readString();
+    Faction faction = static_cast<Faction>(in.read<uint8_t>());
+    auto player = std::make_unique<Player>(id, name, faction);
+    player->resources = readResources(in);
+    player->heroes = in.readArray<HeroID>();
+    player->towns = in.readArray<TownID>();
+    player->isHuman = in.read<uint8_t>() != 0;
+    player->isActive = in.read<uint8_t>() != 0;
+    return player;
+}
+
+void SaveGame::writeHero(BinaryWriter& out, const Hero& hero) {
+    out.write(hero.id);
+    out.writeString(hero.name);
+    out.write(static_cast<uint8_t>(hero.heroClass));
+    out.write(static_cast<uint8_t>(hero.gender));
+    out.write(hero.position);
+    out.write(static_cast<int32_t>(hero.movementPoints));
+    out.write(static_cast<int32_t>(hero.maxMovementPoints));
+    out.write(static_cast<int32_t>(hero.attack));
+    out.write(static_cast<int32_t>(hero.defense));
+    out.write(static_cast<int32_t>(hero.spellPower));
+    out.write(static_cast<int32_t>(hero.knowledge));
+
+    out.write(static_cast<uint32_t>(hero.skills.size()));
+    for (const auto& [skill, level] : hero.skills) {
+        out.write(static_cast<uint8_t>(skill));
+        out.write(static_cast<int32_t>(level));
+    }
+
+    out.writeArray(hero.knownSpells);
+    out.write(static_cast<int32_t>(hero.mana));
+    out.write(static_cast<int32_t>(hero.maxMana));
+
+    for (int slot = 0; slot < Army::MAX_SLOTS; slot++) {
+        out.write(hero.army.getSlot(slot));
+    }
+    out.writeArray(hero.artifacts);
+    out.write(static_cast<int32_t>(hero.experience));
+    out.write(static_cast<int32_t>(hero.level));
+}
+
+std::unique_ptr<Hero> SaveGame::readHero(BinaryReader& in) {
+    HeroID id = in.read<HeroID>();
+    std::string name = in.readString();
+    HeroClass heroClass = static_cast<HeroClass>(in.read<uint8_t>());
+    Gender gender = static_cast<Gender>(in.read<uint8_t>());
+    auto hero = std::make_unique<Hero>(id, name, heroClass, gender);
+
+    // Restore the stored values as-is rather than recomputing derived ones
+    hero->position = in.read<Position>();
+    hero->movementPoints = in.read<int32_t>();
+    hero->maxMovementPoints = in.read<int32_t>();
+    hero->attack = in.read<int32_t>();
+    hero->defense = in.read<int32_t>();
+    hero->spellPower = in.read<int32_t>();
+    hero->knowledge = in.read<int32_t>();
+
+    uint32_t skillCount = in.read<uint32_t>();
+    for (uint32_t i = 0; i < skillCount; i++) {
+        SkillType skill = static_cast<SkillType>(in.read<uint8_t>());
+        hero->skills[skill] = in.read<int32_t>();
+    }
+
+    hero->knownSpells = in.readArray<SpellID>();
+    hero->mana = in.read<int32_t>();
+    hero->maxMana = in.read<int32_t>();
+
+    for (int slot = 0; slot < Army::MAX_SLOTS; slot++) {
+        hero->army.getSlot(slot) = in.read<ArmySlot>();
+    }
+    hero->artifacts = in.readArray<ArtifactID>();
+    hero->experience = in.read<int32_t>();
+    hero->level = in.read<int32_t>();
+    return hero;
+}
+
+void SaveGame::writeObject(BinaryWriter& out, const MapObject& object) {
+    const ResourceMine* mine = dynamic_cast<const ResourceMine*>(&object);
+    const MonsterGroup* monster = dynamic_cast<const MonsterGroup*>(&object);
+
+    if (mine) {
+        out.write(ObjectRecord::Mine);
+    } else if (monster) {
+        out.write(ObjectRecord::Monster);
+    } else {
+        out.write(ObjectRecord::Generic);
+    }
+
+    out.write(object.getId());
+    out.write(object.getType());
+    out.write(object.getPosition());
+    out.write(static_cast<uint8_t>(object.blocksMovement()));
+
+    if (mine) {
+        out.write(static_cast<uint8_t>(mine->getResourceType()));
+        out.write(static_cast<int32_t>(mine->getDailyProduction()));
+        out.write(mine->getOwner());
+    } else if (monster) {
+        out.write(monster->getCreatureType());
+        out.write(static_cast<int32_t>(monster->getCount()));
+        out.write(static_cast<uint8_t>(monster->getNeverFlees()));
+        writeResources(out, monster->getReward());
+    }
+}
+
+std::unique_ptr<MapObject> SaveGame::readObject(BinaryReader& in) {
+    ObjectRecord record = in.read<ObjectRecord>();
+    uint32_t id = in.read<uint32_t>();
+    ObjectType type = in.read<ObjectType>();
+    Position position = in.read<Position>();
+    bool blocks = in.read<uint8_t>() != 0;
+
+    switch (record) {
+        case ObjectRecord::Mine: {
+            ResourceType resource = static_cast<ResourceType>(in.read<uint8_t>());
+            int production = in.read<int32_t>();
+            auto mine = std::make_unique<ResourceMine>(id, position, resource, production);
+            mine->setOwner(in.read<PlayerID>());
+            return mine;
+        }
+        case ObjectRecord::Monster: {
+            CreatureID creature = in.read<CreatureID>();
+            int count = in.read<int32_t>();
+            auto monster = std::make_unique<MonsterGroup>(id, position, creature, count);
+            monster->setNeverFlees(in.read<uint8_t>() != 0);
+            monster->setReward(readResources(in));
+            return monster;
+        }
+        case ObjectRecord::Generic:
+            return std::make_unique<MapObject>(id, type, position, blocks);
+    }
+    throw std::runtime_error("Unknown object record");
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "GameState.h"
+#include "../data/BinaryStream.h"
+#include <memory>
+#include <string>
+
+// A save captured in memory. Writing it needs no access to the GameState, so it can be handed
+// to another thread while the game carries on.
+class SaveSnapshot {
+    friend class SaveGame;
+
+private:
+    std::vector<uint8_t> bytes;   // Header and state section (and tile chunks, for deltas)
+    std::vector<MapTile> tiles;   // Full snapshots only: copy of the tile planes
+    size_t tileOffset;
+    uint64_t snapshotId;
+    bool delta;
+
+public:
+    SaveSnapshot() : tileOffset(0), snapshotId(0), delta(false) {}
+
+    // Write to path via a temporary file and rename. Throws std::runtime_error on failure.
+    void write(const std::string& path) const;
+
+    bool isDelta() const { return delta; }
+    // Id of this full snapshot, or of the full snapshot a delta applies to
+    uint64_t getSnapshotId() const { return snapshotId; }
+    size_t getByteSize() const { return bytes.size() + tiles.size() * sizeof(MapTile); }
+};
+
+// Versioned binary snapshot of a GameState.
+//
+// Layout: a fixed header, a compact section holding players, heroes, turn state and map
+// objects, then the map's tile planes (one width * height plane per level, page aligned).
+// On load the tile planes are mapped copy-on-write and used by the GameMap as they are,
+// so loading does no per-tile work or allocation; in-game edits never touch the file.
+//
+// A delta holds the turn state, map objects, the players and heroes marked dirty and the dirty
+// tile chunks, relative to one full snapshot. Values are stored in native byte order.
+class SaveGame {
+public:
+    static const uint32_t FORMAT_VERSION = 2;
+
+    // Both throw std::runtime_error on I/O failure or a malformed/incompatible file
+    static void save(const GameState& state, const std::string& path);
+    static std::unique_ptr<GameState> load(const std::string& path);
+
+    // Load a full snapshot and apply a delta on top of it. A missing delta, or one written
+    // against a different snapshot, is ignored and the snapshot is loaded as-is.
+    static std::unique_ptr<GameState> load(const std::string& path, const std::string& deltaPath);
+
+    // Capture on the calling thread; write later with SaveSnapshot::write
+    static SaveSnapshot captureFull(const GameState& state);
+    static SaveSnapshot captureDelta(const GameState& state, uint64_t baseSnapshotId);
+
+private:
+    static void writeState(BinaryWriter& out, const GameState& state, bool dirtyOnly);
+    static void writePlayer(BinaryWriter& out, const Player& player);
+    static std::unique_ptr<Player> readPlayer(BinaryReader& in);
+    static void writeHero(BinaryWriter& out, const Hero& hero);
+    static std::unique_ptr<Hero> readHero(BinaryReader& in);
+    static void writeObject(BinaryWriter& out, const MapObject& object);
+    static std::unique_ptr<MapObject> readObject(BinaryReader& in);
+};
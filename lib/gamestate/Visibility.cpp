@@ -0,0 +1,174 @@
+#include "Visibility.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace {
+
+// Half width of the disc row dy away from the center
+int discHalfWidth(int radius, int dy) {
+    int remaining = radius * radius - dy * dy;
+    int halfWidth = static_cast<int>(std::sqrt(static_cast<double>(remaining)));
+    while ((halfWidth + 1) * (halfWidth + 1) <= remaining) {
+        halfWidth++;
+    }
+    while (halfWidth * halfWidth > remaining) {
+        halfWidth--;
+    }
+    return halfWidth;
+}
+
+// Mask of bits [first, last] within one word
+uint64_t bitRange(int first, int last) {
+    uint64_t high = last == 63 ? ~0ull : (1ull << (last + 1)) - 1;
+    return high & ~((1ull << first) - 1);
+}
+
+} // namespace
+
+VisibilityMap::VisibilityMap(int width, int height, int levels)
+    : width(width), height(height), levels(levels), wordsPerRow((static_cast<size_t>(width) + 63) / 64) {
+}
+
+int VisibilityMap::scoutingRadius(const Hero& hero) {
+    return BASE_SCOUTING_RADIUS + hero.getSkillLevel(SkillType::Scouting);
+}
+
+void VisibilityMap::update(const GameState& state) {
+    for (const auto& [heroId, hero] : state.getAllHeroes()) {
+        PlayerID owner = state.getHeroOwner(heroId);
+        if (owner == 0) {
+            removeViewer(heroId);
+        } else {
+            setViewer(heroId, owner, hero->getPosition(), scoutingRadius(*hero));
+        }
+    }
+
+    // Heroes that left the game
+    std::vector<HeroID> gone;
+    for (const auto& [heroId, viewer] : viewers) {
+        if (!state.getHero(heroId)) {
+            gone.push_back(heroId);
+        }
+    }
+    for (HeroID heroId : gone) {
+        removeViewer(heroId);
+    }
+}
+
+void VisibilityMap::setViewer(HeroID hero, PlayerID owner, const Position& position, int radius) {
+    auto it = viewers.find(hero);
+    if (it != viewers.end()) {
+        const Viewer& current = it->second;
+        if (current.owner == owner && current.position == position && current.radius == radius) {
+            return;
+        }
+        Viewer previous = current;
+        viewers.erase(it);
+        hide(hero, previous);
+    }
+
+    Viewer viewer = { owner, position, radius };
+    viewers[hero] = viewer;
+    PlayerPlanes& planes = planesFor(owner);
+    stamp(planes.visible, position, radius, true);
+    stamp(planes.explored, position, radius, true);
+    planes.version++;
+}
+
+void VisibilityMap::removeViewer(HeroID hero) {
+    auto it = viewers.find(hero);
+    if (it == viewers.end()) {
+        return;
+    }
+    Viewer previous = it->second;
+    viewers.erase(it);
+    hide(hero, previous);
+}
+
+void VisibilityMap::hide(HeroID hero, const Viewer& viewer) {
+    PlayerPlanes& planes = planesFor(viewer.owner);
+    stamp(planes.visible, viewer.position, viewer.radius, false);
+
+    // The player's other heroes may still see part of the cleared disc
+    for (const auto& [otherId, other] : viewers) {
+        if (otherId == hero || other.owner != viewer.owner || other.position.z != viewer.position.z) {
+            continue;
+        }
+        int reach = other.radius + viewer.radius;
+        if (std::abs(other.position.x - viewer.position.x) <= reach &&
+            std::abs(other.position.y - viewer.position.y) <= reach) {
+            stamp(planes.visible, other.position, other.radius, true);
+        }
+    }
+    planes.version++;
+}
+
+void VisibilityMap::stamp(std::vector<uint64_t>& plane, const Position& center, int radius, bool set) {
+    if (center.z < 0 || center.z >= levels || radius < 0) {
+        return;
+    }
+    for (int dy = -radius; dy <= radius; dy++) {
+        int y = center.y + dy;
+        if (y < 0 || y >= height) {
+            continue;
+        }
+        int halfWidth = discHalfWidth(radius, dy);
+        int firstX = std::max(0, center.x - halfWidth);
+        int lastX = std::min(width - 1, center.x + halfWidth);
+        if (firstX > lastX) {
+            continue;
+        }
+
+        uint64_t* row = plane.data() + (static_cast<size_t>(center.z) * height + y) * wordsPerRow;
+        for (int word = firstX / 64; word <= lastX / 64; word++) {
+            int first = std::max(firstX, word * 64) - word * 64;
+            int last = std::min(lastX, word * 64 + 63) - word * 64;
+            uint64_t mask = bitRange(first, last);
+            row[word] = set ? (row[word] | mask) : (row[word] & ~mask);
+        }
+    }
+}
+
+VisibilityMap::PlayerPlanes& VisibilityMap::planesFor(PlayerID player) {
+    PlayerPlanes& planes = players[player];
+    if (planes.visible.empty()) {
+        size_t words = static_cast<size_t>(levels) * height * wordsPerRow;
+        planes.visible.assign(words, 0);
+        planes.explored.assign(words, 0);
+    }
+    return planes;
+}
+
+bool VisibilityMap::testBit(const std::vector<uint64_t>& plane, const Position& pos) const {
+    if (pos.x < 0 || pos.x >= width || pos.y < 0 || pos.y >= height || pos.z < 0 || pos.z >= levels) {
+        return false;
+    }
+    size_t row = (static_cast<size_t>(pos.z) * height + pos.y) * wordsPerRow;
+    return (plane[row + pos.x / 64] >> (pos.x % 64)) & 1;
+}
+
+bool VisibilityMap::isVisible(PlayerID player, const Position& pos) const {
+    auto it = players.find(player);
+    return it != players.end() && testBit(it->second.visible, pos);
+}
+
+bool VisibilityMap::isExplored(PlayerID player, const Position& pos) const {
+    auto it = players.find(player);
+    return it != players.end() && testBit(it->second.explored, pos);
+}
+
+uint64_t VisibilityMap::getVersion(PlayerID player) const {
+    auto it = players.find(player);
+    return it != players.end() ? it->second.version : 0;
+}
+
+const std::vector<uint64_t>* VisibilityMap::getVisiblePlane(PlayerID player) const {
+    auto it = players.find(player);
+    return it != players.end() ? &it->second.visible : nullptr;
+}
+
+const std::vector<uint64_t>* VisibilityMap::getExploredPlane(PlayerID player) const {
+    auto it = players.find(player);
+    return it != players.end() ? &it->second.explored : nullptr;
+}
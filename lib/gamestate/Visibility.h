@@ -0,0 +1,68 @@
+#pragma once
+
+#include "GameState.h"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Per-player fog of war: which tiles each player's heroes can currently see, and which the
+// player has ever seen.
+//
+// Each player has two bit planes the size of the GameMap (one bit per tile, rows padded to whole
+// 64-bit words). A hero sees a disc of scoutingRadius() tiles on its own level. When a hero moves,
+// only its old and new discs are touched: the old disc is cleared and then re-stamped by the
+// player's other heroes that overlap it, so update() costs time in proportion to what moved.
+class VisibilityMap {
+public:
+    static const int BASE_SCOUTING_RADIUS = 5;
+
+private:
+    struct Viewer {
+        PlayerID owner;
+        Position position;
+        int radius;
+    };
+
+    struct PlayerPlanes {
+        std::vector<uint64_t> visible;
+        std::vector<uint64_t> explored;   // Sticky: once seen, stays explored
+        uint64_t version = 0;             // Bumped whenever visible changes
+    };
+
+    int width;
+    int height;
+    int levels;
+    size_t wordsPerRow;
+    std::unordered_map<HeroID, Viewer> viewers;
+    std::unordered_map<PlayerID, PlayerPlanes> players;
+
+public:
+    VisibilityMap(int width, int height, int levels);
+
+    // Sight radius of a hero: the base radius plus its Scouting level
+    static int scoutingRadius(const Hero& hero);
+
+    // Bring the planes up to date with the heroes of state (positions, owners, Scouting)
+    void update(const GameState& state);
+
+    // Add or move a hero's sight
+    void setViewer(HeroID hero, PlayerID owner, const Position& position, int radius);
+    void removeViewer(HeroID hero);
+
+    bool isVisible(PlayerID player, const Position& pos) const;
+    bool isExplored(PlayerID player, const Position& pos) const;
+    uint64_t getVersion(PlayerID player) const;
+
+    // Raw planes: levels * height rows of getWordsPerRow() words, bit x % 64 of word x / 64.
+    // Null for players without heroes so far.
+    const std::vector<uint64_t>* getVisiblePlane(PlayerID player) const;
+    const std::vector<uint64_t>* getExploredPlane(PlayerID player) const;
+    size_t getWordsPerRow() const { return wordsPerRow; }
+
+private:
+    PlayerPlanes& planesFor(PlayerID player);
+    bool testBit(const std::vector<uint64_t>& plane, const Position& pos) const;
+    // Set or clear the disc around center in plane
+    void stamp(std::vector<uint64_t>& plane, const Position& center, int radius, bool set);
+    void hide(HeroID hero, const Viewer& viewer);
+};
@@ -2,11 +2,27 @@
 #include "../gamestate/GameState.h"
 #include <algorithm>
 #include <cmath>
+#include <stdexcept>
 
 void ResourceMine::onVisit(HeroID heroId) {
     // Implementation would check hero ownership and transfer mine control
 }
 
+void ResourceMine::setOwner(PlayerID playerId) {
+    if (owningMap && playerId != owner) {
+        owningMap->adjustMineIncome(owner, resourceType, -dailyProduction);
+        owningMap->adjustMineIncome(playerId, resourceType, dailyProduction);
+    }
+    owner = playerId;
+}
+
+void ResourceMine::setDailyProduction(int production) {
+    if (owningMap) {
+        owningMap->adjustMineIncome(owner, resourceType, production - dailyProduction);
+    }
+    dailyProduction = production;
+}
+
 bool ResourceMine::canVisit(HeroID heroId) const {
     // Implementation would check if hero can capture this mine
     return true;
@@ -16,32 +32,48 @@ void MonsterGroup::onVisit(HeroID heroId) {
     // Implementation would initiate battle with the monster group
 }
 
-GameMap::GameMap(int w, int h, int l) : width(w), height(h), levels(l) {
-    initializeTiles();
+void MapObject::setPosition(const Position& pos) {
+    Position oldPos = position;
+    position = pos;
+    if (owningMap) {
+        owningMap->onObjectMoved(this, oldPos);
+    }
 }
 
-MapTile& GameMap::getTile(int x, int y, int z) {
-    if (!isPositionInBounds(x, y, z)) {
-        static MapTile invalidTile;
-        return invalidTile;
-    }
-    return tiles[z][y][x];
+GameMap::GameMap(int w, int h, int l)
+    : width(w), height(h), levels(l), tiles(nullptr), tileCount(0), chunksX(0), chunksY(0), nextListenerId(1) {
+    initializeTiles();
+    initializeChunks();
 }
 
-const MapTile& GameMap::getTile(int x, int y, int z) const {
-    if (!isPositionInBounds(x, y, z)) {
-        static MapTile invalidTile;
-        return invalidTile;
+GameMap::GameMap(int w, int h, int l, std::shared_ptr<MappedFile> backing, size_t tileOffset)
+    : width(w), height(h), levels(l), tiles(nullptr), tileCount(0), tileBacking(std::move(backing)),
+      chunksX(0), chunksY(0), nextListenerId(1) {
+    if (w <= 0 || h <= 0 || l <= 0 || !tileBacking || !tileBacking->getMutableData()) {
+        throw std::runtime_error("Invalid tile storage");
+    }
+    
+    size_t count = static_cast<size_t>(w) * h * l;
+    size_t available = tileBacking->getSize();
+    if (tileOffset % alignof(MapTile) != 0 || tileOffset > available ||
+        count > (available - tileOffset) / sizeof(MapTile)) {
+        throw std::runtime_error("Tile storage does not match map size");
     }
-    return tiles[z][y][x];
+    
+    tiles = reinterpret_cast<MapTile*>(tileBacking->getMutableData() + tileOffset);
+    tileCount = count;
+    initializeChunks();
 }
 
-bool GameMap::isValidPosition(int x, int y, int z) const {
-    return isPositionInBounds(x, y, z);
+// Writes through an out-of-bounds getTile land here and are never read back as map data
+MapTile& GameMap::outOfBoundsTile() {
+    thread_local MapTile invalidTile;
+    return invalidTile;
 }
 
-bool GameMap::isValidPosition(const Position& pos) const {
-    return isValidPosition(pos.x, pos.y, pos.z);
+const MapTile& GameMap::emptyTile() {
+    static const MapTile invalidTile;
+    return invalidTile;
 }
 
 bool GameMap::isPassable(const Position& pos) const {
@@ -63,7 +95,7 @@ int GameMap::getMovementCost(const Position& pos) const {
 }
 
 void GameMap::addObject(std::unique_ptr<MapObject> object) {
-    if (!object) {
+    if (!object || objectIndex.count(object->getId())) {
         return;
     }
     
@@ -78,73 +110,184 @@ void GameMap::addObject(std::unique_ptr<MapObject> object) {
         }
     }
     
+    object->owningMap = this;
+    objectIndex[object->getId()] = objects.size();
+    indexObjectAt(object.get(), pos);
+    trackMineIncome(object.get(), 1);
     objects.push_back(std::move(object));
+    
+    if (isValidPosition(pos)) {
+        notifyTileChanged(pos);
+    }
 }
 
-MapObject* GameMap::getObject(uint32_t objectId) {
-    auto it = std::find_if(objects.begin(), objects.end(),
-        [objectId](const std::unique_ptr<MapObject>& obj) {
-            return obj->getId() == objectId;
-        });
+void GameMap::restoreObject(std::unique_ptr<MapObject> object) {
+    if (!object || objectIndex.count(object->getId())) {
+        return;
+    }
     
-    return (it != objects.end()) ? it->get() : nullptr;
+    object->owningMap = this;
+    objectIndex[object->getId()] = objects.size();
+    indexObjectAt(object.get(), object->getPosition());
+    trackMineIncome(object.get(), 1);
+    objects.push_back(std::move(object));
+}
+
+MapObject* GameMap::getObject(uint32_t objectId) {
+    auto it = objectIndex.find(objectId);
+    return (it != objectIndex.end()) ? objects[it->second].get() : nullptr;
 }
 
 const MapObject* GameMap::getObject(uint32_t objectId) const {
-    auto it = std::find_if(objects.begin(), objects.end(),
-        [objectId](const std::unique_ptr<MapObject>& obj) {
-            return obj->getId() == objectId;
-        });
-    
-    return (it != objects.end()) ? it->get() : nullptr;
+    auto it = objectIndex.find(objectId);
+    return (it != objectIndex.end()) ? objects[it->second].get() : nullptr;
 }
 
 void GameMap::removeObject(uint32_t objectId) {
-    auto it = std::find_if(objects.begin(), objects.end(),
-        [objectId](const std::unique_ptr<MapObject>& obj) {
-            return obj->getId() == objectId;
-        });
-    
-    if (it != objects.end()) {
-        Position pos = (*it)->getPosition();
-        if (isValidPosition(pos)) {
-            MapTile& tile = getTile(pos);
-            tile.object = ObjectType::None;
-            tile.objectId = 0;
-            tile.passable = true; // Reset passability
-        }
-        
-        objects.erase(it);
+    auto it = objectIndex.find(objectId);
+    if (it == objectIndex.end()) {
+        return;
+    }
+    
+    size_t slot = it->second;
+    MapObject* object = objects[slot].get();
+    Position pos = object->getPosition();
+    if (isValidPosition(pos)) {
+        MapTile& tile = getTile(pos);
+        tile.object = ObjectType::None;
+        tile.objectId = 0;
+        tile.passable = true; // Reset passability
+    }
+    
+    unindexObjectAt(object, pos);
+    trackMineIncome(object, -1);
+    object->owningMap = nullptr;
+    objectIndex.erase(it);
+    
+    // Swap with the last object so removal doesn't shift the whole vector
+    if (slot != objects.size() - 1) {
+        objects[slot] = std::move(objects.back());
+        objectIndex[objects[slot]->getId()] = slot;
+    }
+    objects.pop_back();
+    
+    if (isValidPosition(pos)) {
+        notifyTileChanged(pos);
     }
 }
 
 std::vector<MapObject*> GameMap::getObjectsAt(const Position& pos) {
-    std::vector<MapObject*> result;
-    
-    for (auto& obj : objects) {
-        if (obj->getPosition() == pos) {
-            result.push_back(obj.get());
-        }
+    auto it = objectsByPosition.find(pos);
+    return (it != objectsByPosition.end()) ? it->second : std::vector<MapObject*>();
+}
+
+std::vector<const MapObject*> GameMap::getObjectsAt(const Position& pos) const {
+    auto it = objectsByPosition.find(pos);
+    if (it == objectsByPosition.end()) {
+        return {};
     }
-    
-    return result;
+    return std::vector<const MapObject*>(it->second.begin(), it->second.end());
 }
 
-bool GameMap::canHeroMoveTo(HeroID heroId, const Position& pos) const {
-    if (!isPassable(pos)) {
-        return false;
+int GameMap::addTileChangeListener(std::function<void(const Position&)> listener) {
+    int listenerId = nextListenerId++;
+    tileChangeListeners.emplace_back(listenerId, std::move(listener));
+    return listenerId;
+}
+
+void GameMap::removeTileChangeListener(int listenerId) {
+    tileChangeListeners.erase(
+        std::remove_if(tileChangeListeners.begin(), tileChangeListeners.end(),
+            [listenerId](const auto& entry) { return entry.first == listenerId; }),
+        tileChangeListeners.end());
+}
+
+void GameMap::notifyTileChanged(const Position& pos) {
+    markTileDirty(pos);
+    for (auto& [listenerId, listener] : tileChangeListeners) {
+        listener(pos);
+    }
+}
+
+void GameMap::markTileDirty(const Position& pos) {
+    if (isValidPosition(pos)) {
+        dirtyChunks[getChunkIndex(pos.x / TILE_CHUNK_SIZE, pos.y / TILE_CHUNK_SIZE, pos.z)] = 1;
+    }
+}
+
+void GameMap::clearDirtyChunks() {
+    std::fill(dirtyChunks.begin(), dirtyChunks.end(), 0);
+}
+
+void GameMap::indexObjectAt(MapObject* object, const Position& pos) {
+    objectsByPosition[pos].push_back(object);
+}
+
+void GameMap::unindexObjectAt(MapObject* object, const Position& pos) {
+    auto it = objectsByPosition.find(pos);
+    if (it == objectsByPosition.end()) {
+        return;
     }
     
-    // Check for blocking objects
+    auto& bucket = it->second;
+    bucket.erase(std::remove(bucket.begin(), bucket.end(), object), bucket.end());
+    if (bucket.empty()) {
+        objectsByPosition.erase(it);
+    }
+}
+
+void GameMap::onObjectMoved(MapObject* object, const Position& oldPos) {
+    if (oldPos == object->getPosition()) {
+        return;
+    }
+    unindexObjectAt(object, oldPos);
+    indexObjectAt(object, object->getPosition());
+}
+
+const Resources& GameMap::getMineIncome(PlayerID player) const {
+    static const Resources noIncome;
+    return player < mineIncome.size() ? mineIncome[player] : noIncome;
+}
+
+void GameMap::trackMineIncome(const MapObject* object, int sign) {
+    if (const ResourceMine* mine = dynamic_cast<const ResourceMine*>(object)) {
+        adjustMineIncome(mine->getOwner(), mine->getResourceType(), sign * mine->getDailyProduction());
+    }
+}
+
+void GameMap::adjustMineIncome(PlayerID owner, ResourceType type, int production) {
+    if (owner == 0 || production == 0) {
+        return;     // Neutral mines produce for nobody
+    }
+    if (owner >= mineIncome.size()) {
+        mineIncome.resize(owner + 1);
+    }
+    mineIncome[owner][type] += production;
+}
+
+const MapObject* GameMap::getBlockingObject(const Position& pos) const {
+    // Hero tiles hold a hero id, not an object id
     const MapTile& tile = getTile(pos);
-    if (tile.object != ObjectType::None) {
-        const MapObject* obj = getObject(tile.objectId);
-        if (obj && obj->blocksMovement() && !obj->canVisit(heroId)) {
-            return false;
-        }
+    if (tile.object == ObjectType::None || tile.object == ObjectType::Hero) {
+        return nullptr;
+    }
+    const MapObject* obj = getObject(tile.objectId);
+    return obj && obj->blocksMovement() ? obj : nullptr;
+}
+
+bool GameMap::canHeroMoveTo(HeroID, const Position& pos) const {
+    return isPassable(pos) && !getBlockingObject(pos);
+}
+
+bool GameMap::canHeroEnter(HeroID heroId, const Position& pos) const {
+    if (canHeroMoveTo(heroId, pos)) {
+        return true;
     }
     
-    return true;
+    // Blocking objects make their tile impassable, but a hero may end its move on one it can
+    // visit (mines are taken over that way)
+    const MapObject* obj = isValidPosition(pos) ? getBlockingObject(pos) : nullptr;
+    return obj && obj->canVisit(heroId);
 }
 
 void GameMap::moveHero(HeroID heroId, const Position& from, const Position& to) {
@@ -155,6 +298,7 @@ void GameMap::moveHero(HeroID heroId, const Position& from, const Position& to)
             fromTile.object = ObjectType::None;
             fromTile.objectId = 0;
         }
+        notifyTileChanged(from);
     }
     
     // Place hero at new position
@@ -168,6 +312,7 @@ void GameMap::moveHero(HeroID heroId, const Position& from, const Position& to)
             toTile.object = ObjectType::Hero;
             toTile.objectId = heroId;
         }
+        notifyTileChanged(to);
     }
 }
 
@@ -193,24 +338,17 @@ int GameMap::calculateDistance(const Position& from, const Position& to) const {
     int dy = std::abs(from.y - to.y);
     int dz = std::abs(from.z - to.z);
     
-    return dx + dy + dz; // Manhattan distance
+    return std::max(dx, dy) + dz; // Steps needed with 8-directional movement
 }
 
 void GameMap::initializeTiles() {
-    tiles.resize(levels);
-    for (int z = 0; z < levels; z++) {
-        tiles[z].resize(height);
-        for (int y = 0; y < height; y++) {
-            tiles[z][y].resize(width);
-            for (int x = 0; x < width; x++) {
-                tiles[z][y][x] = MapTile(TerrainType::Grass);
-            }
-        }
-    }
+    ownedTiles.assign(static_cast<size_t>(width) * height * levels, MapTile(TerrainType::Grass));
+    tiles = ownedTiles.data();
+    tileCount = ownedTiles.size();
 }
 
-bool GameMap::isPositionInBounds(int x, int y, int z) const {
-    return x >= 0 && x < width &&
-           y >= 0 && y < height &&
-           z >= 0 && z < levels;
-}
\ No newline at end of file
+void GameMap::initializeChunks() {
+    chunksX = (width + TILE_CHUNK_SIZE - 1) / TILE_CHUNK_SIZE;
+    chunksY = (height + TILE_CHUNK_SIZE - 1) / TILE_CHUNK_SIZE;
+    dirtyChunks.assign(static_cast<size_t>(chunksX) * chunksY * levels, 0);
+}
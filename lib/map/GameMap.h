@@ -1,10 +1,13 @@
 #pragma once
 
 #include "../../include/GameTypes.h"
+#include "../data/MappedFile.h"
 #include <vector>
 #include <memory>
+#include <unordered_map>
+#include <functional>
 
-enum class TerrainType {
+enum class TerrainType : uint8_t {
     Dirt,
     Sand,
     Grass,
@@ -15,7 +18,7 @@ enum class TerrainType {
     Water
 };
 
-enum class ObjectType {
+enum class ObjectType : uint8_t {
     None,
     Hero,
     Town,
@@ -32,34 +35,52 @@ enum class ObjectType {
     Decoration
 };
 
+// Tiles are stored contiguously by GameMap, so keep this packed (12 bytes)
 struct MapTile {
+    uint32_t objectId;  // ID of specific object instance
+    int32_t movementCost;
     TerrainType terrain;
     ObjectType object;
-    uint32_t objectId;  // ID of specific object instance
     bool passable;
-    int movementCost;
+    uint8_t reserved;   // Explicit padding so saved tiles have no indeterminate bytes
     
     MapTile(TerrainType t = TerrainType::Grass) 
-        : terrain(t), object(ObjectType::None), objectId(0), passable(true), movementCost(1) {}
+        : objectId(0), movementCost(1), terrain(t), object(ObjectType::None), passable(true), reserved(0) {}
 };
+static_assert(sizeof(MapTile) == 12, "MapTile layout changed");
+
+// Hash for keying containers by map position
+struct PositionHash {
+    size_t operator()(const Position& pos) const {
+        uint64_t key = (static_cast<uint64_t>(static_cast<uint32_t>(pos.z)) << 48) ^
+                       (static_cast<uint64_t>(static_cast<uint32_t>(pos.y)) << 24) ^
+                       static_cast<uint64_t>(static_cast<uint32_t>(pos.x));
+        return std::hash<uint64_t>()(key);
+    }
+};
+
+class GameMap;
 
 class MapObject {
+    friend class GameMap;
+    
 protected:
     uint32_t id;
     ObjectType type;
     Position position;
     bool blocksTile;
+    GameMap* owningMap;  // Set while the object is registered with a map
     
 public:
     MapObject(uint32_t id, ObjectType type, const Position& pos, bool blocks = true)
-        : id(id), type(type), position(pos), blocksTile(blocks) {}
+        : id(id), type(type), position(pos), blocksTile(blocks), owningMap(nullptr) {}
     
     virtual ~MapObject() = default;
     
     uint32_t getId() const { return id; }
     ObjectType getType() const { return type; }
     const Position& getPosition() const { return position; }
-    void setPosition(const Position& pos) { position = pos; }
+    void setPosition(const Position& pos);
     bool blocksMovement() const { return blocksTile; }
     
     virtual void onVisit(HeroID heroId) {}
@@ -79,7 +100,10 @@ public:
     ResourceType getResourceType() const { return resourceType; }
     int getDailyProduction() const { return dailyProduction; }
     PlayerID getOwner() const { return owner; }
-    void setOwner(PlayerID playerId) { owner = playerId; }
+    
+    // Both keep the owning map's income ledger up to date
+    void setOwner(PlayerID playerId);
+    void setDailyProduction(int production);
     
     void onVisit(HeroID heroId) override;
     bool canVisit(HeroID heroId) const override;
@@ -100,6 +124,9 @@ public:
     int getCount() const { return count; }
     void setCount(int cnt) { count = cnt; }
     
+    bool getNeverFlees() const { return neverFlees; }
+    void setNeverFlees(bool never) { neverFlees = never; }
+    
     const Resources& getReward() const { return reward; }
     void setReward(const Resources& res) { reward = res; }
     
@@ -108,31 +135,74 @@ public:
 };
 
 class GameMap {
+    friend class MapObject;
+    friend class ResourceMine;
+    
 private:
     int width, height, levels;
-    std::vector<std::vector<std::vector<MapTile>>> tiles;
+    MapTile* tiles;              // Row-major: index = (z * height + y) * width + x
+    size_t tileCount;
+    std::vector<MapTile> ownedTiles;             // Tile storage for maps built in code
+    std::shared_ptr<MappedFile> tileBacking;     // Tile storage for maps mapped from a save file
+    std::vector<uint8_t> dirtyChunks;            // One flag per TILE_CHUNK_SIZE square of a level
+    int chunksX, chunksY;
     std::vector<std::unique_ptr<MapObject>> objects;
+    std::unordered_map<uint32_t, size_t> objectIndex;                 // Object id -> slot in objects
+    std::unordered_map<Position, std::vector<MapObject*>, PositionHash> objectsByPosition;
+    std::vector<Resources> mineIncome;           // Daily production of owned mines, indexed by PlayerID
     std::string mapName;
     std::string description;
     
+    // Observers notified when a tile's object or passability changes
+    std::vector<std::pair<int, std::function<void(const Position&)>>> tileChangeListeners;
+    int nextListenerId;
+    
 public:
+    // Edge length of the square tile chunks used for change tracking and incremental saves
+    static const int TILE_CHUNK_SIZE = 32;
+    
     GameMap(int w, int h, int l = 1);
+    
+    // Use tile planes stored in a copy-on-write mapped file as-is, without copying them.
+    // Throws std::runtime_error if the range at tileOffset does not hold w * h * l aligned tiles.
+    GameMap(int w, int h, int l, std::shared_ptr<MappedFile> backing, size_t tileOffset);
     ~GameMap() = default;
     
+    // Objects keep a back-pointer to their map, so the map itself stays put
+    GameMap(const GameMap&) = delete;
+    GameMap& operator=(const GameMap&) = delete;
+    
     // Map dimensions
     int getWidth() const { return width; }
     int getHeight() const { return height; }
     int getLevels() const { return levels; }
     
-    // Tile access
-    MapTile& getTile(int x, int y, int z = 0);
-    const MapTile& getTile(int x, int y, int z = 0) const;
+    // Tile access. Inline, so loops over the map keep the bounds check and index math in place;
+    // positions off the map get a scratch tile.
+    MapTile& getTile(int x, int y, int z = 0) {
+        return isPositionInBounds(x, y, z) ? tiles[getTileIndex(x, y, z)] : outOfBoundsTile();
+    }
+    const MapTile& getTile(int x, int y, int z = 0) const {
+        return isPositionInBounds(x, y, z) ? tiles[getTileIndex(x, y, z)] : emptyTile();
+    }
     MapTile& getTile(const Position& pos) { return getTile(pos.x, pos.y, pos.z); }
     const MapTile& getTile(const Position& pos) const { return getTile(pos.x, pos.y, pos.z); }
     
+    // Unchecked tile access for hot loops - caller guarantees the position is valid
+    size_t getTileIndex(int x, int y, int z = 0) const {
+        return (static_cast<size_t>(z) * height + y) * width + x;
+    }
+    MapTile& getTileUnchecked(int x, int y, int z = 0) { return tiles[getTileIndex(x, y, z)]; }
+    const MapTile& getTileUnchecked(int x, int y, int z = 0) const { return tiles[getTileIndex(x, y, z)]; }
+    
+    // Raw tile storage (levels * height * width tiles, row-major)
+    MapTile* getTileData() { return tiles; }
+    const MapTile* getTileData() const { return tiles; }
+    size_t getTileCount() const { return tileCount; }
+    
     // Position validation
-    bool isValidPosition(int x, int y, int z = 0) const;
-    bool isValidPosition(const Position& pos) const;
+    bool isValidPosition(int x, int y, int z = 0) const { return isPositionInBounds(x, y, z); }
+    bool isValidPosition(const Position& pos) const { return isPositionInBounds(pos.x, pos.y, pos.z); }
     bool isPassable(const Position& pos) const;
     int getMovementCost(const Position& pos) const;
     
@@ -141,11 +211,39 @@ public:
     MapObject* getObject(uint32_t objectId);
     const MapObject* getObject(uint32_t objectId) const;
     void removeObject(uint32_t objectId);
+    // Register an object whose tile state is already present in the tiles (e.g. loaded from a save);
+    // the tiles are not touched and no listeners fire
+    void restoreObject(std::unique_ptr<MapObject> object);
     std::vector<MapObject*> getObjectsAt(const Position& pos);
+    std::vector<const MapObject*> getObjectsAt(const Position& pos) const;
     const std::vector<std::unique_ptr<MapObject>>& getAllObjects() const { return objects; }
     
-    // Hero movement
+    // Daily production of the mines a player owns. Kept up to date as mines are added, removed,
+    // change hands or change production, so reading it costs nothing.
+    const Resources& getMineIncome(PlayerID player) const;
+    
+    // Tile change notifications (fired by addObject, removeObject and moveHero).
+    // Code that edits tiles directly through getTile() should call notifyTileChanged itself.
+    int addTileChangeListener(std::function<void(const Position&)> listener);
+    void removeTileChangeListener(int listenerId);
+    void notifyTileChanged(const Position& pos);
+    
+    // Tile change tracking for incremental saves. notifyTileChanged marks the tile's chunk dirty;
+    // flags are cleared when a full snapshot has been taken.
+    int getChunksX() const { return chunksX; }
+    int getChunksY() const { return chunksY; }
+    size_t getChunkCount() const { return dirtyChunks.size(); }
+    size_t getChunkIndex(int chunkX, int chunkY, int z) const {
+        return (static_cast<size_t>(z) * chunksY + chunkY) * chunksX + chunkX;
+    }
+    bool isChunkDirty(size_t chunkIndex) const { return dirtyChunks[chunkIndex] != 0; }
+    void markTileDirty(const Position& pos);
+    void clearDirtyChunks();
+    
+    // Hero movement. canHeroMoveTo: the hero may pass through pos on the way somewhere else.
+    // canHeroEnter: the hero may end a move on pos, which also allows blocking objects it can visit.
     bool canHeroMoveTo(HeroID heroId, const Position& pos) const;
+    bool canHeroEnter(HeroID heroId, const Position& pos) const;
     void moveHero(HeroID heroId, const Position& from, const Position& to);
     
     // Map info
@@ -154,11 +252,28 @@ public:
     const std::string& getDescription() const { return description; }
     void setDescription(const std::string& desc) { description = desc; }
     
-    // Pathfinding helpers
+    // Pathfinding helpers (see Pathfinder for full path queries)
     std::vector<Position> getAdjacentPositions(const Position& pos) const;
     int calculateDistance(const Position& from, const Position& to) const;
     
 private:
     void initializeTiles();
-    bool isPositionInBounds(int x, int y, int z) const;
+    void initializeChunks();
+    bool isPositionInBounds(int x, int y, int z) const {
+        return static_cast<unsigned>(x) < static_cast<unsigned>(width) &&
+               static_cast<unsigned>(y) < static_cast<unsigned>(height) &&
+               static_cast<unsigned>(z) < static_cast<unsigned>(levels);
+    }
+    static MapTile& outOfBoundsTile();
+    const MapObject* getBlockingObject(const Position& pos) const;
+    static const MapTile& emptyTile();
+    
+    // Spatial index maintenance
+    void indexObjectAt(MapObject* object, const Position& pos);
+    void unindexObjectAt(MapObject* object, const Position& pos);
+    void onObjectMoved(MapObject* object, const Position& oldPos);
+    
+    // Income ledger maintenance
+    void trackMineIncome(const MapObject* object, int sign);
+    void adjustMineIncome(PlayerID owner, ResourceType type, int production);
 };
\ No newline at end of file
@@ -0,0 +1,160 @@
+#include "Pathfinder.h"
+#include "GameMap.h"
+#include "../entities/hero/Hero.h"
+#include <algorithm>
+#include <cstdlib>
+
+namespace {
+
+// 8-directional neighbourhood
+const int NEIGHBOUR_DX[8] = { -1, 0, 1, -1, 1, -1, 0, 1 };
+const int NEIGHBOUR_DY[8] = { -1, -1, -1, 0, 0, 1, 1, 1 };
+
+} // namespace
+
+int Path::getAffordableSteps(int movementPoints) const {
+    auto it = std::upper_bound(cumulativeCost.begin(), cumulativeCost.end(), movementPoints);
+    return static_cast<int>(it - cumulativeCost.begin());
+}
+
+Pathfinder::Pathfinder(const GameMap& gameMap) : map(gameMap), generation(0) {
+    size_t tileCount = map.getTileCount();
+    costSoFar.resize(tileCount);
+    cameFrom.resize(tileCount);
+    visitedGeneration.assign(tileCount, 0);
+    closedGeneration.assign(tileCount, 0);
+    openHeap.reserve(tileCount);
+    reversedPath.reserve(tileCount);
+}
+
+bool Pathfinder::findPath(HeroID heroId, const Position& from, const Position& to, Path& outPath) {
+    outPath.clear();
+
+    if (!map.isValidPosition(from) || !map.isValidPosition(to) || from.z != to.z) {
+        return false;
+    }
+    if (from == to) {
+        outPath.found = true;
+        return true;
+    }
+    if (!map.canHeroEnter(heroId, to)) {
+        return false;
+    }
+
+    beginSearch();
+
+    int startIndex = static_cast<int>(map.getTileIndex(from.x, from.y, from.z));
+    int goalIndex = static_cast<int>(map.getTileIndex(to.x, to.y, to.z));
+
+    costSoFar[startIndex] = 0;
+    cameFrom[startIndex] = -1;
+    visitedGeneration[startIndex] = generation;
+    openHeap.push_back({ octileDistance(from, to), startIndex });
+
+    bool reachedGoal = false;
+    while (!openHeap.empty()) {
+        std::pop_heap(openHeap.begin(), openHeap.end());
+        OpenEntry current = openHeap.back();
+        openHeap.pop_back();
+
+        if (closedGeneration[current.tileIndex] == generation) {
+            continue; // Stale entry, a cheaper one was already expanded
+        }
+        closedGeneration[current.tileIndex] = generation;
+
+        if (current.tileIndex == goalIndex) {
+            reachedGoal = true;
+            break;
+        }
+
+        Position pos = positionFromIndex(current.tileIndex);
+        for (int dir = 0; dir < 8; dir++) {
+            Position next(pos.x + NEIGHBOUR_DX[dir], pos.y + NEIGHBOUR_DY[dir], pos.z);
+            if (!map.isValidPosition(next)) {
+                continue;
+            }
+
+            int nextIndex = static_cast<int>(map.getTileIndex(next.x, next.y, next.z));
+            if (closedGeneration[nextIndex] == generation) {
+                continue;
+            }
+            // Only the goal may be a visitable object; paths never pass through one
+            if (nextIndex == goalIndex ? !map.canHeroEnter(heroId, next) : !map.canHeroMoveTo(heroId, next)) {
+                continue;
+            }
+
+            int newCost = costSoFar[current.tileIndex] + getStepCost(pos, next);
+            if (visitedGeneration[nextIndex] != generation || newCost < costSoFar[nextIndex]) {
+                visitedGeneration[nextIndex] = generation;
+                costSoFar[nextIndex] = newCost;
+                cameFrom[nextIndex] = current.tileIndex;
+                openHeap.push_back({ newCost + octileDistance(next, to), nextIndex });
+                std::push_heap(openHeap.begin(), openHeap.end());
+            }
+        }
+    }
+
+    openHeap.clear();
+
+    if (!reachedGoal) {
+        return false;
+    }
+
+    // Walk back from the goal, then emit the steps in travel order
+    reversedPath.clear();
+    for (int index = goalIndex; index != startIndex; index = cameFrom[index]) {
+        reversedPath.push_back(index);
+    }
+
+    outPath.steps.reserve(reversedPath.size());
+    outPath.cumulativeCost.reserve(reversedPath.size());
+    for (auto it = reversedPath.rbegin(); it != reversedPath.rend(); ++it) {
+        outPath.steps.push_back(positionFromIndex(*it));
+        outPath.cumulativeCost.push_back(costSoFar[*it]);
+    }
+    outPath.found = true;
+    return true;
+}
+
+bool Pathfinder::findPath(const Hero& hero, const Position& to, Path& outPath) {
+    return findPath(hero.getId(), hero.getPosition(), to, outPath);
+}
+
+Path Pathfinder::findPath(const Hero& hero, const Position& to) {
+    Path path;
+    findPath(hero, to, path);
+    return path;
+}
+
+int Pathfinder::getStepCost(const GameMap& gameMap, const Position& from, const Position& to) {
+    int tileCost = std::max(1, gameMap.getMovementCost(to));
+    bool diagonal = from.x != to.x && from.y != to.y;
+    return tileCost * (diagonal ? DIAGONAL_STEP_COST : STRAIGHT_STEP_COST);
+}
+
+int Pathfinder::octileDistance(const Position& from, const Position& to) {
+    int dx = std::abs(from.x - to.x);
+    int dy = std::abs(from.y - to.y);
+    int diagonalSteps = std::min(dx, dy);
+    int straightSteps = std::max(dx, dy) - diagonalSteps;
+    return diagonalSteps * DIAGONAL_STEP_COST + straightSteps * STRAIGHT_STEP_COST;
+}
+
+void Pathfinder::beginSearch() {
+    generation++;
+    if (generation == 0) {
+        // Counter wrapped around, old stamps could alias the new generation
+        std::fill(visitedGeneration.begin(), visitedGeneration.end(), 0);
+        std::fill(closedGeneration.begin(), closedGeneration.end(), 0);
+        generation = 1;
+    }
+    openHeap.clear();
+}
+
+Position Pathfinder::positionFromIndex(int tileIndex) const {
+    int width = map.getWidth();
+    int levelSize = width * map.getHeight();
+    int z = tileIndex / levelSize;
+    int rest = tileIndex - z * levelSize;
+    return Position(rest % width, rest / width, z);
+}
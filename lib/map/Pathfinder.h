@@ -0,0 +1,68 @@
+#pragma once
+
+#include "../../include/GameTypes.h"
+#include <vector>
+
+class GameMap;
+class Hero;
+
+// Movement point cost of one step onto a tile with movementCost 1
+const int STRAIGHT_STEP_COST = 100;
+const int DIAGONAL_STEP_COST = 141;
+
+// Result of a path query
+struct Path {
+    std::vector<Position> steps;       // Tiles to walk through, excluding the start, ending at the goal
+    std::vector<int> cumulativeCost;   // Movement points spent after each step
+    bool found = false;
+
+    int getTotalCost() const { return cumulativeCost.empty() ? 0 : cumulativeCost.back(); }
+
+    // Number of leading steps that fit into the given movement points
+    int getAffordableSteps(int movementPoints) const;
+
+    void clear() { steps.clear(); cumulativeCost.clear(); found = false; }
+};
+
+// A* pathfinder over a GameMap with an octile heuristic.
+// Node storage is sized to the map once, so repeated queries do not allocate
+// (beyond growing the output Path the first time it is used).
+class Pathfinder {
+private:
+    const GameMap& map;
+
+    // Per-tile search state, indexed like GameMap tiles
+    std::vector<int> costSoFar;
+    std::vector<int> cameFrom;
+    std::vector<uint32_t> visitedGeneration;  // Node is valid for this search only if it matches
+    std::vector<uint32_t> closedGeneration;
+    uint32_t generation;
+
+    struct OpenEntry {
+        int priority;
+        int tileIndex;
+
+        bool operator<(const OpenEntry& other) const { return priority > other.priority; }
+    };
+    std::vector<OpenEntry> openHeap;
+    std::vector<int> reversedPath;
+
+public:
+    explicit Pathfinder(const GameMap& gameMap);
+
+    // Find the cheapest path for a hero; returns false if the goal is unreachable
+    bool findPath(HeroID heroId, const Position& from, const Position& to, Path& outPath);
+    bool findPath(const Hero& hero, const Position& to, Path& outPath);
+    Path findPath(const Hero& hero, const Position& to);
+
+    // Movement points needed to step from one tile onto an adjacent one
+    int getStepCost(const Position& from, const Position& to) const { return getStepCost(map, from, to); }
+    static int getStepCost(const GameMap& gameMap, const Position& from, const Position& to);
+
+    // Lower bound on the movement points needed between two tiles on the same level
+    static int octileDistance(const Position& from, const Position& to);
+
+private:
+    void beginSearch();
+    Position positionFromIndex(int tileIndex) const;
+};
@@ -0,0 +1,145 @@
+#include "Reachability.h"
+#include "GameMap.h"
+#include "Pathfinder.h"
+#include "../entities/hero/Hero.h"
+#include <algorithm>
+#include <functional>
+
+bool ReachabilityMap::isInWindow(const Position& pos) const {
+    return pos.z == origin.z &&
+           pos.x >= windowX && pos.x < windowX + windowWidth &&
+           pos.y >= windowY && pos.y < windowY + windowHeight;
+}
+
+int ReachabilityMap::getCost(const Position& pos) const {
+    if (!valid || !isInWindow(pos)) {
+        return -1;
+    }
+    return cost[(pos.y - windowY) * windowWidth + (pos.x - windowX)];
+}
+
+ReachabilityCache::ReachabilityCache(GameMap& gameMap) : map(gameMap) {
+    listenerId = map.addTileChangeListener([this](const Position& pos) { onTileChanged(pos); });
+}
+
+ReachabilityCache::~ReachabilityCache() {
+    map.removeTileChangeListener(listenerId);
+}
+
+const ReachabilityMap& ReachabilityCache::getReachability(const Hero& hero) {
+    return getReachability(hero, hero.getMovementPoints());
+}
+
+const ReachabilityMap& ReachabilityCache::getReachability(const Hero& hero, int budget) {
+    // find() on a tracked hero leaves the table alone, so other threads may use their entries
+    auto it = entries.find(hero.getId());
+    ReachabilityMap& reach = it != entries.end() ? it->second : entries[hero.getId()];
+
+    if (!reach.valid ||
+        !(reach.origin == hero.getPosition()) ||
+        reach.budget != budget) {
+        recompute(hero, budget, reach);
+    }
+
+    return reach;
+}
+
+void ReachabilityCache::invalidate(HeroID heroId) {
+    auto it = entries.find(heroId);
+    if (it != entries.end()) {
+        it->second.valid = false;
+    }
+}
+
+void ReachabilityCache::onTileChanged(const Position& pos) {
+    for (auto& [heroId, reach] : entries) {
+        if (reach.valid && reach.isInWindow(pos)) {
+            reach.valid = false;
+        }
+    }
+}
+
+void ReachabilityCache::recompute(const Hero& hero, int budget, ReachabilityMap& reach) {
+    const Position origin = hero.getPosition();
+
+    reach.origin = origin;
+    reach.budget = budget;
+    budget = std::max(0, budget);
+    reach.valid = true;
+    reach.reachableTiles.clear();
+
+    if (!map.isValidPosition(origin)) {
+        reach.windowWidth = 0;
+        reach.windowHeight = 0;
+        reach.cost.clear();
+        return;
+    }
+
+    // Every step costs at least STRAIGHT_STEP_COST, which bounds how far the flood can go
+    int radius = budget / STRAIGHT_STEP_COST;
+    int minX = std::max(0, origin.x - radius);
+    int minY = std::max(0, origin.y - radius);
+    int maxX = std::min(map.getWidth() - 1, origin.x + radius);
+    int maxY = std::min(map.getHeight() - 1, origin.y + radius);
+
+    reach.windowX = minX;
+    reach.windowY = minY;
+    reach.windowWidth = maxX - minX + 1;
+    reach.windowHeight = maxY - minY + 1;
+    reach.cost.assign(static_cast<size_t>(reach.windowWidth) * reach.windowHeight, -1);
+
+    auto windowIndex = [&reach](int x, int y) {
+        return (y - reach.windowY) * reach.windowWidth + (x - reach.windowX);
+    };
+
+    const HeroID heroId = hero.getId();
+    // Scratch open list reused between floods on each thread: (cost, window index)
+    thread_local std::vector<std::pair<int, int>> openHeap;
+    openHeap.clear();
+
+    int startIndex = windowIndex(origin.x, origin.y);
+    reach.cost[startIndex] = 0;
+    openHeap.emplace_back(0, startIndex);
+
+    auto byCost = std::greater<std::pair<int, int>>();
+    while (!openHeap.empty()) {
+        std::pop_heap(openHeap.begin(), openHeap.end(), byCost);
+        auto [currentCost, currentIndex] = openHeap.back();
+        openHeap.pop_back();
+
+        if (currentCost > reach.cost[currentIndex]) {
+            continue; // Stale entry
+        }
+
+        Position pos(reach.windowX + currentIndex % reach.windowWidth,
+                     reach.windowY + currentIndex / reach.windowWidth,
+                     origin.z);
+        reach.reachableTiles.push_back(pos);
+
+        for (int dy = -1; dy <= 1; dy++) {
+            for (int dx = -1; dx <= 1; dx++) {
+                if (dx == 0 && dy == 0) continue;
+
+                Position next(pos.x + dx, pos.y + dy, pos.z);
+                if (next.x < minX || next.x > maxX || next.y < minY || next.y > maxY) {
+                    continue;
+                }
+                if (!map.canHeroMoveTo(heroId, next)) {
+                    continue;
+                }
+
+                int nextCost = currentCost + Pathfinder::getStepCost(map, pos, next);
+                if (nextCost > budget) {
+                    continue;
+                }
+
+                int nextIndex = windowIndex(next.x, next.y);
+                if (reach.cost[nextIndex] < 0 || nextCost < reach.cost[nextIndex]) {
+                    reach.cost[nextIndex] = nextCost;
+                    openHeap.emplace_back(nextCost, nextIndex);
+                    std::push_heap(openHeap.begin(), openHeap.end(), byCost);
+                }
+            }
+        }
+    }
+}
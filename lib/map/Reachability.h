@@ -0,0 +1,66 @@
+#pragma once
+
+#include "../../include/GameTypes.h"
+#include <vector>
+#include <unordered_map>
+
+class GameMap;
+class Hero;
+
+// Tiles a hero can reach, computed by a Dijkstra flood bounded by a movement budget
+// (by default the hero's movement points: what it can reach this turn)
+struct ReachabilityMap {
+    Position origin;
+    int budget = 0;
+    bool valid = false;
+
+    // Area covered by the flood, clamped to the map
+    int windowX = 0;
+    int windowY = 0;
+    int windowWidth = 0;
+    int windowHeight = 0;
+
+    std::vector<int> cost;                 // Movement points to reach each window tile, -1 if unreachable
+    std::vector<Position> reachableTiles;  // Every tile with a cost, in flood order (cheapest first)
+
+    bool isInWindow(const Position& pos) const;
+    int getCost(const Position& pos) const;
+    bool canReach(const Position& pos) const { return getCost(pos) >= 0; }
+};
+
+// Keeps one ReachabilityMap per hero and only recomputes it when it can have changed:
+// the hero moved, its budget changed, or a tile inside its flood window changed.
+//
+// Different heroes' entries may be refreshed on several threads at once, provided each hero was
+// track()ed beforehand and the map does not change meanwhile.
+class ReachabilityCache {
+private:
+    GameMap& map;
+    int listenerId;
+    std::unordered_map<HeroID, ReachabilityMap> entries;
+
+public:
+    explicit ReachabilityCache(GameMap& gameMap);
+    ~ReachabilityCache();
+
+    ReachabilityCache(const ReachabilityCache&) = delete;
+    ReachabilityCache& operator=(const ReachabilityCache&) = delete;
+
+    // Cached reachability for the hero, recomputed first if stale
+    const ReachabilityMap& getReachability(const Hero& hero);
+    const ReachabilityMap& getReachability(const Hero& hero, int budget);
+    bool canReach(const Hero& hero, const Position& pos) { return getReachability(hero).canReach(pos); }
+    int getCostTo(const Hero& hero, const Position& pos) { return getReachability(hero).getCost(pos); }
+
+    // Create the hero's entry, so it can be refreshed concurrently with other heroes'
+    void track(HeroID heroId) { entries[heroId]; }
+
+    // Explicit invalidation
+    void invalidate(HeroID heroId);
+    void removeHero(HeroID heroId) { entries.erase(heroId); }
+    void clear() { entries.clear(); }
+
+private:
+    void onTileChanged(const Position& pos);
+    void recompute(const Hero& hero, int budget, ReachabilityMap& reach);
+};
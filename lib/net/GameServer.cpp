@@ -0,0 +1,579 @@
+#include "GameServer.h"
+#include <algorithm>
+
+#if defined(__linux__)
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#define REALMS_HAVE_EPOLL 1
+#endif
+
+namespace {
+
+const int MAX_EVENTS = 256;
+const size_t READ_CHUNK = 16384;
+
+} // namespace
+
+GameServer::GameServer(GameState& gameState, uint32_t battleSeed)
+    : GameServer(std::make_unique<GameHost>(1), nullptr, 0) {
+    defaultGame = host.addGame(gameState, battleSeed);
+}
+
+GameServer::GameServer(GameHost& gameHost, GameID defaultGameId)
+    : GameServer(nullptr, &gameHost, defaultGameId) {
+}
+
+GameServer::GameServer(std::unique_ptr<GameHost> owned, GameHost* gameHost, GameID defaultGameId)
+    : ownedHost(std::move(owned)), host(gameHost ? *gameHost : *ownedHost), defaultGame(defaultGameId),
+      commandsPending(false), tickIntervalMs(0), listenFd(-1), epollFd(-1), wakeFd(-1), port(0),
+      running(false), nextConnectionId(1) {
+    // Replication changes are captured by the worker that ran the game
+    host.setTickListener([this](HostedGame& game) {
+        auto it = serverGames.find(game.getId());
+        if (it == serverGames.end()) {
+            return;
+        }
+        if (it->second.visibility) {
+            it->second.visibility->update(game.getState());
+        }
+        if (it->second.replicator) {
+            it->second.replicator->capture();
+        }
+    });
+}
+
+void GameServer::setTickInterval(int intervalMs) {
+    tickIntervalMs = intervalMs;
+    nextTick = std::chrono::steady_clock::now() + std::chrono::milliseconds(intervalMs);
+}
+
+GameServer::~GameServer() {
+    host.setTickListener(nullptr);
+    closeAll();
+}
+
+#ifdef REALMS_HAVE_EPOLL
+
+bool GameServer::listen(uint16_t listenPort, bool loopbackOnly) {
+    closeAll();
+
+    listenFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listenFd < 0) {
+        lastError = std::string("socket: ") + std::strerror(errno);
+        return false;
+    }
+
+    int reuse = 1;
+    setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(loopbackOnly ? INADDR_LOOPBACK : INADDR_ANY);
+    address.sin_port = htons(listenPort);
+    if (bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 ||
+        ::listen(listenFd, SOMAXCONN) < 0) {
+        lastError = std::string("bind/listen: ") + std::strerror(errno);
+        closeAll();
+        return false;
+    }
+
+    socklen_t addressLength = sizeof(address);
+    getsockname(listenFd, reinterpret_cast<sockaddr*>(&address), &addressLength);
+    port = ntohs(address.sin_port);
+
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epollFd < 0 || wakeFd < 0) {
+        lastError = std::string("epoll: ") + std::strerror(errno);
+        closeAll();
+        return false;
+    }
+
+    epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.fd = listenFd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &event);
+    event.data.fd = wakeFd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &event);
+    return true;
+}
+
+void GameServer::run() {
+    running = true;
+    while (running && epollFd >= 0) {
+        poll(-1);
+    }
+}
+
+int GameServer::poll(int timeoutMs) {
+    if (epollFd < 0) {
+        return 0;
+    }
+
+    // Wake up in time for the next timed tick
+    if (tickIntervalMs > 0) {
+        auto untilTick = std::chrono::duration_cast<std::chrono::milliseconds>(
+            nextTick - std::chrono::steady_clock::now()).count();
+        int tickTimeout = static_cast<int>(std::max<decltype(untilTick)>(0, untilTick));
+        timeoutMs = timeoutMs < 0 ? tickTimeout : std::min(timeoutMs, tickTimeout);
+    }
+
+    epoll_event events[MAX_EVENTS];
+    int count = epoll_wait(epollFd, events, MAX_EVENTS, timeoutMs);
+    if (count < 0) {
+        if (errno != EINTR) {
+            lastError = std::string("epoll_wait: ") + std::strerror(errno);
+        }
+        return 0;
+    }
+
+    for (int i = 0; i < count; i++) {
+        int fd = events[i].data.fd;
+        if (fd == listenFd) {
+            acceptConnections();
+            continue;
+        }
+        if (fd == wakeFd) {
+            uint64_t value;
+            while (read(wakeFd, &value, sizeof(value)) > 0) {
+            }
+            running = false;
+            continue;
+        }
+
+        auto it = connections.find(fd);
+        if (it == connections.end()) {
+            continue;
+        }
+        Connection& connection = *it->second;
+        if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+            close(connection);
+            continue;
+        }
+        if (events[i].events & EPOLLIN) {
+            readFrom(connection);
+        }
+        if (events[i].events & EPOLLOUT) {
+            flush(connection);
+        }
+    }
+
+    bool tickDue = tickIntervalMs > 0 && std::chrono::steady_clock::now() >= nextTick;
+    if (commandsPending || tickDue) {
+        tickGames();
+    }
+    replicate();
+
+    // Results, broadcasts and state updates queued while handling this batch go out together
+    for (auto& [fd, connection] : connections) {
+        if (connection->fd >= 0 && connection->outputOffset < connection->output.size() &&
+            !connection->waitingForWrite) {
+            flush(*connection);
+        }
+    }
+
+    for (int fd : closedConnections) {
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+        ::close(fd);
+        leaveGame(*connections[fd]);
+        connectionsById.erase(connections[fd]->id);
+        connections.erase(fd);
+    }
+    closedConnections.clear();
+    return count;
+}
+
+void GameServer::stop() {
+    if (wakeFd >= 0) {
+        uint64_t one = 1;
+        ssize_t written = write(wakeFd, &one, sizeof(one));
+        (void)written;
+    }
+}
+
+void GameServer::acceptConnections() {
+    while (true) {
+        int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            return;  // EAGAIN: backlog drained; anything else is retried on the next wakeup
+        }
+
+        int noDelay = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+
+        epoll_event event = {};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) < 0) {
+            ::close(fd);
+            continue;
+        }
+
+        auto connection = std::make_unique<Connection>();
+        connection->fd = fd;
+        connection->id = nextConnectionId++;
+        connection->game = 0;
+        connection->outputOffset = 0;
+        connection->player = 0;
+        connection->joined = false;
+        connection->waitingForWrite = false;
+        connection->subscribed = false;
+        connection->ackedTick = 0;
+        connection->sentTick = 0;
+        connectionsById[connection->id] = connection.get();
+        connections[fd] = std::move(connection);
+    }
+}
+
+void GameServer::readFrom(Connection& connection) {
+    size_t oldSize = connection.input.size();
+    connection.input.resize(oldSize + READ_CHUNK);
+    ssize_t received = recv(connection.fd, connection.input.data() + oldSize, READ_CHUNK, 0);
+    if (received <= 0) {
+        connection.input.resize(oldSize);
+        if (received == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+            close(connection);
+        }
+        return;
+    }
+    connection.input.resize(oldSize + static_cast<size_t>(received));
+
+    // Handle every complete frame, keep a trailing partial one for the next read
+    size_t offset = 0;
+    while (connection.fd >= 0 && connection.input.size() - offset >= sizeof(FrameHeader)) {
+        FrameHeader header;
+        std::memcpy(&header, connection.input.data() + offset, sizeof(header));
+        if (header.payloadSize > MAX_CLIENT_FRAME_PAYLOAD) {
+            send(connection, MessageType::Error, ErrorMessage{ ProtocolError::MalformedFrame });
+            flush(connection);
+            close(connection);
+            return;
+        }
+        if (connection.input.size() - offset - sizeof(FrameHeader) < header.payloadSize) {
+            break;
+        }
+        handleFrame(connection, header, connection.input.data() + offset + sizeof(FrameHeader));
+        offset += sizeof(FrameHeader) + header.payloadSize;
+    }
+    connection.input.erase(connection.input.begin(), connection.input.begin() + offset);
+}
+
+void GameServer::flush(Connection& connection) {
+    while (connection.outputOffset < connection.output.size()) {
+        ssize_t sent = ::send(connection.fd, connection.output.data() + connection.outputOffset,
+                              connection.output.size() - connection.outputOffset, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            if (errno == EINTR) {
+                continue;
+            }
+            close(connection);
+            return;
+        }
+        connection.outputOffset += static_cast<size_t>(sent);
+    }
+
+    bool pending = connection.outputOffset < connection.output.size();
+    if (!pending) {
+        connection.output.clear();
+        connection.outputOffset = 0;
+    } else if (connection.output.size() - connection.outputOffset > MAX_PENDING_OUTPUT) {
+        close(connection);  // Client stopped reading
+        return;
+    }
+
+    // Only ask for EPOLLOUT while the socket buffer is full
+    if (pending != connection.waitingForWrite) {
+        epoll_event event = {};
+        event.events = pending ? (EPOLLIN | EPOLLOUT) : EPOLLIN;
+        event.data.fd = connection.fd;
+        epoll_ctl(epollFd, EPOLL_CTL_MOD, connection.fd, &event);
+        connection.waitingForWrite = pending;
+    }
+}
+
+void GameServer::close(Connection& connection) {
+    if (connection.fd < 0) {
+        return;
+    }
+    closedConnections.push_back(connection.fd);
+    connection.fd = -1;
+    connection.joined = false;
+}
+
+void GameServer::closeAll() {
+    for (auto& [fd, connection] : connections) {
+        ::close(fd);
+    }
+    connections.clear();
+    connectionsById.clear();
+    for (auto& [id, game] : serverGames) {
+        game.members.clear();
+    }
+    closedConnections.clear();
+
+    if (listenFd >= 0) {
+        ::close(listenFd);
+    }
+    if (epollFd >= 0) {
+        ::close(epollFd);
+    }
+    if (wakeFd >= 0) {
+        ::close(wakeFd);
+    }
+    listenFd = epollFd = wakeFd = -1;
+    port = 0;
+}
+
+#else
+
+bool GameServer::listen(uint16_t listenPort, bool loopbackOnly) {
+    lastError = "GameServer requires epoll (Linux)";
+    return false;
+}
+
+void GameServer::run() {
+}
+
+int GameServer::poll(int timeoutMs) {
+    return 0;
+}
+
+void GameServer::stop() {
+}
+
+void GameServer::flush(Connection& connection) {
+}
+
+void GameServer::close(Connection& connection) {
+}
+
+void GameServer::closeAll() {
+}
+
+void GameServer::acceptConnections() {
+}
+
+void GameServer::readFrom(Connection& connection) {
+}
+
+#endif
+
+void GameServer::handleFrame(Connection& connection, const FrameHeader& header, const uint8_t* payload) {
+    switch (header.type) {
+        case MessageType::Join: {
+            JoinMessage join;
+            if (!decodePayload(payload, header.payloadSize, join)) {
+                break;
+            }
+            handleJoin(connection, join);
+            return;
+        }
+        case MessageType::Command: {
+            CommandMessage message;
+            if (!decodePayload(payload, header.payloadSize, message)) {
+                break;
+            }
+            if (!connection.joined) {
+                send(connection, MessageType::Error, ErrorMessage{ ProtocolError::NotJoined });
+                return;
+            }
+            GameCommand command = message.command;
+            command.player = connection.player;  // Clients can only act as the player they joined as
+            uint64_t tag = (static_cast<uint64_t>(connection.id) << 32) | message.sequence;
+            if (!host.submit(connection.game, command, tag)) {
+                // The game's inbox is full: tell the client instead of queueing without bound
+                CommandResultMessage result = {};
+                result.sequence = message.sequence;
+                result.status = CommandStatus::Busy;
+                send(connection, MessageType::CommandResult, result);
+                return;
+            }
+            commandsPending = true;
+            return;
+        }
+        case MessageType::Ack: {
+            AckMessage ack;
+            if (!decodePayload(payload, header.payloadSize, ack)) {
+                break;
+            }
+            // Acks for ticks never sent would make later deltas skip changes
+            uint32_t tick = std::min(ack.tick, connection.sentTick);
+            if (tick > connection.ackedTick) {
+                connection.ackedTick = tick;
+            }
+            return;
+        }
+        default:
+            break;
+    }
+
+    send(connection, MessageType::Error, ErrorMessage{ ProtocolError::MalformedFrame });
+}
+
+void GameServer::handleJoin(Connection& connection, const JoinMessage& join) {
+    if (join.protocolVersion != PROTOCOL_VERSION) {
+        send(connection, MessageType::Error, ErrorMessage{ ProtocolError::UnsupportedVersion });
+        return;
+    }
+    GameID gameId = join.game != 0 ? join.game : defaultGame;
+    HostedGame* hosted = host.getGame(gameId);
+    if (!hosted) {
+        send(connection, MessageType::Error, ErrorMessage{ ProtocolError::UnknownGame });
+        return;
+    }
+    const GameState& state = hosted->getState();
+    if (!state.getPlayer(join.player)) {
+        send(connection, MessageType::Error, ErrorMessage{ ProtocolError::UnknownPlayer });
+        return;
+    }
+
+    leaveGame(connection);
+    ServerGame& game = serverGames[gameId];
+    game.members.push_back(&connection);
+    connection.game = gameId;
+    connection.player = join.player;
+    connection.joined = true;
+    connection.subscribed = (join.flags & JOIN_SUBSCRIBE) != 0;
+    connection.ackedTick = 0;
+    connection.sentTick = 0;
+    connection.view = ReplicationView();
+    connection.view.viewer = join.player;
+    const GameMap* map = state.getMap();
+    if (map && !game.visibility) {
+        game.visibility = std::make_unique<VisibilityMap>(map->getWidth(), map->getHeight(), map->getLevels());
+        game.visibility->update(state);
+    }
+    if (connection.subscribed && !game.replicator) {
+        game.replicator = std::make_unique<StateReplicator>(hosted->getState());
+    }
+
+    WelcomeMessage welcome = {};
+    welcome.player = join.player;
+    welcome.currentPlayer = state.getCurrentPlayer();
+    welcome.day = state.getTurnManager().getDayNumber();
+    welcome.game = gameId;
+    send(connection, MessageType::Welcome, welcome);
+}
+
+void GameServer::tickGames() {
+    host.tick();
+    commandsPending = false;
+    if (tickIntervalMs > 0) {
+        nextTick = std::chrono::steady_clock::now() + std::chrono::milliseconds(tickIntervalMs);
+    }
+
+    for (GameID game : host.getActiveGames()) {
+        for (const AppliedCommand& applied : host.getAppliedCommands(game)) {
+            sendResults(game, applied);
+        }
+    }
+}
+
+void GameServer::sendResults(GameID gameId, const AppliedCommand& applied) {
+    const GameCommand& command = applied.command;
+    const CommandOutcome& outcome = applied.outcome;
+
+    // Tag 0: applied by the host's turn handler, nobody is waiting for a result
+    if (applied.tag != 0) {
+        auto sender = connectionsById.find(static_cast<uint32_t>(applied.tag >> 32));
+        if (sender != connectionsById.end() && sender->second->joined) {
+            CommandResultMessage result = {};
+            result.sequence = static_cast<uint32_t>(applied.tag);
+            result.status = outcome.status;
+            send(*sender->second, MessageType::CommandResult, result);
+        }
+    }
+
+    auto game = serverGames.find(gameId);
+    if (outcome.succeeded() && game != serverGames.end()) {
+        // Moves and battles are only reported to players who can see where they happened
+        std::vector<uint8_t> events;
+        const Position* where = nullptr;
+        switch (command.type) {
+            case CommandType::MoveHero:
+                appendFrame(events, MessageType::HeroMoved,
+                            HeroMovedMessage{ command.hero, outcome.heroPosition, outcome.movementPoints });
+                if (outcome.claimedMine != 0) {
+                    appendFrame(events, MessageType::ObjectOwnerChanged,
+                                ObjectOwnerChangedMessage{ outcome.claimedMine, command.player, {} });
+                }
+                where = &outcome.heroPosition;
+                break;
+            case CommandType::Fight:
+                appendFrame(events, MessageType::BattleFinished,
+                            BattleFinishedMessage{ command.hero, command.objectId,
+                                                   static_cast<uint8_t>(outcome.battleResult), {},
+                                                   outcome.experienceGained });
+                if (outcome.objectRemoved) {
+                    appendFrame(events, MessageType::ObjectRemoved, ObjectRemovedMessage{ command.objectId });
+                }
+                if (const Hero* hero = host.getGame(gameId)->getState().getHero(command.hero)) {
+                    where = &hero->getPosition();
+                }
+                break;
+            case CommandType::EndTurn:
+                appendFrame(events, MessageType::TurnChanged,
+                            TurnChangedMessage{ outcome.nextPlayer, static_cast<uint8_t>(outcome.newDay), 0,
+                                                host.getGame(gameId)->getState().getTurnManager().getDayNumber() });
+                break;
+        }
+        broadcast(game->second, events, where, command.player);
+    }
+
+    if (commandListener) {
+        commandListener(gameId, command, outcome);
+    }
+}
+
+void GameServer::replicate() {
+    for (auto& [id, game] : serverGames) {
+        if (!game.replicator) {
+            continue;
+        }
+        uint32_t tick = game.replicator->getTick();
+        for (Connection* connection : game.members) {
+            if (connection->joined && connection->subscribed && connection->sentTick != tick) {
+                if (game.visibility) {
+                    game.replicator->encode(connection->ackedTick, connection->output, *game.visibility,
+                                            connection->view);
+                } else {
+                    game.replicator->encode(connection->ackedTick, connection->output);
+                }
+                connection->sentTick = tick;
+            }
+        }
+    }
+}
+
+void GameServer::broadcast(ServerGame& game, const std::vector<uint8_t>& frames, const Position* where,
+                           PlayerID actor) {
+    for (Connection* connection : game.members) {
+        bool sees = !where || !game.visibility || connection->player == actor ||
+                    game.visibility->isVisible(connection->player, *where);
+        if (connection->joined && sees) {
+            connection->output.insert(connection->output.end(), frames.begin(), frames.end());
+        }
+    }
+}
+
+void GameServer::leaveGame(Connection& connection) {
+    if (connection.game == 0) {
+        return;
+    }
+    auto game = serverGames.find(connection.game);
+    if (game != serverGames.end()) {
+        auto& members = game->second.members;
+        members.erase(std::remove(members.begin(), members.end(), &connection), members.end());
+    }
+    connection.game = 0;
+}
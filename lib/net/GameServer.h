@@ -0,0 +1,130 @@
+#pragma once
+
+#include "Protocol.h"
+#include "Replication.h"
+#include "../gamestate/GameHost.h"
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Network front end for the games of a GameHost.
+//
+// A single thread runs a non-blocking epoll loop: it accepts clients and decodes their frames.
+// Commands go to the inbox of the client's game; after each batch of network events (and every
+// tick interval, if one is set) the host ticks all games in parallel, and the server queues
+// each command's result for its sender plus the resulting events for every client in that game.
+// Clients that join with JOIN_SUBSCRIBE additionally get the state changes of their game,
+// relative to the last tick they acknowledged (see Replication.h). Both events and replicated
+// state are limited to what the client's player can see. Games are only touched by
+// the host's workers during a tick and by the thread calling run()/poll() otherwise.
+// Linux only; listen() fails elsewhere.
+class GameServer {
+public:
+    // Called on the server thread for each command applied by a tick
+    using CommandListener = std::function<void(GameID, const GameCommand&, const CommandOutcome&)>;
+
+    // Clients whose unsent output grows past this are disconnected
+    static const size_t MAX_PENDING_OUTPUT = 1 << 20;
+
+private:
+    struct Connection {
+        int fd;
+        uint32_t id;             // Unique for the server's lifetime, unlike fd; tags this client's commands
+        GameID game;
+        std::vector<uint8_t> input;
+        std::vector<uint8_t> output;
+        size_t outputOffset;     // Bytes of output already sent
+        PlayerID player;
+        bool joined;
+        bool waitingForWrite;    // Registered for EPOLLOUT because the socket buffer was full
+        bool subscribed;         // Joined with JOIN_SUBSCRIBE
+        uint32_t ackedTick;      // Last replication tick the client acknowledged, 0 for none
+        uint32_t sentTick;       // Last replication tick queued for the client
+        ReplicationView view;    // What the client has been told under fog of war
+    };
+
+    // Server-side view of one hosted game, created when the first client joins it
+    struct ServerGame {
+        std::vector<Connection*> members;
+        std::unique_ptr<VisibilityMap> visibility;     // Fog of war, for games with a map
+        std::unique_ptr<StateReplicator> replicator;   // Created when the first client subscribes
+    };
+
+    std::unique_ptr<GameHost> ownedHost;
+    GameHost& host;
+    GameID defaultGame;
+    CommandListener commandListener;
+    std::unordered_map<GameID, ServerGame> serverGames;
+    bool commandsPending;        // Submitted since the last tick
+    int tickIntervalMs;
+    std::chrono::steady_clock::time_point nextTick;
+
+    int listenFd;
+    int epollFd;
+    int wakeFd;                  // eventfd used by stop() to interrupt epoll_wait
+    uint16_t port;
+    bool running;
+    std::string lastError;
+
+    std::unordered_map<int, std::unique_ptr<Connection>> connections;
+    std::unordered_map<uint32_t, Connection*> connectionsById;
+    uint32_t nextConnectionId;
+    std::vector<int> closedConnections;   // Closed at the end of the poll iteration
+
+public:
+    // Serve a single game, which is also the default game
+    explicit GameServer(GameState& gameState, uint32_t battleSeed = 1);
+    // Serve every game of gameHost; joins naming game 0 go to defaultGame (0 for none).
+    // Takes over the host's tick listener for replication.
+    explicit GameServer(GameHost& gameHost, GameID defaultGame = 0);
+    ~GameServer();
+
+    GameServer(const GameServer&) = delete;
+    GameServer& operator=(const GameServer&) = delete;
+
+    // Bind and listen; port 0 picks a free port (see getPort). Returns false and sets getLastError().
+    bool listen(uint16_t listenPort, bool loopbackOnly = false);
+
+    // Serve until stop() is called
+    void run();
+    // Wait up to timeoutMs for network activity and handle it; returns the number of events handled
+    int poll(int timeoutMs);
+    // Make run() return. Safe to call from any thread or a signal handler.
+    void stop();
+
+    void setCommandListener(CommandListener listener) { commandListener = std::move(listener); }
+    // Also tick every intervalMs without commands, so turn handlers run; 0 ticks only on commands
+    void setTickInterval(int intervalMs);
+
+    GameHost& getHost() { return host; }
+
+    uint16_t getPort() const { return port; }
+    size_t getConnectionCount() const { return connections.size(); }
+    const std::string& getLastError() const { return lastError; }
+
+private:
+    GameServer(std::unique_ptr<GameHost> owned, GameHost* gameHost, GameID defaultGameId);
+
+    void acceptConnections();
+    void readFrom(Connection& connection);
+    void handleFrame(Connection& connection, const FrameHeader& header, const uint8_t* payload);
+    void handleJoin(Connection& connection, const JoinMessage& join);
+    void tickGames();
+    void sendResults(GameID game, const AppliedCommand& applied);
+    // Queue frames for the game's clients; with where, only for those whose player can see it
+    void broadcast(ServerGame& game, const std::vector<uint8_t>& frames, const Position* where = nullptr,
+                   PlayerID actor = 0);
+    void replicate();
+    void leaveGame(Connection& connection);
+    void flush(Connection& connection);
+    void close(Connection& connection);
+    void closeAll();
+
+    template <typename T>
+    void send(Connection& connection, MessageType type, const T& message) {
+        appendFrame(connection.output, type, message);
+    }
+};
@@ -0,0 +1,133 @@
+#include "NetClient.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#define REALMS_HAVE_SOCKETS 1
+#endif
+
+NetClient::NetClient() : fd(-1) {
+}
+
+NetClient::~NetClient() {
+    disconnect();
+}
+
+#ifdef REALMS_HAVE_SOCKETS
+
+bool NetClient::connect(const std::string& host, uint16_t port) {
+    disconnect();
+
+    addrinfo hints = {};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* addresses = nullptr;
+    if (getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &addresses) != 0 || !addresses) {
+        lastError = "Cannot resolve " + host;
+        return false;
+    }
+
+    fd = socket(addresses->ai_family, addresses->ai_socktype, addresses->ai_protocol);
+    if (fd >= 0 && ::connect(fd, addresses->ai_addr, addresses->ai_addrlen) < 0) {
+        lastError = std::string("connect: ") + std::strerror(errno);
+        ::close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(addresses);
+    if (fd < 0) {
+        return false;
+    }
+
+    int noDelay = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+    return true;
+}
+
+void NetClient::disconnect() {
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+    input.clear();
+    output.clear();
+}
+
+bool NetClient::flush() {
+    size_t offset = 0;
+    while (fd >= 0 && offset < output.size()) {
+        ssize_t sent = ::send(fd, output.data() + offset, output.size() - offset, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            lastError = std::string("send: ") + std::strerror(errno);
+            disconnect();
+            return false;
+        }
+        offset += static_cast<size_t>(sent);
+    }
+    output.clear();
+    return fd >= 0;
+}
+
+bool NetClient::receive(FrameHeader& header, std::vector<uint8_t>& payload, int timeoutMs) {
+    while (fd >= 0) {
+        if (peekFrame(input.data(), input.size(), header)) {
+            const uint8_t* start = input.data() + sizeof(FrameHeader);
+            payload.assign(start, start + header.payloadSize);
+            input.erase(input.begin(), input.begin() + sizeof(FrameHeader) + header.payloadSize);
+            return true;
+        }
+
+        pollfd readable = { fd, POLLIN, 0 };
+        int ready = ::poll(&readable, 1, timeoutMs);
+        if (ready == 0) {
+            lastError = "Timed out";
+            return false;
+        }
+        if (ready < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            lastError = std::string("poll: ") + std::strerror(errno);
+            return false;
+        }
+
+        uint8_t buffer[4096];
+        ssize_t received = recv(fd, buffer, sizeof(buffer), 0);
+        if (received <= 0) {
+            lastError = received == 0 ? "Connection closed" : std::string("recv: ") + std::strerror(errno);
+            disconnect();
+            return false;
+        }
+        input.insert(input.end(), buffer, buffer + received);
+    }
+    return false;
+}
+
+#else
+
+bool NetClient::connect(const std::string& host, uint16_t port) {
+    lastError = "Sockets are not supported on this platform";
+    return false;
+}
+
+void NetClient::disconnect() {
+}
+
+bool NetClient::flush() {
+    return false;
+}
+
+bool NetClient::receive(FrameHeader& header, std::vector<uint8_t>& payload, int timeoutMs) {
+    return false;
+}
+
+#endif
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "Protocol.h"
+#include <string>
+#include <vector>
+
+// Minimal blocking client for RealmsServer, used by tools, benchmarks and headless clients
+class NetClient {
+private:
+    int fd;
+    std::vector<uint8_t> input;
+    std::vector<uint8_t> output;
+    std::string lastError;
+
+public:
+    NetClient();
+    ~NetClient();
+
+    NetClient(const NetClient&) = delete;
+    NetClient& operator=(const NetClient&) = delete;
+
+    bool connect(const std::string& host, uint16_t port);
+    void disconnect();
+    bool isConnected() const { return fd >= 0; }
+
+    // Frames are buffered until flush(), so a client can send several in one write
+    template <typename T>
+    void queue(MessageType type, const T& message) {
+        appendFrame(output, type, message);
+    }
+    bool flush();
+
+    // Block until a whole frame arrives or timeoutMs passes (negative waits forever).
+    // The payload is returned in payload; false on timeout, disconnect or error.
+    bool receive(FrameHeader& header, std::vector<uint8_t>& payload, int timeoutMs = -1);
+
+    // Receive frames until one of the given type arrives and decode it; other frames are skipped
+    template <typename T>
+    bool receiveMessage(MessageType type, T& message, int timeoutMs = -1) {
+        FrameHeader header;
+        std::vector<uint8_t> payload;
+        while (receive(header, payload, timeoutMs)) {
+            if (header.type == type) {
+                return decodePayload(payload.data(), payload.size(), message);
+            }
+        }
+        return false;
+    }
+
+    const std::string& getLastError() const { return lastError; }
+};
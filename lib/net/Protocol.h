@@ -0,0 +1,170 @@
+#pragma once
+
+#include "../gamestate/GameHost.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+// Messages exchanged between RealmsServer and its clients over TCP.
+//
+// Every message is a frame: a 4-byte FrameHeader followed by exactly payloadSize bytes holding
+// one fixed-layout message struct, or for StateBlock a fixed header and an array of
+// fixed-layout records. Values are in native (little-endian on all supported platforms)
+// byte order. Clients send PROTOCOL_VERSION in Join; the server rejects other versions.
+const uint16_t PROTOCOL_VERSION = 3;
+const size_t MAX_FRAME_PAYLOAD = 65535;        // Limited by FrameHeader::payloadSize
+const size_t MAX_CLIENT_FRAME_PAYLOAD = 1024;  // Clients only send small fixed messages
+
+enum class MessageType : uint8_t {
+    // Client -> server
+    Join = 1,
+    Command = 2,
+    Ack = 3,
+
+    // Server -> client
+    Welcome = 64,
+    CommandResult,
+    HeroMoved,
+    TurnChanged,
+    BattleFinished,
+    ObjectRemoved,
+    ObjectOwnerChanged,
+    Error,
+
+    // State replication, see Replication.h
+    StateBegin = 96,
+    StateBlock,
+    StateEnd
+};
+
+struct FrameHeader {
+    uint16_t payloadSize;
+    MessageType type;
+    uint8_t reserved;
+};
+
+const uint8_t JOIN_SUBSCRIBE = 1;  // Receive state replication (and send Acks)
+
+struct JoinMessage {
+    uint16_t protocolVersion;
+    PlayerID player;
+    uint8_t flags;            // JOIN_* bits
+    GameID game;              // 0 for the server's default game
+};
+
+// The client has applied every state update up to and including tick
+struct AckMessage {
+    uint32_t tick;
+};
+
+struct CommandMessage {
+    uint32_t sequence;        // Chosen by the client, echoed in the CommandResult
+    GameCommand command;      // command.player is ignored; the server uses the joined player
+};
+
+struct WelcomeMessage {
+    PlayerID player;
+    PlayerID currentPlayer;
+    uint16_t reserved;
+    int32_t day;
+    GameID game;
+};
+
+struct CommandResultMessage {
+    uint32_t sequence;
+    CommandStatus status;
+    uint8_t reserved[3];
+};
+
+struct HeroMovedMessage {
+    HeroID hero;
+    Position position;
+    int32_t movementPoints;
+};
+
+struct TurnChangedMessage {
+    PlayerID currentPlayer;
+    uint8_t newDay;
+    uint16_t reserved;
+    int32_t day;
+};
+
+struct BattleFinishedMessage {
+    HeroID hero;
+    uint32_t objectId;
+    uint8_t result;           // BattleResult
+    uint8_t reserved[3];
+    int32_t experienceGained;
+};
+
+struct ObjectRemovedMessage {
+    uint32_t objectId;
+};
+
+struct ObjectOwnerChangedMessage {
+    uint32_t objectId;
+    PlayerID owner;
+    uint8_t reserved[3];
+};
+
+enum class ProtocolError : uint8_t {
+    MalformedFrame,
+    UnsupportedVersion,
+    UnknownPlayer,
+    NotJoined,
+    UnknownGame
+};
+
+struct ErrorMessage {
+    ProtocolError code;
+};
+
+// Append one frame holding message to out
+template <typename T>
+void appendFrame(std::vector<uint8_t>& out, MessageType type, const T& message) {
+    static_assert(std::is_trivially_copyable<T>::value, "messages must be plain data");
+    static_assert(sizeof(T) <= MAX_FRAME_PAYLOAD, "message too large for a frame");
+    FrameHeader header = { static_cast<uint16_t>(sizeof(T)), type, 0 };
+    const uint8_t* headerBytes = reinterpret_cast<const uint8_t*>(&header);
+    const uint8_t* messageBytes = reinterpret_cast<const uint8_t*>(&message);
+    out.insert(out.end(), headerBytes, headerBytes + sizeof(header));
+    out.insert(out.end(), messageBytes, messageBytes + sizeof(T));
+}
+
+// Append one frame holding a fixed header followed by count records
+template <typename Header, typename Record>
+void appendFrame(std::vector<uint8_t>& out, MessageType type, const Header& header, const Record* records,
+                 size_t count) {
+    static_assert(std::is_trivially_copyable<Header>::value && std::is_trivially_copyable<Record>::value,
+                  "messages must be plain data");
+    size_t payloadSize = sizeof(Header) + count * sizeof(Record);
+    FrameHeader frame = { static_cast<uint16_t>(payloadSize), type, 0 };
+    const uint8_t* frameBytes = reinterpret_cast<const uint8_t*>(&frame);
+    const uint8_t* headerBytes = reinterpret_cast<const uint8_t*>(&header);
+    const uint8_t* recordBytes = reinterpret_cast<const uint8_t*>(records);
+    out.insert(out.end(), frameBytes, frameBytes + sizeof(frame));
+    out.insert(out.end(), headerBytes, headerBytes + sizeof(header));
+    out.insert(out.end(), recordBytes, recordBytes + count * sizeof(Record));
+}
+
+// Read the header of the frame at the start of data. Returns false until the whole frame is there.
+inline bool peekFrame(const uint8_t* data, size_t size, FrameHeader& header) {
+    if (size < sizeof(FrameHeader)) {
+        return false;
+    }
+    std::memcpy(&header, data, sizeof(header));
+    return size - sizeof(FrameHeader) >= header.payloadSize;
+}
+
+// Copy a frame payload into message; false if the payload has the wrong size for T
+template <typename T>
+bool decodePayload(const uint8_t* payload, size_t payloadSize, T& message) {
+    static_assert(std::is_trivially_copyable<T>::value, "messages must be plain data");
+    if (payloadSize != sizeof(T)) {
+        return false;
+    }
+    std::memcpy(&message, payload, sizeof(T));
+    return true;
+}
@@ -0,0 +1,490 @@
+#include "Replication.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+// Records per StateBlock frame, limited by the 16-bit frame size and record count
+template <typename Record>
+size_t recordsPerBlock() {
+    size_t byBytes = (MAX_FRAME_PAYLOAD - sizeof(StateBlockHeader)) / sizeof(Record);
+    return byBytes < 0xFFFF ? byBytes : 0xFFFF;
+}
+
+template <typename Record>
+void appendBlocks(std::vector<uint8_t>& out, uint32_t tick, RecordType type, const std::vector<Record>& records) {
+    const size_t perBlock = recordsPerBlock<Record>();
+    for (size_t first = 0; first < records.size(); first += perBlock) {
+        size_t count = std::min(perBlock, records.size() - first);
+        StateBlockHeader header = { tick, type, 0, static_cast<uint16_t>(count) };
+        appendFrame(out, MessageType::StateBlock, header, records.data() + first, count);
+    }
+}
+
+template <typename Record, typename Apply>
+void applyRecords(const uint8_t* records, size_t count, Apply apply) {
+    for (size_t i = 0; i < count; i++) {
+        Record record;
+        std::memcpy(&record, records + i * sizeof(Record), sizeof(Record));
+        apply(record);
+    }
+}
+
+} // namespace
+
+bool HeroState::operator==(const HeroState& other) const {
+    return std::memcmp(this, &other, sizeof(HeroState)) == 0;
+}
+
+bool ResourcesState::operator==(const ResourcesState& other) const {
+    return std::memcmp(this, &other, sizeof(ResourcesState)) == 0;
+}
+
+bool ObjectState::operator==(const ObjectState& other) const {
+    return std::memcmp(this, &other, sizeof(ObjectState)) == 0;
+}
+
+StateReplicator::StateReplicator(GameState& gameState)
+    : state(gameState), map(gameState.getMap()), tileListenerId(0), tick(0), tileHistory(HISTORY_TICKS) {
+    if (map) {
+        tileTick.assign(map->getTileCount(), 0);
+        hiddenTiles.reserve(map->getTileCount());
+        for (size_t i = 0; i < map->getTileCount(); i++) {
+            hiddenTiles.push_back(describeHiddenTile(map->getTileData()[i]));
+        }
+        hiddenTick.assign(map->getTileCount(), 0);
+        tileListenerId = map->addTileChangeListener([this](const Position& pos) {
+            pendingTiles.push_back(static_cast<uint32_t>(map->getTileIndex(pos.x, pos.y, pos.z)));
+        });
+    }
+    capture();
+}
+
+StateReplicator::~StateReplicator() {
+    if (map) {
+        map->removeTileChangeListener(tileListenerId);
+    }
+}
+
+HeroState StateReplicator::describeHero(const Hero& hero, PlayerID owner) {
+    HeroState record = {};
+    record.id = hero.getId();
+    record.owner = owner;
+    record.heroClass = static_cast<uint8_t>(hero.getHeroClass());
+    record.level = static_cast<uint16_t>(hero.getLevel());
+    record.position = hero.getPosition();
+    record.movementPoints = hero.getMovementPoints();
+    record.attack = hero.getAttack();
+    record.defense = hero.getDefense();
+    record.spellPower = hero.getSpellPower();
+    record.knowledge = hero.getKnowledge();
+    record.mana = hero.getMana();
+    record.experience = hero.getExperience();
+    for (int slot = 0; slot < Army::MAX_SLOTS; slot++) {
+        record.army[slot] = hero.getArmy().getSlot(slot);
+    }
+    return record;
+}
+
+ResourcesState StateReplicator::describeResources(const Player& player) {
+    ResourcesState record = {};
+    record.player = player.getId();
+    for (int i = 0; i < 7; i++) {
+        record.amounts[i] = player.getResources()[static_cast<ResourceType>(i)];
+    }
+    return record;
+}
+
+ObjectState StateReplicator::describeObject(const MapObject& object) {
+    ObjectState record = {};
+    record.id = object.getId();
+    record.type = object.getType();
+    record.blocksMovement = object.blocksMovement() ? 1 : 0;
+    record.position = object.getPosition();
+    if (const ResourceMine* mine = dynamic_cast<const ResourceMine*>(&object)) {
+        record.owner = mine->getOwner();
+        record.subtype = static_cast<uint32_t>(mine->getResourceType());
+        record.amount = mine->getDailyProduction();
+    } else if (const MonsterGroup* monsters = dynamic_cast<const MonsterGroup*>(&object)) {
+        record.subtype = monsters->getCreatureType();
+        record.amount = monsters->getCount();
+    }
+    return record;
+}
+
+MapTile StateReplicator::describeHiddenTile(const MapTile& tile) {
+    MapTile record(tile.terrain);
+    record.movementCost = tile.movementCost;
+    return record;
+}
+
+uint32_t StateReplicator::capture() {
+    const uint32_t next = tick + 1;
+    bool changed = false;
+
+    // Tiles reported by the map since the last capture, each listed once
+    std::vector<uint32_t>& changedTiles = tileHistory[next % HISTORY_TICKS];
+    changedTiles.clear();
+    for (uint32_t index : pendingTiles) {
+        if (tileTick[index] != next) {
+            tileTick[index] = next;
+            changedTiles.push_back(index);
+            MapTile hidden = describeHiddenTile(map->getTileData()[index]);
+            if (std::memcmp(&hidden, &hiddenTiles[index], sizeof(MapTile)) != 0) {
+                hiddenTiles[index] = hidden;
+                hiddenTick[index] = next;
+            }
+        }
+    }
+    pendingTiles.clear();
+    changed |= !changedTiles.empty();
+
+    for (const auto& [playerId, player] : state.getAllPlayers()) {
+        ResourcesState record = describeResources(*player);
+        auto it = resources.find(playerId);
+        if (it == resources.end() || !(it->second.record == record)) {
+            resources[playerId] = { record, next };
+            changed = true;
+        }
+    }
+
+    for (const auto& [heroId, hero] : state.getAllHeroes()) {
+        HeroState record = describeHero(*hero, state.getHeroOwner(heroId));
+        auto it = heroes.find(heroId);
+        if (it == heroes.end() || !(it->second.record == record)) {
+            heroes[heroId] = { record, next };
+            changed = true;
+        }
+    }
+    for (auto it = heroes.begin(); it != heroes.end();) {
+        if (!state.getHero(it->first)) {
+            heroRemovals.emplace_back(it->first, next);
+            it = heroes.erase(it);
+            changed = true;
+        } else {
+            ++it;
+        }
+    }
+
+    if (map) {
+        for (const auto& object : map->getAllObjects()) {
+            ObjectState record = describeObject(*object);
+            auto it = objects.find(record.id);
+            if (it == objects.end() || !(it->second.record == record)) {
+                objects[record.id] = { record, next };
+                changed = true;
+            }
+        }
+        for (auto it = objects.begin(); it != objects.end();) {
+            if (!map->getObject(it->first)) {
+                removals.emplace_back(it->first, next);
+                it = objects.erase(it);
+                changed = true;
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    if (changed) {
+        tick = next;
+        // Removals older than the history can no longer be asked for
+        while (!removals.empty() && tick - removals.front().second >= HISTORY_TICKS) {
+            removals.erase(removals.begin());
+        }
+        while (!heroRemovals.empty() && tick - heroRemovals.front().second >= HISTORY_TICKS) {
+            heroRemovals.erase(heroRemovals.begin());
+        }
+    }
+    return tick;
+}
+
+bool StateReplicator::isFullSnapshot(uint32_t baseTick) const {
+    return baseTick == 0 || baseTick > tick || tick - baseTick >= HISTORY_TICKS;
+}
+
+void StateReplicator::encode(uint32_t baseTick, std::vector<uint8_t>& out) const {
+    encodeFiltered(baseTick, out, nullptr, nullptr);
+}
+
+void StateReplicator::encode(uint32_t baseTick, std::vector<uint8_t>& out, const VisibilityMap& visibility,
+                             ReplicationView& view) const {
+    encodeFiltered(baseTick, out, &visibility, &view);
+}
+
+void StateReplicator::encodeFiltered(uint32_t baseTick, std::vector<uint8_t>& out, const VisibilityMap* visibility,
+                                     ReplicationView* view) const {
+    bool full = isFullSnapshot(baseTick);
+    if (full) {
+        baseTick = 0;
+        if (view) {
+            view->knownHeroes.clear();
+            view->knownObjects.clear();
+        }
+    }
+
+    // Whether to send a record: changed since baseTick, or just come into view. Records that
+    // left the view are collected as removals.
+    auto select = [baseTick, view](uint32_t id, uint32_t changedTick, bool inView,
+                                   std::unordered_set<uint32_t>& known, auto& removed) {
+        if (!view) {
+            return changedTick > baseTick;
+        }
+        if (!inView) {
+            if (known.erase(id)) {
+                removed.push_back({ id });
+            }
+            return false;
+        }
+        return known.insert(id).second || changedTick > baseTick;
+    };
+
+    StateBeginMessage begin = {};
+    begin.tick = tick;
+    begin.baseTick = baseTick;
+    if (map) {
+        begin.width = map->getWidth();
+        begin.height = map->getHeight();
+        begin.levels = map->getLevels();
+    }
+    appendFrame(out, MessageType::StateBegin, begin);
+
+    std::unordered_set<uint32_t> noneKnown;
+    std::vector<HeroState> heroRecords;
+    std::vector<HeroRemovedState> heroRemovalRecords;
+    if (!full) {
+        for (const auto& [id, removedTick] : heroRemovals) {
+            if (removedTick <= baseTick || heroes.count(id)) {
+                continue;
+            }
+            if (!view || view->knownHeroes.erase(id)) {
+                heroRemovalRecords.push_back({ id });
+            }
+        }
+    }
+    for (const auto& [id, tracked] : heroes) {
+        const HeroState& record = tracked.record;
+        bool inView = view && (record.owner == view->viewer || visibility->isVisible(view->viewer, record.position));
+        if (select(id, tracked.tick, inView, view ? view->knownHeroes : noneKnown, heroRemovalRecords)) {
+            heroRecords.push_back(record);
+        }
+    }
+    appendBlocks(out, tick, RecordType::HeroRemoved, heroRemovalRecords);
+    appendBlocks(out, tick, RecordType::Hero, heroRecords);
+
+    std::vector<ResourcesState> resourceRecords;
+    for (const auto& [id, tracked] : resources) {
+        if (tracked.tick > baseTick && (!view || id == view->viewer)) {
+            resourceRecords.push_back(tracked.record);
+        }
+    }
+    appendBlocks(out, tick, RecordType::Resources, resourceRecords);
+
+    std::vector<TileState> tileRecords;
+    if (map && view) {
+        collectFilteredTiles(full, baseTick, *visibility, *view, tileRecords);
+    } else if (map && full) {
+        tileRecords.reserve(map->getTileCount());
+        const MapTile* mapTiles = map->getTileData();
+        for (size_t i = 0; i < map->getTileCount(); i++) {
+            tileRecords.push_back({ static_cast<uint32_t>(i), mapTiles[i] });
+        }
+    } else if (map) {
+        // Each tile is listed under the tick of its latest change only
+        for (uint32_t t = baseTick + 1; t <= tick; t++) {
+            for (uint32_t index : tileHistory[t % HISTORY_TICKS]) {
+                if (tileTick[index] == t) {
+                    tileRecords.push_back({ index, map->getTileData()[index] });
+                }
+            }
+        }
+    }
+    appendBlocks(out, tick, RecordType::Tile, tileRecords);
+
+    std::vector<ObjectRemovedState> removalRecords;
+    if (!full) {
+        for (const auto& [id, removedTick] : removals) {
+            if (removedTick <= baseTick || objects.count(id)) {
+                continue;
+            }
+            if (!view || view->knownObjects.erase(id)) {
+                removalRecords.push_back({ id });
+            }
+        }
+    }
+
+    std::vector<ObjectState> objectRecords;
+    for (const auto& [id, tracked] : objects) {
+        const ObjectState& record = tracked.record;
+        bool inView = view && ((record.owner != 0 && record.owner == view->viewer) ||
+                               visibility->isVisible(view->viewer, record.position));
+        if (select(id, tracked.tick, inView, view ? view->knownObjects : noneKnown, removalRecords)) {
+            objectRecords.push_back(record);
+        }
+    }
+    appendBlocks(out, tick, RecordType::ObjectRemoved, removalRecords);
+    appendBlocks(out, tick, RecordType::Object, objectRecords);
+
+    appendFrame(out, MessageType::StateEnd, StateEndMessage{ tick });
+}
+
+void StateReplicator::collectFilteredTiles(bool full, uint32_t baseTick, const VisibilityMap& visibility,
+                                           ReplicationView& view, std::vector<TileState>& records) const {
+    static const std::vector<uint64_t> noneVisible;
+    const std::vector<uint64_t>* plane = visibility.getVisiblePlane(view.viewer);
+    const std::vector<uint64_t>& visible = plane ? *plane : noneVisible;
+    const uint64_t version = visibility.getVersion(view.viewer);
+    const size_t wordsPerRow = visibility.getWordsPerRow();
+    const size_t width = static_cast<size_t>(map->getWidth());
+    const MapTile* mapTiles = map->getTileData();
+
+    auto isSet = [wordsPerRow, width](const std::vector<uint64_t>& bits, size_t index) {
+        size_t word = index / width * wordsPerRow + index % width / 64;
+        return word < bits.size() && ((bits[word] >> (index % width % 64)) & 1);
+    };
+    auto describe = [&](size_t index, bool inView) {
+        records.push_back({ static_cast<uint32_t>(index), inView ? mapTiles[index] : hiddenTiles[index] });
+    };
+
+    if (full) {
+        records.reserve(map->getTileCount());
+        for (size_t i = 0; i < map->getTileCount(); i++) {
+            describe(i, isSet(visible, i));
+        }
+    } else {
+        // Changed tiles whose visibility has not changed since the last encode; out of sight,
+        // only changes to what a hidden tile shows count
+        bool visibilityChanged = version != view.sentVersion;
+        for (uint32_t t = baseTick + 1; t <= tick; t++) {
+            for (uint32_t index : tileHistory[t % HISTORY_TICKS]) {
+                if (tileTick[index] != t) {
+                    continue;
+                }
+                bool inView = isSet(visible, index);
+                if (visibilityChanged && inView != isSet(view.sentVisible, index)) {
+                    continue;
+                }
+                if (inView || hiddenTick[index] > baseTick) {
+                    describe(index, inView);
+                }
+            }
+        }
+
+        // Tiles that came into or went out of sight since the last encode
+        if (visibilityChanged) {
+            size_t words = std::max(visible.size(), view.sentVisible.size());
+            for (size_t word = 0; word < words; word++) {
+                uint64_t now = word < visible.size() ? visible[word] : 0;
+                uint64_t before = word < view.sentVisible.size() ? view.sentVisible[word] : 0;
+                uint64_t flipped = now ^ before;
+                for (int bit = 0; flipped != 0 && bit < 64; bit++) {
+                    size_t x = word % wordsPerRow * 64 + bit;
+                    if (((flipped >> bit) & 1) && x < width) {
+                        describe(word / wordsPerRow * width + x, (now >> bit) & 1);
+                    }
+                }
+            }
+        }
+    }
+
+    if (full || version != view.sentVersion) {
+        view.sentVisible = visible;
+        view.sentVersion = version;
+    }
+}
+
+StateReplica::StateReplica() : tick(0), pendingTick(0), width(0), height(0), levels(0) {
+}
+
+bool StateReplica::applyFrame(const FrameHeader& header, const uint8_t* payload) {
+    switch (header.type) {
+        case MessageType::StateBegin: {
+            StateBeginMessage begin;
+            if (!decodePayload(payload, header.payloadSize, begin)) {
+                throw std::runtime_error("Malformed StateBegin");
+            }
+            if (begin.baseTick == 0) {
+                if (begin.width < 0 || begin.height < 0 || begin.levels < 0) {
+                    throw std::runtime_error("Malformed StateBegin");
+                }
+                width = begin.width;
+                height = begin.height;
+                levels = begin.levels;
+                tiles.assign(static_cast<size_t>(width) * height * levels, MapTile());
+                heroes.clear();
+                resources.clear();
+                objects.clear();
+            } else if (begin.baseTick > tick) {
+                throw std::runtime_error("State update is based on a tick this replica has not seen");
+            }
+            pendingTick = begin.tick;
+            return false;
+        }
+        case MessageType::StateBlock: {
+            StateBlockHeader block;
+            if (header.payloadSize < sizeof(block)) {
+                throw std::runtime_error("Malformed StateBlock");
+            }
+            std::memcpy(&block, payload, sizeof(block));
+            const uint8_t* records = payload + sizeof(block);
+            size_t recordBytes = header.payloadSize - sizeof(block);
+
+            auto checkSize = [&](size_t recordSize) {
+                if (recordBytes != block.count * recordSize) {
+                    throw std::runtime_error("Malformed StateBlock");
+                }
+            };
+
+            switch (block.recordType) {
+                case RecordType::Hero:
+                    checkSize(sizeof(HeroState));
+                    applyRecords<HeroState>(records, block.count,
+                        [this](const HeroState& record) { heroes[record.id] = record; });
+                    break;
+                case RecordType::Resources:
+                    checkSize(sizeof(ResourcesState));
+                    applyRecords<ResourcesState>(records, block.count,
+                        [this](const ResourcesState& record) { resources[record.player] = record; });
+                    break;
+                case RecordType::Tile:
+                    checkSize(sizeof(TileState));
+                    applyRecords<TileState>(records, block.count, [this](const TileState& record) {
+                        if (record.index >= tiles.size()) {
+                            throw std::runtime_error("Tile index out of range");
+                        }
+                        tiles[record.index] = record.tile;
+                    });
+                    break;
+                case RecordType::Object:
+                    checkSize(sizeof(ObjectState));
+                    applyRecords<ObjectState>(records, block.count,
+                        [this](const ObjectState& record) { objects[record.id] = record; });
+                    break;
+                case RecordType::ObjectRemoved:
+                    checkSize(sizeof(ObjectRemovedState));
+                    applyRecords<ObjectRemovedState>(records, block.count,
+                        [this](const ObjectRemovedState& record) { objects.erase(record.id); });
+                    break;
+                case RecordType::HeroRemoved:
+                    checkSize(sizeof(HeroRemovedState));
+                    applyRecords<HeroRemovedState>(records, block.count,
+                        [this](const HeroRemovedState& record) { heroes.erase(record.id); });
+                    break;
+                default:
+                    throw std::runtime_error("Unknown state record type");
+            }
+            return false;
+        }
+        case MessageType::StateEnd: {
+            StateEndMessage end;
+            if (!decodePayload(payload, header.payloadSize, end) || end.tick != pendingTick) {
+                throw std::runtime_error("Malformed StateEnd");
+            }
+            tick = end.tick;
+            return true;
+        }
+        default:
+            return false;
+    }
+}
@@ -0,0 +1,211 @@
+#pragma once
+
+#include "Protocol.h"
+#include "../gamestate/Visibility.h"
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// State replication from RealmsServer to subscribed clients.
+//
+// The server advances a tick whenever a capture finds changes. A client receives the changes
+// between the last tick it acknowledged and the current one as
+//   StateBegin, StateBlock*, StateEnd
+// frames, and answers with an Ack once it has applied them. Clients that have not acknowledged
+// anything yet, or whose ack has fallen out of the change history, get a full snapshot instead.
+// Each StateBlock carries records of one type; every record is self-contained, so applying
+// the same change twice is harmless. Heroes and objects that leave the game are sent as
+// HeroRemoved/ObjectRemoved.
+//
+// With fog of war, a client only hears about heroes and objects its player can see (and its own
+// heroes and mines). Things that come into view are sent even if they did not change; things
+// that leave it are sent as HeroRemoved/ObjectRemoved. Every tile is sent, but one out of sight
+// only shows its terrain and movement cost: the hero or object standing on it, and the blocked
+// passability that comes with one, are cleared, and changes to those alone are not sent.
+
+enum class RecordType : uint8_t {
+    Hero,
+    Resources,
+    Tile,
+    Object,
+    ObjectRemoved,
+    HeroRemoved       // Removed from the game, or out of sight
+};
+
+struct HeroState {
+    HeroID id;
+    PlayerID owner;           // 0 if no player lists the hero
+    uint8_t heroClass;        // HeroClass
+    uint16_t level;
+    Position position;
+    int32_t movementPoints;
+    int32_t attack;
+    int32_t defense;
+    int32_t spellPower;
+    int32_t knowledge;
+    int32_t mana;
+    int32_t experience;
+    ArmySlot army[Army::MAX_SLOTS];
+
+    bool operator==(const HeroState& other) const;
+};
+
+struct ResourcesState {
+    PlayerID player;
+    uint8_t reserved[3];
+    int32_t amounts[7];       // Indexed by ResourceType
+
+    bool operator==(const ResourcesState& other) const;
+};
+
+struct TileState {
+    uint32_t index;           // GameMap tile index
+    MapTile tile;
+};
+
+struct ObjectState {
+    uint32_t id;
+    ObjectType type;
+    uint8_t blocksMovement;
+    PlayerID owner;           // Mines
+    uint8_t reserved;
+    Position position;
+    uint32_t subtype;         // ResourceType for mines, CreatureID for monster groups
+    int32_t amount;           // Daily production for mines, creature count for monster groups
+
+    bool operator==(const ObjectState& other) const;
+};
+
+struct ObjectRemovedState {
+    uint32_t id;
+};
+
+struct HeroRemovedState {
+    HeroID id;
+};
+
+struct StateBeginMessage {
+    uint32_t tick;
+    uint32_t baseTick;        // 0 for a full snapshot; the client must drop its previous state
+    int32_t width;            // Map size, so a snapshot can size the tile array
+    int32_t height;
+    int32_t levels;
+};
+
+struct StateBlockHeader {
+    uint32_t tick;
+    RecordType recordType;
+    uint8_t reserved;
+    uint16_t count;
+};
+
+struct StateEndMessage {
+    uint32_t tick;
+};
+
+static_assert(sizeof(HeroState) == 104, "HeroState layout changed");
+static_assert(sizeof(ResourcesState) == 32, "ResourcesState layout changed");
+static_assert(sizeof(TileState) == 16, "TileState layout changed");
+static_assert(sizeof(ObjectState) == 28, "ObjectState layout changed");
+
+// What one fog-of-war filtered client has been told about, kept by the server per client
+struct ReplicationView {
+    PlayerID viewer = 0;
+    std::unordered_set<HeroID> knownHeroes;
+    std::unordered_set<uint32_t> knownObjects;
+    std::vector<uint64_t> sentVisible;   // Visible plane the tiles sent so far were filtered by
+    uint64_t sentVersion = 0;            // Its VisibilityMap version
+};
+
+// Server side: detects changes in a GameState and encodes them per client.
+// Bound to the map present at construction; tile changes are picked up through the map's
+// tile change notifications, everything else by comparing against the last capture.
+class StateReplicator {
+public:
+    // Ticks of tile and removal history kept for deltas; older acks get a full snapshot
+    static const uint32_t HISTORY_TICKS = 64;
+
+private:
+    GameState& state;
+    GameMap* map;
+    int tileListenerId;
+    uint32_t tick;
+
+    std::vector<uint32_t> pendingTiles;                 // Reported since the last capture
+    std::vector<uint32_t> tileTick;                     // Tick of each tile's latest change
+    std::vector<std::vector<uint32_t>> tileHistory;     // Tiles changed per tick, ring of HISTORY_TICKS
+    std::vector<MapTile> hiddenTiles;                   // Each tile as shown out of sight, as last captured
+    std::vector<uint32_t> hiddenTick;                   // Tick of the latest change to that
+
+    template <typename Record>
+    struct Tracked {
+        Record record;
+        uint32_t tick;
+    };
+    std::unordered_map<HeroID, Tracked<HeroState>> heroes;
+    std::unordered_map<PlayerID, Tracked<ResourcesState>> resources;
+    std::unordered_map<uint32_t, Tracked<ObjectState>> objects;
+    std::vector<std::pair<uint32_t, uint32_t>> removals;      // (object id, tick)
+    std::vector<std::pair<HeroID, uint32_t>> heroRemovals;    // (hero id, tick)
+
+public:
+    explicit StateReplicator(GameState& gameState);
+    ~StateReplicator();
+
+    StateReplicator(const StateReplicator&) = delete;
+    StateReplicator& operator=(const StateReplicator&) = delete;
+
+    // Look for changes since the last capture; advances and returns the tick if there were any
+    uint32_t capture();
+    uint32_t getTick() const { return tick; }
+
+    // Append the frames that bring a client from baseTick to the current tick.
+    // baseTick 0, or one older than the history, produces a full snapshot.
+    void encode(uint32_t baseTick, std::vector<uint8_t>& out) const;
+    // The same for one player's client under fog of war; updates what view has been told
+    void encode(uint32_t baseTick, std::vector<uint8_t>& out, const VisibilityMap& visibility,
+                ReplicationView& view) const;
+
+    static HeroState describeHero(const Hero& hero, PlayerID owner);
+    static ResourcesState describeResources(const Player& player);
+    static ObjectState describeObject(const MapObject& object);
+    // A tile as shown to a player who cannot see it: terrain and movement cost only
+    static MapTile describeHiddenTile(const MapTile& tile);
+
+private:
+    bool isFullSnapshot(uint32_t baseTick) const;
+    void encodeFiltered(uint32_t baseTick, std::vector<uint8_t>& out, const VisibilityMap* visibility,
+                        ReplicationView* view) const;
+    void collectFilteredTiles(bool full, uint32_t baseTick, const VisibilityMap& visibility,
+                              ReplicationView& view, std::vector<TileState>& records) const;
+};
+
+// Client side mirror of the replicated state
+class StateReplica {
+private:
+    uint32_t tick;
+    uint32_t pendingTick;     // Tick being received between StateBegin and StateEnd
+    int width;
+    int height;
+    int levels;
+    std::vector<MapTile> tiles;
+    std::unordered_map<HeroID, HeroState> heroes;
+    std::unordered_map<PlayerID, ResourcesState> resources;
+    std::unordered_map<uint32_t, ObjectState> objects;
+
+public:
+    StateReplica();
+
+    // Apply one replication frame. Returns true when it completed a tick (acknowledge getTick()).
+    // Frames of other types are ignored; malformed frames throw std::runtime_error.
+    bool applyFrame(const FrameHeader& header, const uint8_t* payload);
+
+    uint32_t getTick() const { return tick; }
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    int getLevels() const { return levels; }
+    const std::vector<MapTile>& getTiles() const { return tiles; }
+    const std::unordered_map<HeroID, HeroState>& getHeroes() const { return heroes; }
+    const std::unordered_map<PlayerID, ResourcesState>& getResources() const { return resources; }
+    const std::unordered_map<uint32_t, ObjectState>& getObjects() const { return objects; }
+};
@@ -1,30 +1,218 @@
+#include <algorithm>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <string>
 #include "../lib/gamestate/GameState.h"
+#include "../lib/gamestate/AutoSaver.h"
+#include "../lib/gamestate/CommandLog.h"
+#include "../lib/net/GameServer.h"
+#include "../lib/ai/AdventureAI.h"
 
-int main(int argc, char* argv[]) {
-    std::cout << "Realms of Eldoria Server starting..." << std::endl;
-    
-    GameState gameState;
-    
-    // Create a simple server game state
-    auto player1 = std::make_unique<Player>(1, "Server Player 1", Faction::Castle, false);
-    auto player2 = std::make_unique<Player>(2, "Server Player 2", Faction::Rampart, false);
-    
+namespace {
+
+const uint16_t DEFAULT_PORT = 7777;
+const int DEFAULT_GAMES = 1;
+const int AI_TICK_INTERVAL_MS = 50;   // Lets computer players move while no client is sending
+
+GameServer* activeServer = nullptr;
+
+void handleSignal(int) {
+    if (activeServer) {
+        activeServer->stop();
+    }
+}
+
+// The last aiPlayers players are computer-controlled
+void createServerGame(GameState& gameState, int aiPlayers) {
+    auto player1 = std::make_unique<Player>(1, "Server Player 1", Faction::Castle, aiPlayers < 2);
+    auto player2 = std::make_unique<Player>(2, "Server Player 2", Faction::Rampart, aiPlayers < 1);
+
+    auto map = std::make_unique<GameMap>(64, 64, 1);
+    map->setName("Server Skirmish");
+
+    // One hero per player in opposite corners
+    auto hero1 = std::make_unique<Hero>(1, "Sir Aldric", HeroClass::Knight, Gender::Male);
+    hero1->setPrimaryStats(5, 4, 2, 2);
+    hero1->setPosition(Position(4, 4, 0));
+    hero1->getArmy().addCreatures(1, 20);
+    hero1->getArmy().addCreatures(2, 8);
+    hero1->resetMovementPoints();
+    map->moveHero(1, Position(4, 4, 0), Position(4, 4, 0));
+
+    auto hero2 = std::make_unique<Hero>(2, "Lady Morgana", HeroClass::Wizard, Gender::Female);
+    hero2->setPrimaryStats(3, 4, 8, 7);
+    hero2->setPosition(Position(59, 59, 0));
+    hero2->getArmy().addCreatures(1, 15);
+    hero2->getArmy().addCreatures(2, 10);
+    hero2->resetMovementPoints();
+    map->moveHero(2, Position(59, 59, 0), Position(59, 59, 0));
+
+    player1->addHero(1);
+    player2->addHero(2);
+
+    map->addObject(std::make_unique<ResourceMine>(100, Position(10, 10, 0), ResourceType::Gold, 1000));
+    map->addObject(std::make_unique<ResourceMine>(101, Position(53, 53, 0), ResourceType::Gold, 1000));
+    map->addObject(std::make_unique<ResourceMine>(102, Position(32, 20, 0), ResourceType::Wood, 2));
+    map->addObject(std::make_unique<MonsterGroup>(200, Position(16, 16, 0), 1, 12));
+    map->addObject(std::make_unique<MonsterGroup>(201, Position(47, 47, 0), 1, 12));
+    map->addObject(std::make_unique<MonsterGroup>(202, Position(32, 32, 0), 2, 6));
+
+    gameState.addHero(std::move(hero1));
+    gameState.addHero(std::move(hero2));
     gameState.addPlayer(std::move(player1));
     gameState.addPlayer(std::move(player2));
-    
-    gameState.startGame();
-    
-    std::cout << "Server initialized with " << gameState.getAllPlayers().size() << " players." << std::endl;
-    std::cout << "Current player: " << gameState.getCurrentPlayer() << std::endl;
-    
-    // Simple server loop (placeholder)
-    for (int turn = 0; turn < 5; turn++) {
-        std::cout << "Processing turn " << gameState.getTurnManager().getTurnNumber() << std::endl;
-        gameState.nextTurn();
-        gameState.processDailyEvents();
-    }
-    
+    gameState.setMap(std::move(map));
+}
+
+void printStats(const GameHost& host) {
+    const HostTickStats& stats = host.getStats();
+    std::cout << "Ticks: " << stats.ticks << ", mean " << stats.meanTickMs() << " ms, max "
+              << stats.maxTickMs << " ms; last tick per-game latency p50 " << stats.lastLatencyP50Ms
+              << " ms, p99 " << stats.lastLatencyP99Ms << " ms" << std::endl;
+}
+
+const char* commandTypeName(CommandType type) {
+    switch (type) {
+        case CommandType::MoveHero: return "move";
+        case CommandType::EndTurn: return "end turn";
+        case CommandType::Fight: return "fight";
+    }
+    return "unknown";
+}
+
+// Headless fast-forward of a command log written with --record
+int replayLog(const std::string& path) {
+    ReplayReport report;
+    try {
+        report = CommandReplayer::replay(path);
+    } catch (const std::exception& e) {
+        std::cerr << "Replay failed: " << e.what() << std::endl;
+        return 1;
+    }
+
+    std::cout << "Replayed " << report.commands << " commands in " << report.totalMs << " ms ("
+              << report.commandsPerSecond() << " commands/s), " << report.checkpoints << " checkpoints matched"
+              << std::endl;
+    for (CommandType type : { CommandType::MoveHero, CommandType::Fight, CommandType::EndTurn }) {
+        const ReplayReport::TypeTiming& timing = report.byType[static_cast<int>(type)];
+        if (timing.count > 0) {
+            std::cout << "  " << commandTypeName(type) << ": " << timing.count << " commands, mean "
+                      << timing.totalMicroseconds / timing.count << " us, max " << timing.maxMicroseconds << " us"
+                      << std::endl;
+        }
+    }
+    std::cout << "Slowest commands:" << std::endl;
+    for (const ReplayedCommand& replayed : report.slowest) {
+        std::cout << "  #" << replayed.index << " " << commandTypeName(replayed.command.type) << " by player "
+                  << static_cast<int>(replayed.command.player) << ": " << replayed.microseconds << " us" << std::endl;
+    }
+
+    if (report.diverged) {
+        std::cerr << "Desync after command #" << report.divergedAt << ": " << report.divergence << std::endl;
+        return 2;
+    }
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    uint16_t port = DEFAULT_PORT;
+    int gameCount = DEFAULT_GAMES;
+    unsigned threads = 0;
+    int aiPlayers = 0;
+    std::string recordPath;
+    std::string replayPath;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--port") == 0 && i + 1 < argc) {
+            port = static_cast<uint16_t>(std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--games") == 0 && i + 1 < argc) {
+            gameCount = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = static_cast<unsigned>(std::max(0, std::atoi(argv[++i])));
+        } else if (std::strcmp(argv[i], "--ai") == 0 && i + 1 < argc) {
+            aiPlayers = std::min(2, std::max(0, std::atoi(argv[++i])));
+        } else if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            recordPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            replayPath = argv[++i];
+        }
+    }
+
+    std::cout << "Realms of Eldoria Server starting..." << std::endl;
+
+    // Data-driven definitions; startGame() falls back to the built-in creatures if this fails
+    GameState::loadDefinitions("../../assets/data/definitions.toml");
+
+    if (!replayPath.empty()) {
+        return replayLog(replayPath);
+    }
+
+    // Shared by the computer players and each game's end-of-day processing; outlives the host
+    ThreadPool workPool;
+
+    // Independent skirmishes; clients pick one in their Join, the first is the default
+    GameHost host(threads);
+    GameID firstGame = 0;
+    for (int i = 0; i < gameCount; i++) {
+        auto gameState = std::make_unique<GameState>();
+        createServerGame(*gameState, aiPlayers);
+        gameState->setThreadPool(&workPool);
+        gameState->startGame();
+        GameID id = host.addGame(std::move(gameState), static_cast<uint32_t>(i + 1));
+        firstGame = firstGame ? firstGame : id;
+    }
+
+    std::cout << "Server hosting " << host.getGameCount() << " game(s) on " << host.getThreadCount()
+              << " worker threads." << std::endl;
+
+    // Computer players take their whole turn in one tick, so one AI player per game per tick
+    AdventureAI ai(workPool);
+    if (aiPlayers > 0) {
+        host.setTurnHandler([&ai](HostedGame& game) { ai.playTurn(game); });
+    }
+
+    // Only the default game is autosaved and recorded
+    if (!recordPath.empty()) {
+        try {
+            host.getGame(firstGame)->startRecording(recordPath);
+            std::cout << "Recording commands to " << recordPath << std::endl;
+        } catch (const std::exception& e) {
+            std::cerr << "Failed to start recording: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    AutoSaver autoSaver("server_autosave");
+    GameServer server(host, firstGame);
+    server.setCommandListener([&](GameID game, const GameCommand&, const CommandOutcome& outcome) {
+        if (outcome.newDay && game == firstGame) {
+            GameState& gameState = host.getGame(game)->getState();
+            std::cout << "Day " << gameState.getTurnManager().getDayNumber() << " begins" << std::endl;
+            autoSaver.autosave(gameState);
+        }
+    });
+
+    if (aiPlayers > 0) {
+        server.setTickInterval(AI_TICK_INTERVAL_MS);
+    }
+
+    if (!server.listen(port)) {
+        std::cerr << "Failed to start server: " << server.getLastError() << std::endl;
+        return 1;
+    }
+
+    activeServer = &server;
+    std::signal(SIGINT, handleSignal);
+    std::signal(SIGTERM, handleSignal);
+
+    std::cout << "Listening on port " << server.getPort() << std::endl;
+    server.run();
+
+    activeServer = nullptr;
+    printStats(host);
     std::cout << "Server shutting down." << std::endl;
     return 0;
-}
\ No newline at end of file
+}